@@ -30,6 +30,7 @@
 #include <visp_naoqi/vpNaoqiRobot.h>
 #include <visp_naoqi/vpNaoqiConfig.h>
 
+#include <vpMultiQRCodeTracker.h>
 #include <vpQRCodeTracker.h>
 #include <vpServoArm.h>
 #include <vpRomeoTkConfig.h>
@@ -130,9 +131,6 @@ int main(int argc, const char* argv[])
   vpDisplay::setTitle(I, "Right camera view");
 
 
-  // Initialize the qrcode detector
-  vpDetectorBase *detector =  new vpDetectorQRCode;
-
   // Initialize the qrcode tracker
   std::vector <bool> status_qrcode_tracker(2);
   status_qrcode_tracker[0] = false;
@@ -149,9 +147,10 @@ int main(int argc, const char* argv[])
   arm_l.setQRCodeSize(0.045);
   arm_l.setMessage("romeo_left_arm");
 
-  //  std::vector <vpQRCodeTracker> qrcode_tracker;
-  //  qrcode_tracker.push_back(arm_r);
-  //  qrcode_tracker.push_back(arm_l);
+  // The two qrcodes share one decoding of the frame
+  vpMultiQRCodeTracker qrcode_trackers;
+  qrcode_trackers.addTarget(arm_r);
+  qrcode_trackers.addTarget(arm_l);
 
 
   // Constant transformation Target Frame to Arm end-effector (WristPitch)
@@ -378,27 +377,12 @@ int main(int argc, const char* argv[])
 
 
 
-    bool status_detection = detector->detect(I);
-
-    //        if (status_detection) {
-    //          for(size_t i=0; i < detector->getNbObjects(); i++) {
-    //            std::cout << "Bar code " << i << ":" << std::endl;
-    //            std::vector<vpImagePoint> p = detector->getPolygon(i);
-    //            for(size_t j=0; j < p.size(); j++)
-    //              std::cout << "  Point " << j << ": " << p[j] << std::endl;
-    //            std::cout << "  Message: \"" << detector->getMessage(i) << "\"" << std::endl;
-    //          }
-    //        }
-    bool a, b;
-    if (status_detection) {
-
-      // track qrcode
-      //a = arm_r.track(I, detector); // LArm
-      //b = arm_l.track(I, detector); // RArm
-
-      std::cout << "status_qrcode_tracker[0]" << a << std::endl;
-      std::cout << "status_qrcode_tracker[1]" << b << std::endl;
-    }
+    // track qrcode
+    qrcode_trackers.track(I);
+    bool a = qrcode_trackers.getStatus(0); // RArm
+    bool b = qrcode_trackers.getStatus(1); // LArm
+    std::cout << "status_qrcode_tracker[0]" << a << std::endl;
+    std::cout << "status_qrcode_tracker[1]" << b << std::endl;
 
 
     //    vpHomogeneousMatrix eMc = g.get_eMc();
@@ -163,8 +163,6 @@ int main(int argc, const char* argv[])
   hand_tracker.setPoints(points);
   hand_tracker.setFullManual(true);
 
-  if (opt_right_arm)
-    hand_tracker.setLeftHandTarget(false);
 
   if(!hand_tracker.loadHSV(opt_name_file_color_target))
   {
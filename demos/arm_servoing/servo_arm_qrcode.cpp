@@ -132,6 +132,8 @@ int main(int argc, const char* argv[])
   qrcode_tracker.setCameraParameters(cam);
   qrcode_tracker.setQRCodeSize(0.035);
   qrcode_tracker.setMessage("romeo_left_arm");
+  // The qrcode is decoded to detect it, then every 15 frames in background to check the tracking
+  qrcode_tracker.setVerificationPeriod(15);
 
 
   // Constant transformation Target Frame to LArm end-effector (LWristPitch)
@@ -338,6 +340,9 @@ int main(int argc, const char* argv[])
     loop_iter ++;
   }
 
+  std::cout << "Scores of the qrcode tracking:" << std::endl;
+  qrcode_tracker.getTrackingQuality().printHistogram(std::cout);
+
   if (opt_plotter_arm)
     delete plotter_arm;
   if (opt_plotter_qrcode_pose)
@@ -63,6 +63,7 @@ int main(int argc, const char* argv[])
     std::string opt_ip = "198.18.0.1";;
     std::string opt_data_folder = std::string(ROMEOTK_DATA_FOLDER);
     bool opt_Reye = false;
+    unsigned int opt_pyramid_level = 0;
 
 
     // Learning folder in /tmp/$USERNAME
@@ -97,8 +98,10 @@ int main(int argc, const char* argv[])
             opt_ip = argv[i+1];
         else if ( std::string(argv[i]) == "--reye")
             opt_Reye = true;
+        else if (std::string(argv[i]) == "--pyramid")
+            opt_pyramid_level = atoi(argv[i+1]);
         else if (std::string(argv[i]) == "--help") {
-            std::cout << "Usage: " << argv[0] << "[--ip <robot address>]" << std::endl;
+            std::cout << "Usage: " << argv[0] << "[--ip <robot address>] [--reye] [--pyramid <level>]" << std::endl;
             return 0;
         }
     }
@@ -171,8 +174,8 @@ int main(int argc, const char* argv[])
     box_tracker.setName("box");
     box_tracker.setCameraParameters(cam);
     box_tracker.setPoints(points);
+    box_tracker.setPyramidLevelColor(opt_pyramid_level);
 
-    box_tracker.setLeftHandTarget(false);
 
     if(!box_tracker.loadHSV(opt_name_file_color_box_target))
     {
@@ -200,7 +203,7 @@ int main(int argc, const char* argv[])
     hand_tracker_l.setName(chain_name[0]);
     hand_tracker_l.setCameraParameters(cam);
     hand_tracker_l.setPoints(points);
-    hand_tracker_l.setLeftHandTarget(true);
+    hand_tracker_l.setPyramidLevelColor(opt_pyramid_level);
 
     if(!hand_tracker_l.loadHSV(opt_name_file_color_target_l))
         std::cout << "Error opening the file "<< opt_name_file_color_target_l << std::endl;
@@ -210,7 +213,7 @@ int main(int argc, const char* argv[])
     hand_tracker_r.setName(chain_name[1]);
     hand_tracker_r.setCameraParameters(cam);
     hand_tracker_r.setPoints(points);
-    hand_tracker_r.setLeftHandTarget(false);
+    hand_tracker_r.setPyramidLevelColor(opt_pyramid_level);
 
     if(!hand_tracker_r.loadHSV(opt_name_file_color_target1_r))
         std::cout << "Error opening the file "<< opt_name_file_color_target_r << std::endl;
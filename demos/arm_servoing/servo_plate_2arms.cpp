@@ -174,7 +174,6 @@ int main(int argc, const char* argv[])
   box_tracker.setGrayLevelMaxBlob(60);
 
 
-  box_tracker.setLeftHandTarget(false);
 
   if(!box_tracker.loadHSV(opt_name_file_color_box_target))
   {
@@ -209,7 +208,6 @@ int main(int argc, const char* argv[])
   hand_tracker_l.setName(chain_name[0]);
   hand_tracker_l.setCameraParameters(cam);
   hand_tracker_l.setPoints(points1);
-  hand_tracker_l.setLeftHandTarget(true);
 
   if(!hand_tracker_l.loadHSV(opt_name_file_color_target_l))
     std::cout << "Error opening the file "<< opt_name_file_color_target_l << std::endl;
@@ -219,7 +217,6 @@ int main(int argc, const char* argv[])
   hand_tracker_r.setName(chain_name[1]);
   hand_tracker_r.setCameraParameters(cam);
   hand_tracker_r.setPoints(points);
-  hand_tracker_r.setLeftHandTarget(false);
 
   if(!hand_tracker_r.loadHSV(opt_name_file_color_target1_r))
     std::cout << "Error opening the file "<< opt_name_file_color_target_r << std::endl;
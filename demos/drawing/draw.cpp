@@ -29,6 +29,7 @@
 #include <vpRomeoTkConfig.h>
 #include <vpBlobsTargetTracker.h>
 #include <vpJointLimitAvoidance.h>
+#include <vpMultiBlobsTargetTracker.h>
 
 typedef enum {
   CalibratePen,
@@ -63,6 +64,7 @@ int main(int argc, const char* argv[])
   std::string opt_data_folder = std::string(ROMEOTK_DATA_FOLDER);
   bool opt_Reye = false;
   bool opt_calib = true;
+  bool opt_parallel = false;
 
   // Learning folder in /tmp/$USERNAME
   std::string username;
@@ -98,8 +100,10 @@ int main(int argc, const char* argv[])
       opt_Reye = true;
     else if ( std::string(argv[i]) == "--calib")
       opt_calib = true;
+    else if ( std::string(argv[i]) == "--parallel")
+      opt_parallel = true;
     else if (std::string(argv[i]) == "--help") {
-      std::cout << "Usage: " << argv[0] << "[--ip <robot address>]" << std::endl;
+      std::cout << "Usage: " << argv[0] << "[--ip <robot address>] [--parallel]" << std::endl;
       return 0;
     }
   }
@@ -184,7 +188,6 @@ int main(int argc, const char* argv[])
   //pen_tracker.setManualBlobInit(true);
   pen_tracker.setFullManual(true);
 
-  pen_tracker.setLeftHandTarget(true);
 
   if(!pen_tracker.loadHSV(opt_name_file_color_pen_target))
   {
@@ -228,7 +231,6 @@ int main(int argc, const char* argv[])
   hand_tracker_l.setName(chain_name[0]);
   hand_tracker_l.setCameraParameters(cam);
   hand_tracker_l.setPoints(points);
-  hand_tracker_l.setLeftHandTarget(true);
 
   if(!hand_tracker_l.loadHSV(opt_name_file_color_target_l))
     std::cout << "Error opening the file "<< opt_name_file_color_target_l << std::endl;
@@ -238,7 +240,6 @@ int main(int argc, const char* argv[])
   hand_tracker_r.setName(chain_name[1]);
   hand_tracker_r.setCameraParameters(cam);
   hand_tracker_r.setPoints(points);
-  hand_tracker_r.setLeftHandTarget(false);
 
   if(!hand_tracker_r.loadHSV(opt_name_file_color_target1_r))
     std::cout << "Error opening the file "<< opt_name_file_color_target_r << std::endl;
@@ -246,6 +247,12 @@ int main(int argc, const char* argv[])
   hand_tracker.push_back(&hand_tracker_l);
   hand_tracker.push_back(&hand_tracker_r);
 
+  // With --parallel the hand targets and the pen share the segmentation of the image
+  vpMultiBlobsTargetTracker targets;
+  targets.addTarget(hand_tracker_l);
+  targets.addTarget(hand_tracker_r);
+  unsigned int pen_index = targets.addTarget(pen_tracker);
+
 
   /************************************************************************************************/
 
@@ -571,9 +578,21 @@ int main(int argc, const char* argv[])
 
     }
 
+    if (opt_parallel)
+    {
+      // The hand target and the pen are detected with a single segmentation, and their blobs tracked together
+      for (unsigned int k = 0; k < 2; k++)
+        targets.setActive(k, state < WaitPreDraw && k == index_hand);
+      targets.track(cvI, I);
+      if (state < WaitPreDraw)
+        status_hand_tracker[index_hand] = targets.getStatus(index_hand);
+      status_pen_tracker = targets.getStatus(pen_index);
+    }
+
     if (state < WaitPreDraw)
     {
-      status_hand_tracker[index_hand] = hand_tracker[index_hand]->track(cvI,I);
+      if (!opt_parallel)
+        status_hand_tracker[index_hand] = hand_tracker[index_hand]->track(cvI,I);
 
       if (status_hand_tracker[index_hand] ) { // display the tracking results
         cMo_hand[index_hand] = hand_tracker[index_hand]->get_cMo();
@@ -585,7 +604,8 @@ int main(int argc, const char* argv[])
 
     }
 
-    status_pen_tracker = pen_tracker.track(cvI,I);
+    if (!opt_parallel)
+      status_pen_tracker = pen_tracker.track(cvI,I);
 
     if (status_pen_tracker ) { // display the tracking results
       cMpen = pen_tracker.get_cMo();
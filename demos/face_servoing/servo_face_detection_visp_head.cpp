@@ -38,6 +38,7 @@
 #include <visp_naoqi/vpNaoqiRobot.h>
 
 #include <vpFaceTracker.h>
+#include <vpMotionPredictor.h>
 #include <vpServoHead.h>
 
 #include <visp/vpPlot.h>
@@ -61,14 +62,17 @@ int main(int argc, const char* argv[])
 {
   std::string opt_ip = "198.18.0.1";
   std::string opt_face_cascade_name = "./haarcascade_frontalface_alt.xml";
+  bool opt_predict_motion = false;
 
   for (unsigned int i=0; i<argc; i++) {
     if (std::string(argv[i]) == "--ip")
       opt_ip = argv[i+1];
     else if (std::string(argv[i]) == "--haar")
       opt_face_cascade_name = std::string(argv[i+1]);
+    else if (std::string(argv[i]) == "--predict-motion")
+      opt_predict_motion = true;
     else if (std::string(argv[i]) == "--help") {
-      std::cout << "Usage: " << argv[0] << " [--ip <robot address>] [--haar <haarcascade xml filename>] [--help]" << std::endl;
+      std::cout << "Usage: " << argv[0] << " [--ip <robot address>] [--haar <haarcascade xml filename>] [--predict-motion] [--help]" << std::endl;
       return 0;
     }
   }
@@ -148,6 +152,7 @@ int main(int argc, const char* argv[])
     bool reinit_servo = true;
     bool speech = true;
     unsigned long loop_iter = 0;
+    vpColVector q_head_prev; // Head joints at the previous frame, to predict the motion of the face
 
     while(1) {
       if (reinit_servo) {
@@ -158,6 +163,18 @@ int main(int argc, const char* argv[])
       double t = vpTime::measureTimeMs();
       g.acquire(I);
       vpDisplay::display(I);
+
+      // Move the tracked face by the motion of the head since the previous frame
+      if (opt_predict_motion) {
+        vpColVector q_head = robot.getPosition(jointNames_head);
+        if (q_head_prev.getRows() == q_head.getRows()) {
+          vpMotionPredictor predictor;
+          predictor.setCameraMotion(eMc, robot.get_eJe("Head"), q_head - q_head_prev);
+          face_tracker.predictMotion(predictor, cam);
+        }
+        q_head_prev = q_head;
+      }
+
       bool face_found = face_tracker.track(I);
 
         vpColVector vel_head = robot.getJointVelocity(names_head);
@@ -30,6 +30,7 @@
 #include <visp_naoqi/vpNaoqiConfig.h>
 
 #include <vpFaceTracker.h>
+#include <vpFrameContext.h>
 #include <vpQRCodeTracker.h>
 #include <vpServoHead.h>
 #include <vpServoArm.h>
@@ -872,12 +873,16 @@ int main(int argc, const char* argv[])
         plotter_time->initGraph(0, 1);
     }
 
+    // Pyramid of the frame shared by the qrcode and the face trackers
+    vpFrameContext frame;
+
     while(1) {
         double loop_time_start = vpTime::measureTimeMs();
         //std::cout << "Loop iteration: " << loop_iter << std::endl;
 
         g.acquire(cvI);
         vpImageConvert::convert(cvI, I);
+        frame.setFrame(I, loop_iter);
 
 
         //g.acquire(I);
@@ -1112,7 +1117,7 @@ int main(int argc, const char* argv[])
         //      qrcode_tracker.setForceDetection(true);
         //    else
         //      qrcode_tracker.setForceDetection(false);
-        status_qrcode_tracker = qrcode_tracker.track(I);
+        status_qrcode_tracker = qrcode_tracker.track(frame);
 
         if (status_qrcode_tracker && !opt_learning_detection) { // display the tracking results
             cMo_qrcode = qrcode_tracker.get_cMo();
@@ -1817,7 +1822,7 @@ int main(int argc, const char* argv[])
 
             // Detect and track the largest face
             if (interaction_status >= HeadFollowFace ) {
-                face_found = face_tracker->track(I);
+                face_found = face_tracker->track(frame);
 
                 vpImagePoint head_cog_cur;
                 vpImagePoint head_cog_des(I.getHeight()/2, I.getWidth()/2);
@@ -43,6 +43,7 @@
 #include <vpColorDetection.h>
 #include <vpJointLimitAvoidance.h>
 #include <vpBlobsTargetTracker.h>
+#include <vpMotionPredictor.h>
 
 
 
@@ -410,6 +411,11 @@ int main(int argc, const char* argv[])
   bool opt_plotter_q_sec_arm = false;
   bool opt_plotter_error = false;
   bool opt_right_arm = false;
+  unsigned int opt_pyramid_level = 0;
+  bool opt_adaptive_color = false;
+  bool opt_predict_motion = false;
+  bool opt_filter_pose = false;
+  bool opt_subpixel = false;
 
   // Learning folder in /tmp/$USERNAME
   std::string username;
@@ -478,13 +484,23 @@ int main(int argc, const char* argv[])
       opt_right_arm = true;
     else if (std::string(argv[i]) == "--haar")
       opt_face_cascade_name = std::string(argv[i+1]);
+    else if (std::string(argv[i]) == "--pyramid")
+      opt_pyramid_level = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--adaptive-color")
+      opt_adaptive_color = true;
+    else if (std::string(argv[i]) == "--predict-motion")
+      opt_predict_motion = true;
+    else if (std::string(argv[i]) == "--filter-pose")
+      opt_filter_pose = true;
+    else if (std::string(argv[i]) == "--subpixel")
+      opt_subpixel = true;
     else if (std::string(argv[i]) == "--help") {
       std::cout << "Usage: " << argv[0] << "[--ip <robot address>] [--box-name] [--opt_no_color_tracking]" << std::endl;
       std::cout << "       [--haar <haarcascade xml filename>] [--no-interaction] [--learn-open-loop-position] " << std::endl;
       std::cout << "       [--learn-grasp-position] [--plot-time] [--plot-arm] [--plot-qrcode-pose] [--plot-q] "<< std::endl;
       std::cout << "  add  [--rarm] tu use the right arm, nothing to use the left "<< std::endl;
-      std::cout << "       [--data-folder] [--learn-detection-box] [--Reye] "<< std::endl;
-      std::cout << "       [--fr] [--opt-record-video] [--help]" << std::endl;
+      std::cout << "       [--data-folder] [--learn-detection-box] [--Reye] [--pyramid <level>] [--adaptive-color] "<< std::endl;
+      std::cout << "       [--predict-motion] [--filter-pose] [--subpixel] [--fr] [--opt-record-video] [--help]" << std::endl;
       return 0;
     }
   }
@@ -652,9 +668,8 @@ int main(int argc, const char* argv[])
   hand_tracker.setName(chain_name);
   hand_tracker.setCameraParameters(cam);
   hand_tracker.setPoints(points);
+  hand_tracker.setPyramidLevelColor(opt_pyramid_level);
 
-  if (opt_right_arm)
-    hand_tracker.setLeftHandTarget(false);
 
 
   if(!hand_tracker.loadHSV(opt_name_file_color_target))
@@ -662,6 +677,25 @@ int main(int argc, const char* argv[])
     std::cout << "Error opening the file "<< opt_name_file_color_target << std::endl;
   }
 
+  // The color model adapted during the previous runs is kept in the learning folder
+  std::string color_model_file = learning_folder + "/" + chain_name + "_color_model.bin";
+  if (opt_adaptive_color)
+  {
+    if (vpIoTools::checkFilename(color_model_file))
+      hand_tracker.loadColorModel(color_model_file);
+    hand_tracker.setAdaptiveColor(true);
+  }
+
+  if (opt_subpixel)
+    hand_tracker.setSubPixelRefinement(true);
+
+  // The hand pose is filtered, and predicted through two dropped frames at most
+  if (opt_filter_pose)
+  {
+    hand_tracker.setPoseFiltering(true);
+    hand_tracker.getPoseFilter().setMaxPredictionTime(70.);
+  }
+
   // Initialize head servoing
   vpServoHead servo_head;
   servo_head.setCameraParameters(cam);
@@ -712,6 +746,7 @@ int main(int argc, const char* argv[])
   // Initialize Detection color class
   vpColorDetection obj_color;
   obj_color.setName(opt_box_name);
+  obj_color.setPyramidLevel(opt_pyramid_level);
   std::string filename_color = box_folder + "color/" + opt_box_name + "HSV.txt";
   if (!opt_learning_detection)
   {
@@ -1013,11 +1048,15 @@ int main(int argc, const char* argv[])
   }
 
 
+  vpColVector q_head_prev, q_arm_prev; // Joints at the previous frame, to predict the motion of the targets
+
   while(1) {
     double loop_time_start = vpTime::measureTimeMs();
     //std::cout << "Loop iteration: " << loop_iter << std::endl;
 
     g.acquire(cvI);
+    // Time of the frame, the filtered pose being updated at this time and not after the processing
+    double frame_time = vpTime::measureTimeMs();
     vpImageConvert::convert(cvI, I);
 
     //g.acquire(I);
@@ -1040,6 +1079,23 @@ int main(int argc, const char* argv[])
     //Get Actual position of the arm joints
     q = robot.getPosition(jointNames_larm);
 
+    // Move the tracked targets by the motion of the joints since the previous frame
+    if (opt_predict_motion) {
+      vpColVector q_head = robot.getPosition(jointNames);
+      if (q_head_prev.getRows() == q_head.getRows()) {
+        vpMotionPredictor predictor;
+        if (opt_Reye)
+          predictor.setCameraMotion(eMc, robot.get_eJe("REye") * MAP_head, q_head - q_head_prev);
+        else
+          predictor.setCameraMotion(eMc, robot.get_eJe("LEye") * MAP_head, q_head - q_head_prev);
+        teabox_tracker.predictMotion(I, predictor);
+        predictor.setTargetMotion(hMe_Arm, robot.get_eJe(chain_name), q - q_arm_prev);
+        hand_tracker.predictMotion(predictor);
+      }
+      q_head_prev = q_head;
+      q_arm_prev = q;
+    }
+
 
     if (! opt_record_video)
       vpDisplay::displayText(I, vpImagePoint(I.getHeight() - 10, 10), "Right click to quit", vpColor::red);
@@ -1305,10 +1361,20 @@ int main(int argc, const char* argv[])
 
       }
 
+      hand_tracker.setFrameTime(frame_time);
       status_hand_tracker = hand_tracker.track(cvI,I);
 
+      if (opt_filter_pose) {
+        // The servo uses the filtered pose at the current time, also when the last frame was dropped
+        double t = vpTime::measureTimeMs();
+        status_hand_tracker = hand_tracker.getPoseFilter().isValid(t);
+        if (status_hand_tracker)
+          cMo_hand = hand_tracker.getPoseFilter().predictPose(t);
+      }
+
       if (status_hand_tracker && !opt_learning_detection) { // display the tracking results
-        cMo_hand = hand_tracker.get_cMo();
+        if (!opt_filter_pose)
+          cMo_hand = hand_tracker.get_cMo();
         //printPose("cMo qrcode: ", cMo_hand);
         // The qrcode frame is only displayed when PBVS is active or learning
         if (state_teabox_tracker == LearnDesiredLHandGraspPosition
@@ -2481,6 +2547,11 @@ int main(int argc, const char* argv[])
   if (servo_arm)
     delete servo_arm;
 
+  if (opt_adaptive_color)
+    hand_tracker.saveColorModel(color_model_file);
+
+  std::cout << "Hand target blobs recovered locally " << hand_tracker.getNbLocalRecoveries()
+            << " times, target detected again " << hand_tracker.getNbFullRecoveries() << " times" << std::endl;
 
   return 0;
 }
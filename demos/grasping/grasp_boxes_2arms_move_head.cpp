@@ -674,7 +674,6 @@ int main(int argc, const char* argv[])
     hand_tracker_l.setName(chain_name[0]);
     hand_tracker_l.setCameraParameters(cam[0]);
     hand_tracker_l.setPoints(points);
-    hand_tracker_l.setLeftHandTarget(true);
 
     if(!hand_tracker_l.loadHSV(opt_name_file_color_target_l))
         std::cout << "Error opening the file "<< opt_name_file_color_target_l << std::endl;
@@ -684,7 +683,6 @@ int main(int argc, const char* argv[])
     hand_tracker_r.setName(chain_name[1]);
     hand_tracker_r.setCameraParameters(cam[1]);
     hand_tracker_r.setPoints(points);
-    hand_tracker_r.setLeftHandTarget(true);
 
     if(!hand_tracker_r.loadHSV(opt_name_file_color_target1_r))
         std::cout << "Error opening the file "<< opt_name_file_color_target_r << std::endl;
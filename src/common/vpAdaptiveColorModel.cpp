@@ -0,0 +1,361 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Adaptive hue-saturation color model learned from the tracked blobs.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <vpAdaptiveColorModel.h>
+
+namespace {
+
+const int lut_bits = 6;
+const int lut_shift = 8 - lut_bits;
+const int lut_side = 1 << lut_bits;
+
+const char file_magic[4] = {'V', 'P', 'C', 'M'};
+const unsigned int file_version = 1;
+
+// Bins with less than this fraction of the target samples are considered as noise
+const float min_foreground = 1e-3f;
+
+/*
+  Spread a histogram along the hue, which is circular, with the kernel [1/4 1/2 1/4].
+  Without it, a uniform blob whose hue drifts would jump from one bin to the next one that
+  was never learned.
+ */
+void smoothHue(std::vector<float> &histogram, unsigned int nb_h, unsigned int nb_s)
+{
+  for (unsigned int s = 0; s < nb_s; s++) {
+    const float first = histogram[s];
+    float prev = histogram[(nb_h - 1) * nb_s + s];
+    for (unsigned int h = 0; h < nb_h; h++) {
+      float &cur = histogram[h * nb_s + s];
+      const float next = (h + 1 < nb_h) ? histogram[(h + 1) * nb_s + s] : first;
+      const float value = 0.25f * prev + 0.5f * cur + 0.25f * next;
+      prev = cur;
+      cur = value;
+    }
+  }
+}
+
+}
+
+/*!
+  Default constructor. The model is empty until initFromRange(), update() or load() is called.
+ */
+vpAdaptiveColorModel::vpAdaptiveColorModel()
+  : m_binLut(), m_foreground(nbBins, 0.f), m_background(nbBins, 0.f), m_probability(nbBins + 1, 0),
+    m_sampleForeground(nbBins, 0.f), m_sampleBackground(nbBins, 0.f), m_learningRate(0.05), m_maxSamples(1000),
+    m_threshold(128), m_minValue(30), m_minAgreement(0.5), m_nbUpdates(0), m_initialized(false)
+{
+  buildBinLut();
+}
+
+/*!
+  Compute the hue-saturation bin of the center of each quantised BGR color, with the
+  hue between 0 and 180 and the saturation between 0 and 255 like cv::COLOR_BGR2HSV.
+ */
+void vpAdaptiveColorModel::buildBinLut()
+{
+  m_binLut.resize(lut_side * lut_side * lut_side);
+  for (int b = 0; b < lut_side; b++) {
+    for (int g = 0; g < lut_side; g++) {
+      for (int r = 0; r < lut_side; r++) {
+        const double B = (b << lut_shift) + 2, G = (g << lut_shift) + 2, R = (r << lut_shift) + 2;
+        const double v = std::max(B, std::max(G, R));
+        const double diff = v - std::min(B, std::min(G, R));
+        unsigned char &bin = m_binLut[(b << (2*lut_bits)) | (g << lut_bits) | r];
+        if (v < m_minValue) {
+          bin = nbBins;
+          continue;
+        }
+        double h = 0.;
+        if (diff > 0.) {
+          if (v == R)
+            h = 60. * (G - B) / diff;
+          else if (v == G)
+            h = 120. + 60. * (B - R) / diff;
+          else
+            h = 240. + 60. * (R - G) / diff;
+          if (h < 0.)
+            h += 360.;
+        }
+        const double s = 255. * diff / v;
+        const unsigned int h_bin = std::min((unsigned int)(h / 2. / (180. / nbBinsH)), nbBinsH - 1);
+        const unsigned int s_bin = std::min((unsigned int)(s / (256. / nbBinsS)), nbBinsS - 1);
+        bin = (unsigned char)(h_bin * nbBinsS + s_bin);
+      }
+    }
+  }
+}
+
+/*!
+  Set the value under which a pixel is too dark to belong to the target.
+  \param value_min : Minimum V value, between 0 and 255. By default 30.
+ */
+void vpAdaptiveColorModel::setMinValue(const int &value_min)
+{
+  m_minValue = value_min;
+  buildBinLut();
+}
+
+/*!
+  Initialize the model from an HSV range, such as the ones of vpColorDetection::loadHSV().
+  The target histogram is uniform on the bins overlapping the H and S ranges, the histogram of
+  the surroundings is uniform on all the bins. The V range is not used.
+  \param hsv_min : Lower bounds H, S, V (inclusive).
+  \param hsv_max : Upper bounds H, S, V (inclusive).
+ */
+void vpAdaptiveColorModel::initFromRange(const int hsv_min[3], const int hsv_max[3])
+{
+  const int h_step = 180 / nbBinsH, s_step = 256 / nbBinsS;
+  unsigned int nb = 0;
+  for (unsigned int h = 0; h < nbBinsH; h++) {
+    for (unsigned int s = 0; s < nbBinsS; s++) {
+      const bool inside = (int)(h * h_step) <= hsv_max[0] && (int)((h + 1) * h_step - 1) >= hsv_min[0]
+          && (int)(s * s_step) <= hsv_max[1] && (int)((s + 1) * s_step - 1) >= hsv_min[1];
+      m_foreground[h * nbBinsS + s] = inside ? 1.f : 0.f;
+      if (inside)
+        nb++;
+    }
+  }
+  for (unsigned int i = 0; i < nbBins; i++) {
+    if (nb)
+      m_foreground[i] /= nb;
+    m_background[i] = 1.f / nbBins;
+  }
+
+  updateProbability();
+  m_nbUpdates = 0;
+  m_initialized = true;
+}
+
+/*!
+  Compute the probability of each bin from the two histograms.
+ */
+void vpAdaptiveColorModel::updateProbability()
+{
+  for (unsigned int i = 0; i < nbBins; i++) {
+    const float f = m_foreground[i], b = m_background[i];
+    m_probability[i] = (f < min_foreground) ? 0 : (unsigned char)cvRound(255.f * f / (f + b));
+  }
+  m_probability[nbBins] = 0;
+}
+
+/*!
+  Histogram of the pixels of \e area that are not in \e exclude, with at most m_maxSamples
+  pixels taken on a regular grid.
+  \param nb_foreground : Number of samples that belong to the target with the current model.
+  \return The number of samples in the histogram.
+ */
+unsigned int vpAdaptiveColorModel::sample(const cv::Mat &bgr, const cv::Rect &area, const cv::Rect &exclude,
+                                          std::vector<float> &histogram, unsigned int &nb_foreground) const
+{
+  std::fill(histogram.begin(), histogram.end(), 0.f);
+  nb_foreground = 0;
+  const int step = std::max(1, (int)std::ceil(std::sqrt((double)area.area() / std::max(1u, m_maxSamples))));
+
+  unsigned int nb = 0;
+  for (int y = area.y; y < area.y + area.height; y += step) {
+    const unsigned char *row = bgr.ptr<unsigned char>(y);
+    for (int x = area.x; x < area.x + area.width; x += step) {
+      if (exclude.contains(cv::Point(x, y)))
+        continue;
+      const unsigned char *p = row + 3 * x;
+      const unsigned int bin = m_binLut[((p[0] >> lut_shift) << (2*lut_bits)) | ((p[1] >> lut_shift) << lut_bits) | (p[2] >> lut_shift)];
+      if (bin == nbBins)
+        continue;
+      histogram[bin] += 1.f;
+      nb++;
+      if (m_probability[bin] >= m_threshold)
+        nb_foreground++;
+    }
+  }
+  return nb;
+}
+
+/*!
+  Update the model with the pixels of a tracked blob.
+
+  The target histogram is computed in the center of \e bbox, the histogram of the surroundings
+  in a ring of half the size of \e bbox around it. Both are smoothed along the hue, so that the
+  model follows a slow drift of the color, and blended with the model:
+  model = (1 - rate) * model + rate * frame, where rate is given by setLearningRate().
+
+  \param bgr : Color image of type CV_8UC3.
+  \param bbox : Bounding box of the blob in \e bgr, for example vpDot2::getBBox().
+  \return true if the model was updated, false if the blob is empty or if less than
+  setMinAgreement() of its pixels belong to the target with the current model.
+ */
+bool vpAdaptiveColorModel::update(const cv::Mat &bgr, const cv::Rect &bbox)
+{
+  CV_Assert(bgr.type() == CV_8UC3);
+  const cv::Rect image(0, 0, bgr.cols, bgr.rows);
+  // The border of the blob mixes the target and the background
+  const cv::Rect inner = cv::Rect(bbox.x + bbox.width / 5, bbox.y + bbox.height / 5,
+                                  bbox.width - 2 * (bbox.width / 5), bbox.height - 2 * (bbox.height / 5)) & image;
+  const cv::Rect outer = cv::Rect(bbox.x - bbox.width / 2, bbox.y - bbox.height / 2,
+                                  2 * bbox.width, 2 * bbox.height) & image;
+  if (inner.area() == 0)
+    return false;
+
+  unsigned int nb_agree = 0;
+  const unsigned int nb_foreground = sample(bgr, inner, cv::Rect(), m_sampleForeground, nb_agree);
+  if (nb_foreground == 0)
+    return false;
+  if (m_initialized && nb_agree < m_minAgreement * nb_foreground)
+    return false;
+
+  unsigned int nb_unused = 0;
+  const unsigned int nb_background = sample(bgr, outer, bbox, m_sampleBackground, nb_unused);
+
+  smoothHue(m_sampleForeground, nbBinsH, nbBinsS);
+  smoothHue(m_sampleBackground, nbBinsH, nbBinsS);
+
+  const float rate = m_initialized ? (float)m_learningRate : 1.f;
+  for (unsigned int i = 0; i < nbBins; i++) {
+    m_foreground[i] = (1.f - rate) * m_foreground[i] + rate * m_sampleForeground[i] / nb_foreground;
+    if (nb_background)
+      m_background[i] = (1.f - rate) * m_background[i] + rate * m_sampleBackground[i] / nb_background;
+  }
+
+  updateProbability();
+  m_nbUpdates++;
+  m_initialized = true;
+  return true;
+}
+
+/*!
+  Probability of each pixel to belong to the target, scaled to 0-255.
+  \param bgr : Color image of type CV_8UC3.
+  \param probability : Image of type CV_8UC1, reallocated only if its size changes.
+ */
+void vpAdaptiveColorModel::backProject(const cv::Mat &bgr, cv::Mat &probability) const
+{
+  CV_Assert(bgr.type() == CV_8UC3);
+  probability.create(bgr.size(), CV_8UC1);
+  for (int y = 0; y < bgr.rows; y++) {
+    const unsigned char *src = bgr.ptr<unsigned char>(y);
+    unsigned char *dst = probability.ptr<unsigned char>(y);
+    for (int x = 0; x < bgr.cols; x++, src += 3)
+      dst[x] = getProbability(src);
+  }
+}
+
+/*!
+  Mask of the pixels whose probability is at least setThreshold(), with the values 0 and 255
+  like vpColorThreshold::thresholdHSV().
+  \param bgr : Color image of type CV_8UC3.
+  \param mask : Image of type CV_8UC1, reallocated only if its size changes.
+ */
+void vpAdaptiveColorModel::threshold(const cv::Mat &bgr, cv::Mat &mask) const
+{
+  CV_Assert(bgr.type() == CV_8UC3);
+  mask.create(bgr.size(), CV_8UC1);
+  for (int y = 0; y < bgr.rows; y++) {
+    const unsigned char *src = bgr.ptr<unsigned char>(y);
+    unsigned char *dst = mask.ptr<unsigned char>(y);
+    for (int x = 0; x < bgr.cols; x++, src += 3)
+      dst[x] = isForeground(src) ? 255 : 0;
+  }
+}
+
+/*!
+  Save the histograms of the model in a binary file, in the byte order of the machine.
+  \param filename : Name of the file to create.
+  \return true if the file was written.
+ */
+bool vpAdaptiveColorModel::save(const std::string &filename) const
+{
+  std::ofstream fileout(filename.c_str(), std::ios_base::out | std::ios_base::binary);
+  if (!fileout)
+  {
+    std::cerr << "ERROR: cannot create the file " << filename << std::endl;
+    return false;
+  }
+
+  const unsigned int header[3] = {file_version, nbBinsH, nbBinsS};
+  const unsigned long long nb_updates = m_nbUpdates;
+  fileout.write(file_magic, sizeof(file_magic));
+  fileout.write((const char *)header, sizeof(header));
+  fileout.write((const char *)&nb_updates, sizeof(nb_updates));
+  fileout.write((const char *)&m_foreground[0], nbBins * sizeof(float));
+  fileout.write((const char *)&m_background[0], nbBins * sizeof(float));
+
+  return fileout.good();
+}
+
+/*!
+  Load a model saved with save().
+  \param filename : Name of the file to read.
+  \return true if the model was read, false if the file cannot be read or was saved with
+  other histogram sizes. The model is unchanged in that case.
+ */
+bool vpAdaptiveColorModel::load(const std::string &filename)
+{
+  std::ifstream filein(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!filein)
+  {
+    std::cerr << "ERROR: cannot open the file " << filename << std::endl;
+    return false;
+  }
+
+  char magic[4];
+  unsigned int header[3];
+  unsigned long long nb_updates;
+  std::vector<float> foreground(nbBins), background(nbBins);
+  filein.read(magic, sizeof(magic));
+  filein.read((char *)header, sizeof(header));
+  filein.read((char *)&nb_updates, sizeof(nb_updates));
+  filein.read((char *)&foreground[0], nbBins * sizeof(float));
+  filein.read((char *)&background[0], nbBins * sizeof(float));
+
+  if (!filein || memcmp(magic, file_magic, sizeof(magic)) != 0 || header[0] != file_version
+      || header[1] != nbBinsH || header[2] != nbBinsS)
+  {
+    std::cerr << "ERROR: " << filename << " is not a color model file" << std::endl;
+    return false;
+  }
+
+  m_foreground.swap(foreground);
+  m_background.swap(background);
+  m_nbUpdates = (unsigned long)nb_updates;
+  updateProbability();
+  m_initialized = true;
+  return true;
+}
@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Adaptive hue-saturation color model learned from the tracked blobs.
+ *
+ *****************************************************************************/
+#ifndef __vpAdaptiveColorModel_h__
+#define __vpAdaptiveColorModel_h__
+
+#include <string>
+#include <vector>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+/*!
+  Color model made of a hue-saturation histogram of the target and of its surroundings,
+  updated online from the pixels of a tracked blob.
+
+  The probability of a pixel to belong to the target is the back projection of the ratio
+  between the target histogram and the sum of both histograms. The BGR color is mapped to its
+  hue-saturation bin with a lookup table indexed by the color quantised on 6 bits per channel,
+  so that the back projection costs two table lookups per pixel. Dark pixels, whose hue is not
+  reliable, never belong to the target.
+
+  update() samples at most setMaxSamples() pixels inside the blob and as many around it, then
+  blends the new histograms with a forgetting factor, so that the cost of an update is bounded
+  whatever the size of the blob. An update is rejected when most of the blob does not match the
+  current model anymore, to avoid learning the background after a tracking failure.
+
+  The model can be saved in a binary file, so that a new run starts from the adapted model.
+
+  \code
+  vpAdaptiveColorModel model;
+  model.initFromRange(hsv_min, hsv_max);
+  detector.setColorModel(&model);
+  ...
+  if (tracked)
+    model.update(cvI, blob_bbox);
+  \endcode
+ */
+class vpAdaptiveColorModel
+{
+public:
+  static const unsigned int nbBinsH = 30; //!< Bins of 6 degrees of the 0-180 hue of OpenCV
+  static const unsigned int nbBinsS = 8;  //!< Bins of 32 levels of saturation
+  static const unsigned int nbBins = nbBinsH * nbBinsS;
+
+protected:
+  std::vector<unsigned char> m_binLut; //!< Bin of each quantised BGR color, nbBins for the dark colors
+  std::vector<float> m_foreground; //!< Normalized histogram of the target
+  std::vector<float> m_background; //!< Normalized histogram around the target
+  std::vector<unsigned char> m_probability; //!< Probability of each bin scaled to 0-255, with a last null bin
+  std::vector<float> m_sampleForeground; //!< Histogram of the target in the current frame
+  std::vector<float> m_sampleBackground; //!< Histogram around the target in the current frame
+  double m_learningRate;
+  unsigned int m_maxSamples;
+  unsigned char m_threshold;
+  int m_minValue;
+  double m_minAgreement;
+  unsigned long m_nbUpdates;
+  bool m_initialized;
+
+  void buildBinLut();
+  unsigned int sample(const cv::Mat &bgr, const cv::Rect &area, const cv::Rect &exclude,
+                      std::vector<float> &histogram, unsigned int &nb_foreground) const;
+  void updateProbability();
+
+public:
+  vpAdaptiveColorModel();
+  virtual ~vpAdaptiveColorModel() {}
+
+  void backProject(const cv::Mat &bgr, cv::Mat &probability) const;
+  unsigned long getNbUpdates() const { return m_nbUpdates; }
+  /*!
+    Probability of a BGR pixel to belong to the target, scaled to 0-255.
+   */
+  unsigned char getProbability(const unsigned char *bgr) const
+  {
+    return m_probability[m_binLut[((bgr[0] >> 2) << 12) | ((bgr[1] >> 2) << 6) | (bgr[2] >> 2)]];
+  }
+  unsigned char getThreshold() const { return m_threshold; }
+  void initFromRange(const int hsv_min[3], const int hsv_max[3]);
+  bool isForeground(const unsigned char *bgr) const { return getProbability(bgr) >= m_threshold; }
+  bool isInitialized() const { return m_initialized; }
+  bool load(const std::string &filename);
+  bool save(const std::string &filename) const;
+  void setLearningRate(const double &rate) { m_learningRate = rate; }
+  void setMaxSamples(const unsigned int &max_samples) { m_maxSamples = max_samples; }
+  void setMinAgreement(const double &ratio) { m_minAgreement = ratio; }
+  void setMinValue(const int &value_min);
+  void setThreshold(const unsigned char &threshold) { m_threshold = threshold; }
+  void threshold(const cv::Mat &bgr, cv::Mat &mask) const;
+  bool update(const cv::Mat &bgr, const cv::Rect &bbox);
+};
+
+#endif
@@ -0,0 +1,236 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Morphological operations on binary masks packed in 64 bits words.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include <vpBinaryMorphology.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+namespace {
+
+/*
+  Bits [64*w + shift, 64*w + shift + 63] of a row, where the words outside the row are equal to pad.
+ */
+inline uint64_t shiftedWord(const uint64_t *row, int words, int w, int shift, uint64_t pad)
+{
+  int q = w + (shift >> 6); // Arithmetic shift: floor division
+  int r = shift & 63;
+  uint64_t lo = (q >= 0 && q < words) ? row[q] : pad;
+  if (r == 0)
+    return lo;
+  uint64_t hi = (q + 1 >= 0 && q + 1 < words) ? row[q + 1] : pad;
+  return (lo >> r) | (hi << (64 - r));
+}
+
+/*
+  Window [first, last] covered by n iterations of a rectangle of size k with the default anchor k/2.
+ */
+inline void getWindow(int k, unsigned int n, int &first, int &last)
+{
+  first = -(int)n * (k / 2);
+  last = (int)n * (k - 1 - k / 2);
+}
+
+}
+
+/*!
+  Default constructor.
+ */
+vpBinaryMorphology::vpBinaryMorphology()
+  : m_cols(0), m_rows(0), m_words(0), m_bits(), m_buffer(), m_row()
+{
+}
+
+/*!
+  Pack a row of bytes, one bit per non zero byte. The bits after the end of the row are set to 0.
+ */
+void vpBinaryMorphology::packRow(const unsigned char *src, uint64_t *dst) const
+{
+  int x = 0;
+  for (int w = 0; w < m_words; w++) {
+    uint64_t word = 0;
+#if defined(__SSE2__)
+    if (x + 64 <= m_cols) {
+      const __m128i zero = _mm_setzero_si128();
+      for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + x + 16*k));
+        uint64_t bits = (~_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))) & 0xFFFF;
+        word |= bits << (16*k);
+      }
+      dst[w] = word;
+      x += 64;
+      continue;
+    }
+#endif
+    for (int b = 0; b < 64 && x < m_cols; b++, x++) {
+      if (src[x])
+        word |= (uint64_t)1 << b;
+    }
+    dst[w] = word;
+  }
+}
+
+/*!
+  Unpack a row of bits to 0 and 255 bytes.
+ */
+void vpBinaryMorphology::unpackRow(const uint64_t *src, unsigned char *dst) const
+{
+  for (int w = 0; w < m_words; w++) {
+    const uint64_t word = src[w];
+    const int n = std::min(64, m_cols - 64*w);
+    unsigned char *out = dst + 64*w;
+    if (word == 0) {
+      std::fill(out, out + n, 0);
+    }
+    else if (word == ~(uint64_t)0) {
+      std::fill(out, out + n, 255);
+    }
+    else {
+      for (int b = 0; b < n; b++)
+        out[b] = (unsigned char)(-(int)((word >> b) & 1));
+    }
+  }
+}
+
+/*!
+  Horizontal erosion or dilation of a packed row with the window [first, last].
+  The bits after the end of \e src are overwritten.
+ */
+void vpBinaryMorphology::filterRow(uint64_t *src, uint64_t *dst, int first, int last, bool erode) const
+{
+  // The pixels outside the image are ignored, like with the default border of OpenCV
+  const uint64_t pad = erode ? ~(uint64_t)0 : 0;
+  const int tail = m_cols & 63;
+  if (tail) {
+    const uint64_t valid = ((uint64_t)1 << tail) - 1;
+    src[m_words - 1] = (src[m_words - 1] & valid) | (pad & ~valid);
+  }
+
+  for (int w = 0; w < m_words; w++) {
+    uint64_t word = src[w];
+    if (erode) {
+      for (int d = first; d <= last && word; d++) {
+        if (d)
+          word &= shiftedWord(src, m_words, w, d, pad);
+      }
+    }
+    else {
+      for (int d = first; d <= last && ~word; d++) {
+        if (d)
+          word |= shiftedWord(src, m_words, w, d, pad);
+      }
+    }
+    dst[w] = word;
+  }
+}
+
+/*!
+  Vertical erosion or dilation of row \e i with the window [first, last].
+ */
+void vpBinaryMorphology::filterCols(const uint64_t *src, int i, int first, int last, bool erode, uint64_t *dst) const
+{
+  const int r0 = std::max(i + first, 0);
+  const int r1 = std::min(i + last, m_rows - 1);
+  std::copy(src + r0 * m_words, src + (r0 + 1) * m_words, dst);
+  for (int r = r0 + 1; r <= r1; r++) {
+    const uint64_t *row = src + r * m_words;
+    if (erode) {
+      for (int w = 0; w < m_words; w++)
+        dst[w] &= row[w];
+    }
+    else {
+      for (int w = 0; w < m_words; w++)
+        dst[w] |= row[w];
+    }
+  }
+}
+
+/*!
+  Erode then dilate a binary mask by rectangles, in place.
+
+  \param T : Mask of type CV_8UC1 with values 0 and 255.
+  \param erode_size : Size of the rectangle of the erosion.
+  \param erode_iter : Number of erosions.
+  \param dilate_size : Size of the rectangle of the dilation.
+  \param dilate_iter : Number of dilations.
+ */
+void vpBinaryMorphology::erodeDilate(cv::Mat &T, const cv::Size &erode_size, unsigned int erode_iter,
+                                     const cv::Size &dilate_size, unsigned int dilate_iter)
+{
+  CV_Assert(T.type() == CV_8UC1);
+  if (T.rows == 0 || T.cols == 0)
+    return;
+
+  m_cols = T.cols;
+  m_rows = T.rows;
+  m_words = (m_cols + 63) / 64;
+  const size_t size = (size_t)m_rows * m_words;
+  if (m_bits.size() < size) {
+    m_bits.resize(size);
+    m_buffer.resize(size);
+  }
+  if (m_row.size() < (size_t)m_words)
+    m_row.resize(m_words);
+
+  int ex0, ex1, ey0, ey1, dx0, dx1, dy0, dy1;
+  getWindow(erode_size.width, erode_iter, ex0, ex1);
+  getWindow(erode_size.height, erode_iter, ey0, ey1);
+  getWindow(dilate_size.width, dilate_iter, dx0, dx1);
+  getWindow(dilate_size.height, dilate_iter, dy0, dy1);
+
+  uint64_t *bits = &m_bits[0];
+  uint64_t *buffer = &m_buffer[0];
+  uint64_t *row = &m_row[0];
+
+  // Pack and erode horizontally
+  for (int i = 0; i < m_rows; i++) {
+    packRow(T.ptr<unsigned char>(i), row);
+    filterRow(row, buffer + i * m_words, ex0, ex1, true);
+  }
+  // Erode vertically
+  for (int i = 0; i < m_rows; i++)
+    filterCols(buffer, i, ey0, ey1, true, bits + i * m_words);
+  // Dilate horizontally
+  for (int i = 0; i < m_rows; i++)
+    filterRow(bits + i * m_words, buffer + i * m_words, dx0, dx1, false);
+  // Dilate vertically and unpack
+  for (int i = 0; i < m_rows; i++) {
+    filterCols(buffer, i, dy0, dy1, false, row);
+    unpackRow(row, T.ptr<unsigned char>(i));
+  }
+}
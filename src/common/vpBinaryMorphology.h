@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Morphological operations on binary masks packed in 64 bits words.
+ *
+ *****************************************************************************/
+#ifndef __vpBinaryMorphology_h__
+#define __vpBinaryMorphology_h__
+
+#include <vector>
+#include <stdint.h>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+/*!
+  Rectangular erosions and dilations of a binary mask stored with one bit per pixel.
+
+  The mask is packed in 64 bits words, the horizontal passes combine shifted words and the
+  vertical passes combine whole words. Successive erosions (resp. dilations) by rectangles
+  are merged in a single erosion (resp. dilation) by a larger rectangle, so that
+  erodeDilate() does four passes over the packed mask, whatever the number of iterations.
+
+  The result is the same as cv::erode() followed by cv::dilate() with rectangular
+  structuring elements, the default anchor and the default border, as long as the
+  input mask only contains 0 and 255.
+ */
+class vpBinaryMorphology
+{
+protected:
+  int m_cols;
+  int m_rows;
+  int m_words; //!< Number of words per row
+  std::vector<uint64_t> m_bits;
+  std::vector<uint64_t> m_buffer;
+  std::vector<uint64_t> m_row;
+
+  void filterRow(uint64_t *src, uint64_t *dst, int first, int last, bool erode) const;
+  void filterCols(const uint64_t *src, int i, int first, int last, bool erode, uint64_t *dst) const;
+  void packRow(const unsigned char *src, uint64_t *dst) const;
+  void unpackRow(const uint64_t *src, unsigned char *dst) const;
+
+public:
+  vpBinaryMorphology();
+  virtual ~vpBinaryMorphology() {}
+
+  void erodeDilate(cv::Mat &T, const cv::Size &erode_size, unsigned int erode_iter,
+                   const cv::Size &dilate_size, unsigned int dilate_iter);
+};
+
+#endif
@@ -0,0 +1,294 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Matching of the blobs of a target with the points of its model.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <visp/vpException.h>
+#include <visp/vpMath.h>
+
+#include <vpBlobConstellation.h>
+
+/*!
+  Default constructor. setModel() has to be called before matching.
+ */
+vpBlobConstellation::vpBlobConstellation()
+  : m_oX(), m_oY(), m_anchor(0), m_radius(0), m_blobDiameter(0), m_margin(0.5), m_scaleTolerance(3.0), m_tolerance(0.75),
+    m_twoSided(false)
+{
+  m_basis[0] = m_basis[1] = 0;
+}
+
+/*!
+  Set the points of the target.
+  \param points : Points of the target, in a plane with Z = 0 in the target frame.
+  \param anchor : Index of the point detected first.
+
+  The diameter of the blobs is set to 0.4 times the smallest distance between two points.
+  Call setBlobDiameter() afterwards if it is known.
+ */
+void vpBlobConstellation::setModel(const std::vector<vpPoint> &points, const unsigned int &anchor)
+{
+  const unsigned int n = (unsigned int)points.size();
+  if (n < 2 || anchor >= n)
+    throw vpException(vpException::badValue, "Cannot match %d points with the anchor %d", (int)n, (int)anchor);
+
+  m_oX.resize(n);
+  m_oY.resize(n);
+  for (unsigned int k = 0; k < n; k++) {
+    if (std::fabs(points[k].get_oZ()) > std::numeric_limits<double>::epsilon())
+      throw vpException(vpException::badValue, "The points of the constellation have to be in the plane Z = 0");
+    m_oX[k] = points[k].get_oX();
+    m_oY[k] = points[k].get_oY();
+  }
+  m_anchor = anchor;
+
+  // The farthest point from the anchor, then the one that gives the largest triangle
+  double min_distance = std::numeric_limits<double>::max();
+  m_radius = 0;
+  for (unsigned int k = 0; k < n; k++) {
+    for (unsigned int l = k+1; l < n; l++)
+      min_distance = std::min(min_distance, std::sqrt(vpMath::sqr(m_oX[l] - m_oX[k]) + vpMath::sqr(m_oY[l] - m_oY[k])));
+    double distance = std::sqrt(vpMath::sqr(m_oX[k] - m_oX[anchor]) + vpMath::sqr(m_oY[k] - m_oY[anchor]));
+    if (distance > m_radius) {
+      m_radius = distance;
+      m_basis[0] = k;
+    }
+  }
+  if (m_radius <= 0)
+    throw vpException(vpException::badValue, "The points of the constellation are all at the same location");
+
+  // When the points are aligned, the transformation is a similarity given by one point
+  m_basis[1] = m_basis[0];
+  double max_area = 1e-6 * m_radius * m_radius;
+  for (unsigned int k = 0; k < n; k++) {
+    double area = std::fabs((m_oX[m_basis[0]] - m_oX[anchor]) * (m_oY[k] - m_oY[anchor])
+        - (m_oY[m_basis[0]] - m_oY[anchor]) * (m_oX[k] - m_oX[anchor]));
+    if (area > max_area) {
+      max_area = area;
+      m_basis[1] = k;
+    }
+  }
+
+  m_blobDiameter = 0.4 * min_distance;
+}
+
+/*!
+  Return the area where the other blobs of the target are, whatever the orientation of the target.
+  \param anchor : Blob of the anchor.
+  \param I : Image, the area is clipped to it.
+ */
+vpRect vpBlobConstellation::getSearchArea(const vpDot2 &anchor, const vpImage<unsigned char> &I) const
+{
+  if (m_oX.empty())
+    throw vpException(vpException::notInitialized, "The model of the constellation is not set");
+
+  const double size = std::max(anchor.getWidth(), anchor.getHeight());
+  const double radius = m_radius * size / m_blobDiameter * (1 + m_margin) + size;
+  const vpImagePoint cog = anchor.getCog();
+  double left = std::max(0.0, cog.get_u() - radius);
+  double top = std::max(0.0, cog.get_v() - radius);
+  double right = std::min((double)I.getWidth() - 1, cog.get_u() + radius);
+  double bottom = std::min((double)I.getHeight() - 1, cog.get_v() + radius);
+  if (right < left || bottom < top)
+    return vpRect(0, 0, 0, 0);
+
+  return vpRect(vpImagePoint(top, left), vpImagePoint(bottom, right));
+}
+
+/*!
+  Match the blobs of one target.
+  \param anchor : Blob of the anchor.
+  \param candidates : Blobs found in the search area. They can include blobs that do not belong to the target.
+  \param blobs : Blob of each point of the model, the anchor included.
+  \return true if all the points are matched.
+ */
+bool vpBlobConstellation::match(const vpDot2 &anchor, const std::list<vpDot2> &candidates, std::vector<vpDot2> &blobs) const
+{
+  std::vector<const vpDot2 *> ptr;
+  for (std::list<vpDot2>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+    ptr.push_back(&(*it));
+  std::vector<bool> used(ptr.size(), false);
+  return match(anchor, ptr, used, blobs);
+}
+
+/*!
+  Match several targets that share the same candidates, one for each anchor. The anchors are
+  processed in order, and a candidate matched with a target is not used for the next ones.
+  \param anchors : Blob of the anchor of each target.
+  \param candidates : Blobs found in the search areas of all the anchors.
+  \param instances : Blobs of each target found, as given by match(const vpDot2 &, const std::list<vpDot2> &, std::vector<vpDot2> &).
+  \return Number of targets found.
+ */
+unsigned int vpBlobConstellation::match(const std::vector<vpDot2> &anchors, const std::list<vpDot2> &candidates,
+                                        std::vector<std::vector<vpDot2> > &instances) const
+{
+  std::vector<const vpDot2 *> ptr;
+  for (std::list<vpDot2>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+    ptr.push_back(&(*it));
+  std::vector<bool> used(ptr.size(), false);
+
+  instances.clear();
+  std::vector<vpDot2> blobs;
+  for (size_t i = 0; i < anchors.size(); i++) {
+    if (match(anchors[i], ptr, used, blobs))
+      instances.push_back(blobs);
+  }
+  return (unsigned int)instances.size();
+}
+
+bool vpBlobConstellation::match(const vpDot2 &anchor, const std::vector<const vpDot2 *> &candidates,
+                                std::vector<bool> &used, std::vector<vpDot2> &blobs) const
+{
+  if (m_oX.empty())
+    throw vpException(vpException::notInitialized, "The model of the constellation is not set");
+
+  const unsigned int n = (unsigned int)m_oX.size();
+  const unsigned int nb = (unsigned int)candidates.size();
+  const unsigned int a = m_anchor;
+  const double ua = anchor.getCog().get_u();
+  const double va = anchor.getCog().get_v();
+  const double size = std::max(anchor.getWidth(), anchor.getHeight());
+  const double scale = size / m_blobDiameter; // Pixels per meter
+  const double tolerance = vpMath::sqr(std::max(2.0, m_tolerance * size));
+  const bool similarity = (m_basis[0] == m_basis[1]);
+
+  // Model points relative to the anchor
+  std::vector<double> mx(n), my(n);
+  for (unsigned int k = 0; k < n; k++) {
+    mx[k] = m_oX[k] - m_oX[a];
+    my[k] = m_oY[k] - m_oY[a];
+  }
+  const unsigned int b1 = m_basis[0], b2 = m_basis[1];
+  const double det_m = mx[b1] * my[b2] - mx[b2] * my[b1];
+
+  // The anchor itself can be found again as a candidate
+  std::vector<bool> available(nb);
+  for (unsigned int j = 0; j < nb; j++)
+    available[j] = !used[j] && vpMath::sqr(candidates[j]->getCog().get_u() - ua) + vpMath::sqr(candidates[j]->getCog().get_v() - va) > vpMath::sqr(0.5 * size);
+
+  std::vector<int> assign(n), best(n);
+  std::vector<bool> taken(nb);
+  double best_error = std::numeric_limits<double>::max();
+
+  for (unsigned int c1 = 0; c1 < nb; c1++) {
+    if (!available[c1])
+      continue;
+    const double du1 = candidates[c1]->getCog().get_u() - ua;
+    const double dv1 = candidates[c1]->getCog().get_v() - va;
+
+    // With aligned points, the second hypothesis is the mirror one
+    const unsigned int nb_second = similarity ? (m_twoSided ? 2 : 1) : nb;
+    for (unsigned int c2 = 0; c2 < nb_second; c2++) {
+      double A[2][2];
+      if (similarity) {
+        // u + i v = (a + i b) (x + i y), or its mirror
+        const double norm = mx[b1] * mx[b1] + my[b1] * my[b1];
+        const double sign = c2 ? -1.0 : 1.0;
+        const double ar = (du1 * mx[b1] + sign * dv1 * my[b1]) / norm;
+        const double br = (dv1 * mx[b1] - sign * du1 * my[b1]) / norm;
+        A[0][0] = ar; A[0][1] = -sign * br;
+        A[1][0] = br; A[1][1] = sign * ar;
+      }
+      else {
+        if (c2 == c1 || !available[c2])
+          continue;
+        const double du2 = candidates[c2]->getCog().get_u() - ua;
+        const double dv2 = candidates[c2]->getCog().get_v() - va;
+        // A [m1 m2] = [d1 d2]
+        A[0][0] = (du1 * my[b2] - du2 * my[b1]) / det_m;
+        A[0][1] = (du2 * mx[b1] - du1 * mx[b2]) / det_m;
+        A[1][0] = (dv1 * my[b2] - dv2 * my[b1]) / det_m;
+        A[1][1] = (dv2 * mx[b1] - dv1 * mx[b2]) / det_m;
+      }
+
+      // Seen from the front, the image is not mirrored, and the scale is the one of the anchor
+      const double det = A[0][0] * A[1][1] - A[0][1] * A[1][0];
+      if (det <= 0 && !m_twoSided)
+        continue;
+      const double hypothesis_scale = std::sqrt(std::fabs(det));
+      if (hypothesis_scale < scale / m_scaleTolerance || hypothesis_scale > scale * m_scaleTolerance)
+        continue;
+
+      std::fill(taken.begin(), taken.end(), false);
+      double error = 0;
+      bool complete = true;
+      for (unsigned int k = 0; k < n && complete; k++) {
+        if (k == a)
+          continue;
+        const double u = ua + A[0][0] * mx[k] + A[0][1] * my[k];
+        const double v = va + A[1][0] * mx[k] + A[1][1] * my[k];
+        int nearest = -1;
+        double nearest_distance = tolerance;
+        for (unsigned int j = 0; j < nb; j++) {
+          if (!available[j] || taken[j])
+            continue;
+          double distance = vpMath::sqr(candidates[j]->getCog().get_u() - u) + vpMath::sqr(candidates[j]->getCog().get_v() - v);
+          if (distance <= nearest_distance) {
+            nearest = (int)j;
+            nearest_distance = distance;
+          }
+        }
+        if (nearest < 0)
+          complete = false;
+        else {
+          taken[nearest] = true;
+          assign[k] = nearest;
+          error += nearest_distance;
+        }
+      }
+
+      if (complete && error < best_error) {
+        best_error = error;
+        best = assign;
+      }
+    }
+  }
+
+  if (best_error == std::numeric_limits<double>::max())
+    return false;
+
+  blobs.resize(n);
+  for (unsigned int k = 0; k < n; k++) {
+    if (k == a)
+      blobs[k] = anchor;
+    else {
+      blobs[k] = *candidates[best[k]];
+      used[best[k]] = true;
+    }
+  }
+  return true;
+}
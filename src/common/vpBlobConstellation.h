@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Matching of the blobs of a target with the points of its model.
+ *
+ *****************************************************************************/
+#ifndef __vpBlobConstellation_h__
+#define __vpBlobConstellation_h__
+
+#include <list>
+#include <vector>
+
+#include <visp/vpDot2.h>
+#include <visp/vpPoint.h>
+#include <visp/vpRect.h>
+
+/*!
+  Find the blobs of a planar target made of N blobs, one of them (the anchor) being detected
+  first, like the colored blob of the hand targets.
+
+  The search area around the anchor is derived from the model and from the apparent size of
+  the anchor, which gives the number of pixels per meter once the diameter of the blobs is known.
+  The candidate blobs found in this area are then matched with the model: each pair of candidates
+  associated with two model points gives, with the anchor, the affine transformation of the
+  target plane in the image, that has to bring all the other model points on candidates with
+  the expected scale. The hypothesis with the smallest error is kept.
+
+  By default the target is seen from the front, with the Z axis of the target frame going away
+  from the camera, so that the symmetric patterns, like a square, are not matched upside down.
+
+  \code
+  vpBlobConstellation constellation;
+  constellation.setModel(points, 0); // The colored blob is the first point
+  vpRect area = constellation.getSearchArea(anchor, I);
+  black_blob.searchDotsInArea(I, area.getLeft(), area.getTop(), area.getWidth(), area.getHeight(), candidates);
+  std::vector<vpDot2> blobs;
+  if (constellation.match(anchor, candidates, blobs)) {
+    // blobs[k] is the blob of the model point k
+  }
+  \endcode
+ */
+class vpBlobConstellation
+{
+protected:
+  std::vector<double> m_oX; //!< Coordinates of the model points in the target plane
+  std::vector<double> m_oY;
+  unsigned int m_anchor; //!< Index of the point detected first
+  unsigned int m_basis[2]; //!< Points that give, with the anchor, the affine transformation
+  double m_radius; //!< Largest distance between the anchor and the other points, in meter
+  double m_blobDiameter; //!< Diameter of the blobs, in meter
+  double m_margin; //!< Margin of the search area, relative to its radius
+  double m_scaleTolerance; //!< Largest ratio between the scale of a hypothesis and the one of the anchor
+  double m_tolerance; //!< Largest distance between a point and its candidate, relative to the blob size
+  bool m_twoSided; //!< Accept the targets seen from behind
+
+public:
+  vpBlobConstellation();
+  virtual ~vpBlobConstellation() {}
+
+  unsigned int getAnchor() const { return m_anchor; }
+  double getBlobDiameter() const { return m_blobDiameter; }
+  unsigned int getNbPoints() const { return (unsigned int)m_oX.size(); }
+  vpRect getSearchArea(const vpDot2 &anchor, const vpImage<unsigned char> &I) const;
+
+  bool match(const vpDot2 &anchor, const std::list<vpDot2> &candidates, std::vector<vpDot2> &blobs) const;
+  unsigned int match(const std::vector<vpDot2> &anchors, const std::list<vpDot2> &candidates,
+                     std::vector<std::vector<vpDot2> > &instances) const;
+
+  void setBlobDiameter(const double &diameter) { m_blobDiameter = diameter; }
+  void setMargin(const double &margin) { m_margin = margin; }
+  void setModel(const std::vector<vpPoint> &points, const unsigned int &anchor=0);
+  void setScaleTolerance(const double &tolerance) { m_scaleTolerance = tolerance; }
+  void setTolerance(const double &tolerance) { m_tolerance = tolerance; }
+  void setTwoSided(const bool &two_sided) { m_twoSided = two_sided; }
+
+protected:
+  bool match(const vpDot2 &anchor, const std::vector<const vpDot2 *> &candidates,
+             std::vector<bool> &used, std::vector<vpDot2> &blobs) const;
+};
+
+#endif
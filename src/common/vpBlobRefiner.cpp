@@ -0,0 +1,239 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Sub-pixel center of gravity of a blob weighted by the gray levels.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp/vpMath.h>
+#include <visp/vpRect.h>
+
+#include <vpBlobRefiner.h>
+
+/*!
+  Median of the gray levels counted in \e histogram between \e first and \e last, interpolated in
+  the bin of the median so that it is not rounded to a gray level.
+ */
+static double histogramMedian(const unsigned int *histogram, int first, int last)
+{
+  unsigned int total = 0;
+  for (int level = first; level <= last; level++)
+    total += histogram[level];
+  if (total == 0)
+    return 0.5 * (first + last);
+
+  const double half = 0.5 * total;
+  unsigned int count = 0;
+  int level = first;
+  while (count + histogram[level] < half)
+    count += histogram[level++];
+  return level - 0.5 + (half - count) / histogram[level];
+}
+
+/*!
+  Default constructor.
+ */
+vpBlobRefiner::vpBlobRefiner()
+  : m_cog(), m_area(0), m_mu20(0), m_mu02(0), m_mu11(0), m_margin(2), m_minContrast(10.),
+    m_grayLevelNoise(2.), m_weights()
+{
+  m_covariance[0] = m_covariance[1] = m_covariance[2] = 0;
+}
+
+/*!
+  Add the moments of a row of weights.
+  \param weights : Weights of the row, scaled to 0-255.
+  \param edges : 1 for the edge pixels of the row, 0 for the others.
+  \param n : Number of pixels of the row.
+  \param v : Row in the window.
+  \param sums : Moments updated.
+ */
+void vpBlobRefiner::accumulate(const unsigned char *weights, const unsigned char *edges, int n, int v,
+                               vpSums &sums)
+{
+  // Integer sums over chunks of 256 pixels, that cannot overflow, the products by the position of
+  // the chunk and by v being done once per chunk
+  for (int start = 0; start < n; start += 256) {
+    const int end = std::min(n, start + 256);
+    int s0 = 0, s1 = 0, s2 = 0, e0 = 0, e1 = 0, e2 = 0;
+    for (int u = 0; u < end - start; u++) {
+      const int w = weights[start + u];
+      const int e = edges[start + u];
+      s0 += w;
+      s1 += w * u;
+      s2 += w * u * u;
+      e0 += e;
+      e1 += e * u;
+      e2 += e * u * u;
+    }
+
+    const double u0 = start;
+    const double su = s1 + u0 * s0, eu = e1 + u0 * e0;
+    sums.w += s0;
+    sums.wu += su;
+    sums.wv += (double)v * s0;
+    sums.wuu += s2 + 2. * u0 * s1 + u0 * u0 * s0;
+    sums.wvv += (double)v * v * s0;
+    sums.wuv += v * su;
+    sums.e += e0;
+    sums.eu += eu;
+    sums.ev += (double)v * e0;
+    sums.euu += e2 + 2. * u0 * e1 + u0 * u0 * e0;
+    sums.evv += (double)v * v * e0;
+    sums.euv += v * eu;
+  }
+}
+
+/*!
+  Covariance of the center of gravity given by the last refine(), 2x2 in squared pixels, u then v.
+ */
+vpMatrix vpBlobRefiner::getCovariance() const
+{
+  vpMatrix covariance(2, 2);
+  covariance[0][0] = m_covariance[0];
+  covariance[1][1] = m_covariance[1];
+  covariance[0][1] = covariance[1][0] = m_covariance[2];
+  return covariance;
+}
+
+/*!
+  Ellipse of the blob given by the weighted second order moments. For a disk, the axes are its radius.
+  \param a : Major semi-axis in pixels.
+  \param b : Minor semi-axis in pixels.
+  \param angle : Angle of the major axis from the u axis towards the v axis, in radian.
+ */
+void vpBlobRefiner::getEllipse(double &a, double &b, double &angle) const
+{
+  const double mean = 0.5 * (m_mu20 + m_mu02);
+  const double delta = sqrt(vpMath::sqr(0.5 * (m_mu20 - m_mu02)) + m_mu11 * m_mu11);
+  a = 2. * sqrt(mean + delta);
+  b = 2. * sqrt(std::max(mean - delta, 0.));
+  angle = 0.5 * atan2(2. * m_mu11, m_mu20 - m_mu02);
+}
+
+/*!
+  Compute the center of gravity, the ellipse and the covariance of a tracked blob.
+  \param I : Image where the blob is tracked.
+  \param dot : Blob, whose bounding box and mean gray level are used.
+  \return false if the blob is too close to the border of the image or if its contrast with the
+  background is lower than setMinContrast(). The results of the previous call are then kept.
+ */
+bool vpBlobRefiner::refine(const vpImage<unsigned char> &I, const vpDot2 &dot)
+{
+  const vpRect bbox = dot.getBBox();
+  const int left = std::max(0, (int)bbox.getLeft() - (int)m_margin);
+  const int top = std::max(0, (int)bbox.getTop() - (int)m_margin);
+  const int right = std::min((int)I.getWidth() - 1, (int)bbox.getRight() + (int)m_margin);
+  const int bottom = std::min((int)I.getHeight() - 1, (int)bbox.getBottom() + (int)m_margin);
+  if (right - left < 2 || bottom - top < 2)
+    return false;
+
+  // Background level, the median of the border of the window
+  unsigned int histogram[256];
+  std::fill(histogram, histogram + 256, 0u);
+  for (int u = left; u <= right; u++) {
+    histogram[I[top][u]]++;
+    histogram[I[bottom][u]]++;
+  }
+  for (int v = top + 1; v < bottom; v++) {
+    histogram[I[v][left]]++;
+    histogram[I[v][right]]++;
+  }
+  const double background = histogramMedian(histogram, 0, 255);
+  if (std::fabs(dot.getMeanGrayLevel() - background) < m_minContrast)
+    return false;
+
+  // Level of the blob, the median of the pixels of the window on the side of the blob. The mean
+  // gray level of vpDot2 also counts the edge pixels, which would stretch the ramp.
+  std::fill(histogram, histogram + 256, 0u);
+  for (int v = top; v <= bottom; v++)
+    for (int u = left; u <= right; u++)
+      histogram[I[v][u]]++;
+  const int middle = vpMath::round(0.5 * (background + dot.getMeanGrayLevel()));
+  const double foreground = dot.getMeanGrayLevel() < background ? histogramMedian(histogram, 0, middle)
+                                                                : histogramMedian(histogram, middle, 255);
+  const double contrast = foreground - background;
+  if (std::fabs(contrast) < m_minContrast)
+    return false;
+
+  // The noise of the background and of the blob is cut by a dead zone of two standard deviations
+  // at both ends of the ramp. Otherwise it only increases the weights, which biases the area and
+  // adds the noise of the whole window to the center of gravity.
+  const double dead_zone = std::min(2. * m_grayLevelNoise, 0.25 * std::fabs(contrast));
+  const double ramp = contrast > 0 ? contrast - 2. * dead_zone : contrast + 2. * dead_zone;
+  const double start = contrast > 0 ? background + dead_zone : background - dead_zone;
+
+  // Weight scaled to 0-255 in 16 bits fixed point: (level - start) * 255 / ramp
+  const int gain = (int)(255. * 65536. / ramp);
+  const int bias = 32768 - (int)(start * gain);
+
+  // The edge pixels, whose weight changes with the noise, are the ones between the levels of the
+  // background and of the blob, dead zones included
+  const int edge_margin = (int)(dead_zone * 255. / std::fabs(ramp));
+
+  const int n = right - left + 1;
+  if (m_weights.size() < (size_t)(2 * n))
+    m_weights.resize(2 * n);
+  unsigned char *weights = &m_weights[0];
+  unsigned char *edges = weights + n;
+
+  vpSums sums = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  for (int v = top; v <= bottom; v++) {
+    const unsigned char *levels = I[v] + left;
+    for (int u = 0; u < n; u++) {
+      const int w = (levels[u] * gain + bias) >> 16;
+      weights[u] = (unsigned char)std::min(std::max(w, 0), 255);
+      edges[u] = (w > -edge_margin) & (w < 255 + edge_margin);
+    }
+    accumulate(weights, edges, n, v - top, sums);
+  }
+  if (sums.w <= 0)
+    return false;
+
+  const double cu = sums.wu / sums.w;
+  const double cv = sums.wv / sums.w;
+  m_area = sums.w / 255.;
+  m_mu20 = sums.wuu / sums.w - cu * cu;
+  m_mu02 = sums.wvv / sums.w - cv * cv;
+  m_mu11 = sums.wuv / sums.w - cu * cv;
+
+  // Derivative of the center of gravity with the weight of a pixel: (u - cu) / area
+  const double scale = vpMath::sqr(m_grayLevelNoise / ramp / m_area);
+  m_covariance[0] = scale * (sums.euu - 2. * cu * sums.eu + cu * cu * sums.e);
+  m_covariance[1] = scale * (sums.evv - 2. * cv * sums.ev + cv * cv * sums.e);
+  m_covariance[2] = scale * (sums.euv - cu * sums.ev - cv * sums.eu + cu * cv * sums.e);
+
+  m_cog.set_uv(left + cu, top + cv);
+  return true;
+}
@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Sub-pixel center of gravity of a blob weighted by the gray levels.
+ *
+ *****************************************************************************/
+#ifndef __vpBlobRefiner_h__
+#define __vpBlobRefiner_h__
+
+#include <vector>
+
+#include <visp/vpDot2.h>
+#include <visp/vpImage.h>
+#include <visp/vpImagePoint.h>
+#include <visp/vpMatrix.h>
+
+/*!
+  Refine the center of gravity of a blob with the gray levels of its pixels.
+
+  vpDot2 computes the center of gravity of the pixels inside its gray level range, so that a
+  pixel on the edge of the blob counts fully or not at all. Here each pixel of the bounding box
+  of the blob, enlarged by a margin, is weighted by its gray level: 0 at the level of the
+  background, given by the median of the border of the window, and 1 at the mean gray level of
+  the blob, with a linear ramp between them. The edge pixels then count for the part of the blob
+  they cover, and the center of gravity is sub-pixel.
+
+  The noise of the background and of the blob is removed by a dead zone of two standard
+  deviations of the gray level noise at both ends of the ramp, and the levels of the background
+  and of the blob are medians, interpolated between the gray levels.
+
+  The weighted second order moments give the ellipse of the blob. The covariance of the center
+  of gravity comes from the gray level noise of the edge pixels, the only ones whose weight
+  changes with the noise.
+
+  The weights are computed in fixed point and the moments accumulated row by row with integer
+  sums, in loops that the compiler vectorizes. No memory is allocated once the row buffer has
+  the width of the window.
+
+  \code
+  vpBlobRefiner refiner;
+  if (refiner.refine(I, dot))
+    cog = refiner.getCog();
+  \endcode
+ */
+class vpBlobRefiner
+{
+protected:
+  struct vpSums
+  {
+    double w, wu, wv, wuu, wvv, wuv; //!< Moments of the weights, scaled to 0-255
+    double e, eu, ev, euu, evv, euv; //!< Moments of the edge pixels
+  };
+
+  vpImagePoint m_cog; //!< Sub-pixel center of gravity
+  double m_area; //!< Sum of the weights, in pixels
+  double m_mu20, m_mu02, m_mu11; //!< Centered second order moments divided by the area
+  double m_covariance[3]; //!< Variance of u, variance of v and covariance of the center of gravity
+  unsigned int m_margin;
+  double m_minContrast;
+  double m_grayLevelNoise;
+  std::vector<unsigned char> m_weights; //!< Weights of a row of the window, scaled to 0-255, then its edge pixels
+
+  static void accumulate(const unsigned char *weights, const unsigned char *edges, int n, int v, vpSums &sums);
+
+public:
+  vpBlobRefiner();
+  virtual ~vpBlobRefiner() {}
+
+  /*!
+    Number of pixels of the blob, the edge pixels counting for the part they cover.
+    */
+  double getArea() const { return m_area; }
+  vpImagePoint getCog() const { return m_cog; }
+  vpMatrix getCovariance() const;
+  void getEllipse(double &a, double &b, double &angle) const;
+
+  bool refine(const vpImage<unsigned char> &I, const vpDot2 &dot);
+
+  /*!
+    Standard deviation of the gray level noise of the camera, 2 by default.
+    */
+  void setGrayLevelNoise(const double &sigma) { m_grayLevelNoise = sigma; }
+
+  /*!
+    Number of pixels added around the bounding box of the blob, 2 by default.
+    */
+  void setMargin(const unsigned int &margin) { m_margin = margin; }
+
+  /*!
+    Smallest difference between the gray levels of the blob and of the background to refine
+    the center of gravity, 10 by default.
+    */
+  void setMinContrast(const double &contrast) { m_minContrast = contrast; }
+};
+
+#endif
@@ -1,18 +1,54 @@
 
+#include <algorithm>
+#include <cstdio>
+
 #include <vpBlobsTargetTracker.h>
 #include <visp/vpDisplay.h>
+#include <visp/vpMeterPixelConversion.h>
+#include <visp/vpTime.h>
+
+
+/*
+  Track blobs in parallel. Each task only writes the blob it tracks and its status, and the
+  exceptions do not leave the task, so that the results do not depend on the scheduling.
+ */
+class vpBlobsTrackingTasks : public cv::ParallelLoopBody
+{
+public:
+    vpBlobsTrackingTasks(vpDot2 * const *dots, const vpImage<unsigned char> * const *images, bool *tracked)
+        : m_dots(dots), m_images(images), m_tracked(tracked) {}
+
+    void operator()(const cv::Range &range) const
+    {
+        for (int k = range.start; k < range.end; k++) {
+            try {
+                m_dots[k]->track(*m_images[k]);
+                m_tracked[k] = true;
+            }
+            catch(vpException &) {
+                m_tracked[k] = false;
+            }
+        }
+    }
 
+private:
+    vpDot2 * const *m_dots;
+    const vpImage<unsigned char> * const *m_images;
+    bool *m_tracked;
+};
 
 vpBlobsTargetTracker::vpBlobsTargetTracker()
   : m_colBlob(),  m_state(detection), m_target_found(false), m_P(), m_force_detection(false), m_name("target_blob"),
-    m_blob_list(), m_cog(0,0), m_initPose(true), m_numBlobs(4), m_manual_blob_init(false), m_left_hand_target(true),
-    m_grayLevelMinBlob(0), m_grayLevelMaxBlob(50), m_full_manual(false)
+    m_blob_list(), m_nbBlobs(0), m_poseSolver(), m_cog(0,0), m_initPose(true), m_numBlobs(4), m_manual_blob_init(false),
+    m_grayLevelMinBlob(0), m_grayLevelMaxBlob(50), m_full_manual(false), m_colorModel(), m_adaptiveColor(false),
+    m_parallelTracking(false), m_localRecovery(true), m_nbLocalRecoveries(0), m_nbFullRecoveries(0),
+    m_constellation(), m_poseFilter(), m_filterPose(false), m_frameTime(-1), m_dotExtractor(), m_batchedDotSearch(true),
+    m_refiner(), m_subPixel(false), m_cogNoise(0.5)
 {
 
   //m_colBlob = new vpColorDetection;
   m_colBlob.setMaxAndMinObjectArea(150.0,4000.0);
   m_colBlob.setLevelMorphOps(false);
-  m_blob_list.resize(4);
 
 }
 
@@ -20,6 +56,46 @@ vpBlobsTargetTracker::~vpBlobsTargetTracker()
 {
 }
 
+/*!
+  Load the HSV range of the colored blob. When the adaptive color is enabled, the color
+  model is initialized again from the new range.
+  \param name_file : File written by vpColorDetection::saveHSV().
+  \return true if the file was read.
+  */
+bool vpBlobsTargetTracker::loadHSV(const std::string name_file)
+{
+  if (!m_colBlob.loadHSV(name_file))
+    return false;
+
+  if (m_adaptiveColor) {
+    std::vector<int> values = m_colBlob.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+    const int hsv_min[3] = {values[0], values[2], values[4]};
+    const int hsv_max[3] = {values[1], values[3], values[5]};
+    m_colorModel.initFromRange(hsv_min, hsv_max);
+  }
+  return true;
+}
+
+/*!
+  Enable or disable the adaptive color model. When enabled, the colored blob is detected with
+  a hue-saturation model instead of the HSV range, and the model is updated with the pixels of
+  the colored blob each time the target is tracked with track(const cv::Mat &, const vpImage<unsigned char> &),
+  so that it follows the changes of lighting.
+
+  The model starts from the one given to loadColorModel() if any, otherwise from the HSV range.
+  */
+void vpBlobsTargetTracker::setAdaptiveColor(const bool &enable)
+{
+  m_adaptiveColor = enable;
+  if (enable && !m_colorModel.isInitialized()) {
+    std::vector<int> values = m_colBlob.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+    const int hsv_min[3] = {values[0], values[2], values[4]};
+    const int hsv_max[3] = {values[1], values[3], values[5]};
+    m_colorModel.initFromRange(hsv_min, hsv_max);
+  }
+  m_colBlob.setColorModel(enable ? &m_colorModel : NULL);
+}
+
 
 /*!
     Return the center of gravity location of the tracked bar code.
@@ -31,18 +107,172 @@ vpImagePoint vpBlobsTargetTracker::getCog()
 
 
 
+/*!
+  Move the tracked target by the motion of the camera and of the target predicted from the joints
+  of the robot, so that the next track() searches the blobs where they are expected. The pose
+  returned by get_cMo() becomes the predicted one. Nothing is done when the target is not tracked.
+  \param predictor : Camera and target displacements since the last call to track().
+  */
+void vpBlobsTargetTracker::predictMotion(const vpMotionPredictor &predictor)
+{
+  if (m_state != tracking || m_force_detection)
+    return;
+
+  vpHomogeneousMatrix cMo = predictor.predict(m_cMo);
+  vpImagePoint predicted[maxBlobs];
+  if (!predictBlobs(cMo, predicted))
+    return;
+
+  m_cMo = cMo;
+  for (unsigned int i = 0; i < m_nbBlobs; i++)
+    m_blobs[i].setCog(predicted[i]);
+}
+
+/*!
+  Detect and track the target.
+  \param cvI : Color image, used to detect the colored blob.
+  \param I : Gray level image of the same frame, used to track the blobs.
+  \return true if the target is tracked.
+  */
 bool vpBlobsTargetTracker::track(const cv::Mat &cvI, const vpImage<unsigned char> &I )
+{
+  bool obj_found = false;
+  if ((m_state == detection || m_force_detection) && !m_manual_blob_init && !m_full_manual)
+    obj_found = m_colBlob.detect(cvI);
+
+  bool tracked = trackBlobs(I, obj_found);
+  if (tracked)
+    updateColorModel(cvI);
+
+  return tracked;
+}
+
+/*!
+  Detect and track several targets. The targets in the detection state are processed one after
+  the other as with track(const cv::Mat &, const vpImage<unsigned char> &), then the blobs of all
+  the targets in the tracking state are tracked together in parallel, whatever setParallelTracking().
+  The results are the same as when the targets are tracked one after the other.
+  \param trackers : At most maxTrackers targets.
+  \param cvI : Color image of each target.
+  \param I : Gray level image of each target.
+  \param status : Updated with true for each tracked target.
+  */
+void vpBlobsTargetTracker::trackTargets(const std::vector<vpBlobsTargetTracker*> &trackers, const std::vector<cv::Mat> &cvI,
+                                        const std::vector<vpImage<unsigned char> > &I, std::vector<bool> &status)
+{
+  if (trackers.size() > maxTrackers)
+    throw vpException(vpException::dimensionError, "Cannot track %d targets together: at most %d targets are supported", (int)trackers.size(), (int)maxTrackers);
+  if (cvI.size() != trackers.size() || I.size() != trackers.size())
+    throw vpException(vpException::dimensionError, "Cannot track %d targets from %d color and %d gray level images", (int)trackers.size(), (int)cvI.size(), (int)I.size());
+
+  if (trackers.empty()) {
+    status.clear();
+    return;
+  }
+
+  const cv::Mat *cvI_ptr[maxTrackers];
+  const vpImage<unsigned char> *I_ptr[maxTrackers];
+  for (unsigned int t = 0; t < trackers.size(); t++) {
+    cvI_ptr[t] = &cvI[t];
+    I_ptr[t] = &I[t];
+  }
+  trackTargets(&trackers[0], cvI_ptr, I_ptr, trackers.size(), status);
+}
+
+/*!
+  Detect and track several targets in the same image. See trackTargets(const std::vector<vpBlobsTargetTracker*> &,
+  const std::vector<cv::Mat> &, const std::vector<vpImage<unsigned char> > &, std::vector<bool> &).
+  */
+void vpBlobsTargetTracker::trackTargets(const std::vector<vpBlobsTargetTracker*> &trackers, const cv::Mat &cvI,
+                                        const vpImage<unsigned char> &I, std::vector<bool> &status)
+{
+  if (trackers.size() > maxTrackers)
+    throw vpException(vpException::dimensionError, "Cannot track %d targets together: at most %d targets are supported", (int)trackers.size(), (int)maxTrackers);
+
+  if (trackers.empty()) {
+    status.clear();
+    return;
+  }
+
+  const cv::Mat *cvI_ptr[maxTrackers];
+  const vpImage<unsigned char> *I_ptr[maxTrackers];
+  for (unsigned int t = 0; t < trackers.size(); t++) {
+    cvI_ptr[t] = &cvI;
+    I_ptr[t] = &I;
+  }
+  trackTargets(&trackers[0], cvI_ptr, I_ptr, trackers.size(), status);
+}
+
+void vpBlobsTargetTracker::trackTargets(vpBlobsTargetTracker * const *trackers, const cv::Mat * const *cvI,
+                                        const vpImage<unsigned char> * const *I, unsigned int nb, std::vector<bool> &status)
+{
+  status.resize(nb);
+
+  vpBlobsTargetTracker *batch[maxTrackers];
+  const vpImage<unsigned char> *batch_I[maxTrackers];
+  unsigned int batch_index[maxTrackers];
+  unsigned int batch_size = 0;
+  for (unsigned int t = 0; t < nb; t++) {
+    if (trackers[t]->m_state == tracking && !trackers[t]->m_force_detection) {
+      batch[batch_size] = trackers[t];
+      batch_I[batch_size] = I[t];
+      batch_index[batch_size] = t;
+      batch_size++;
+    }
+    else
+      status[t] = trackers[t]->track(*cvI[t], *I[t]);
+  }
+
+  trackBlobsInParallel(batch, batch_I, batch_size);
+
+  for (unsigned int k = 0; k < batch_size; k++) {
+    const unsigned int t = batch_index[k];
+    status[t] = batch[k]->m_target_found;
+    if (status[t])
+      batch[k]->updateColorModel(*cvI[t]);
+  }
+}
+
+/*!
+  Update the adaptive color model with the colored blob, once the target is tracked.
+  */
+void vpBlobsTargetTracker::updateColorModel(const cv::Mat &cvI)
+{
+  // The first blob is the colored one
+  if (m_adaptiveColor && !m_full_manual && m_nbBlobs > 0) {
+    vpRect bbox = m_blobs[0].getBBox();
+    m_colorModel.update(cvI, cv::Rect((int)bbox.getLeft(), (int)bbox.getTop(), (int)bbox.getWidth(), (int)bbox.getHeight()));
+  }
+}
+
+/*!
+  Detect and track the target from a YUV422 camera buffer (Y0 U Y1 V).
+  The colored blob is detected on the YUV buffer and the luma plane is copied in \e I,
+  so that no color conversion is needed.
+  \param yuyv : Buffer of I.getWidth()*I.getHeight()*2 bytes.
+  \param I : Image with the size of the camera image, updated with the luma plane and used to track the blobs.
+  \return true if the target is tracked.
+  */
+bool vpBlobsTargetTracker::trackYUV422(const unsigned char *yuyv, vpImage<unsigned char> &I)
+{
+  bool obj_found = false;
+  if ((m_state == detection || m_force_detection) && !m_manual_blob_init && !m_full_manual)
+    obj_found = m_colBlob.detectYUV422(yuyv, I);
+  else
+    vpYUVColorClassifier::extractLuma(yuyv, I.getWidth(), I.getHeight(), I.bitmap);
+
+  return trackBlobs(I, obj_found);
+}
+
+bool vpBlobsTargetTracker::trackBlobs(const vpImage<unsigned char> &I, bool obj_found)
 {
 
   if (m_state == detection || m_force_detection) {
     //std::cout << "STATE: DETECTION "<< std::endl;
 
-    bool obj_found = false;
-    if (!m_manual_blob_init && !m_full_manual)
-      obj_found = m_colBlob.detect(cvI);
     // Delete previuos list of blobs
     m_blob_list.clear();
-    m_blob_list.resize(4);
+    m_nbBlobs = 0;
     m_initPose = true;
     m_target_found = false;
 
@@ -55,19 +285,22 @@ bool vpBlobsTargetTracker::track(const cv::Mat &cvI, const vpImage<unsigned char
         {
 
           std::cout << "Full manual" << std::endl;
-          vpDisplay::displayText(I, vpImagePoint(I.getHeight() - 10, 10), "Click on the 4 blobs", vpColor::red);
+          vpDisplay::displayText(I, vpImagePoint(I.getHeight() - 10, 10), "Click on the blobs in the order of the points", vpColor::red);
 
           vpDisplay::flush(I);
-          for(std::list<vpDot2>::iterator it=m_blob_list.begin(); it != m_blob_list.end(); ++it)
+          for(unsigned int i = 0; i < m_numBlobs; i++)
           {
 
-            (*it).setGraphics(true);
-            (*it).setGraphicsThickness(1);
-            (*it).initTracking(I);
-            (*it).track(I);
+            m_blobs[i] = vpDot2();
+            m_blobs[i].setGraphics(true);
+            m_blobs[i].setGraphicsThickness(1);
+            m_blobs[i].initTracking(I);
+            m_blobs[i].track(I);
+            m_blobPoint[i] = i;
             vpDisplay::flush(I);
 
           }
+          m_nbBlobs = m_numBlobs;
 
 
           m_state = tracking;
@@ -116,54 +349,39 @@ bool vpBlobsTargetTracker::track(const cv::Mat &cvI, const vpImage<unsigned char
           black_blob.setGrayLevelMax(m_grayLevelMaxBlob);
           black_blob.setGrayLevelMin(m_grayLevelMinBlob);
 
-          int i,j,aj,ai;
-
-          if(m_left_hand_target)
-          {
-            i = blob.getCog().get_i()-blob.getHeight()*2.3;
-            j = blob.getCog().get_j()-blob.getWidth()*3.3;
-            ai = blob.getHeight()*5;
-            aj = blob.getWidth()*5;
-          }
+          // Search the other blobs around the colored one, in an area given by the model of the target
+          vpRect area = m_constellation.getSearchArea(blob, I);
+          //vpDisplay::displayRectangle(I, area, vpColor::red, false, 1);
+          if (m_batchedDotSearch)
+            m_dotExtractor.searchDotsInArea(I, black_blob, (int)area.getLeft(), (int)area.getTop(),
+                                            (unsigned int)area.getWidth(), (unsigned int)area.getHeight(), m_blob_list);
           else
-          {
-            i = blob.getCog().get_i()-blob.getHeight();
-            j = blob.getCog().get_j()-blob.getWidth()*2.0;
-            ai = blob.getHeight()*4.5;
-            aj = blob.getWidth()*4;
-
-          }
-
-          //search similar blobs in the image and store them in blob_list
-          //black_blob.searchDotsInArea(I, 0, 0, I.getWidth(), I.getHeight(), m_blob_list);
-          //vpDisplay::displayRectangle(I, i, j, ai, aj, vpColor::red, false, 1);
-          black_blob.searchDotsInArea(I, j, i, ai, aj, m_blob_list);
+            black_blob.searchDotsInArea(I, (int)area.getLeft(), (int)area.getTop(),
+                                        (unsigned int)area.getWidth(), (unsigned int)area.getHeight(), m_blob_list);
 
           //        vpDisplay::flush(I);
           //        vpDisplay::getClick(I,true);
 
-          m_blob_list.insert(m_blob_list.begin(),blob);
-          std::cout << "SIZE: " << m_blob_list.size() << std::endl;
-
-          if(m_blob_list.size() == m_numBlobs)
+          // Keep only the blobs that have the geometry of the target, the colored blob first
+          std::vector<vpDot2> matched;
+          if(m_constellation.match(blob, m_blob_list, matched))
           {
-            for(std::list<vpDot2>::iterator it = m_blob_list.begin(); it != m_blob_list.end(); ++it)
+            // The blobs are tracked from a contiguous array, so that the tracking does not allocate memory.
+            // The blob k is the one of the point k, an association kept during the tracking
+            for(unsigned int k = 0; k < matched.size(); k++)
             {
-              //it->setEllipsoidShapePrecision(0.8);
-              it->setEllipsoidShapePrecision(0.75);
-            }
-            if (1){
-              for(std::list<vpDot2>::iterator it = m_blob_list.begin(); it != m_blob_list.end(); ++it)
-              {
-                it->initTracking(I, it->getCog());
-
-              }
+              m_blobPoint[m_nbBlobs] = k;
+              vpDot2 &dot = m_blobs[m_nbBlobs++];
+              dot = matched[k];
+              //dot.setEllipsoidShapePrecision(0.8);
+              dot.setEllipsoidShapePrecision(0.75);
+              dot.initTracking(I, dot.getCog());
             }
             m_state = tracking;
             m_force_detection = false;
           }
           else
-            std::cout << "Number blobs found is "<< m_blob_list.size() << ". Expected number: " << m_numBlobs << std::endl;
+            std::cout << "Target not found among the " << m_blob_list.size() << " blobs around the colored one" << std::endl;
         }
       }
       catch(vpException &e) {
@@ -176,118 +394,288 @@ bool vpBlobsTargetTracker::track(const cv::Mat &cvI, const vpImage<unsigned char
   }
   else if (m_state == tracking) {
     // std::cout << "STATE: TRACKING "<< std::endl;
-    try {
-
-      m_cog.set_uv(0.0,0.0);
-      for(std::list<vpDot2>::iterator it = m_blob_list.begin(); it != m_blob_list.end(); ++it)
-      {
-        it->track(I);
-        m_cog += it->getCog();
+    if (m_parallelTracking) {
+      vpBlobsTargetTracker *tracker = this;
+      const vpImage<unsigned char> *image = &I;
+      trackBlobsInParallel(&tracker, &image, 1);
+    }
+    else {
+      bool blob_tracked[maxBlobs];
+      for(unsigned int i = 0; i < m_nbBlobs; i++) {
+        try {
+          m_blobs[i].track(I);
+          blob_tracked[i] = true;
+        }
+        catch(vpException &e) {
+          std::cout << "Exception tracking: " << e.getStringMessage() << std::endl;
+          blob_tracked[i] = false;
+        }
       }
+      endTracking(I, blob_tracked);
+    }
+  }
+  return m_target_found;
+}
 
+/*!
+  Track the blobs of several targets in the tracking state with a single cv::parallel_for_(),
+  then update the targets one after the other, in the order of \e trackers.
+  \param trackers : At most maxTrackers targets.
+  \param I : Image of each target.
+  \param nb : Number of targets.
+  */
+void vpBlobsTargetTracker::trackBlobsInParallel(vpBlobsTargetTracker * const *trackers, const vpImage<unsigned char> * const *I,
+                                                unsigned int nb)
+{
+  vpDot2 *dots[maxTrackers * maxBlobs];
+  const vpImage<unsigned char> *images[maxTrackers * maxBlobs];
+  bool tracked[maxTrackers * maxBlobs];
+  unsigned int nb_dots = 0;
+  for (unsigned int t = 0; t < nb; t++) {
+    for (unsigned int i = 0; i < trackers[t]->m_nbBlobs; i++) {
+      // vpDisplay is not thread safe, the blobs are displayed once tracked
+      trackers[t]->m_blobs[i].setGraphics(false);
+      dots[nb_dots] = &trackers[t]->m_blobs[i];
+      images[nb_dots] = I[t];
+      nb_dots++;
+    }
+  }
 
-      m_cog /= m_blob_list.size();
-
-      // Display the ACTUAL center of gravity of the object
-      //vpDisplay::displayCross(I,cog_tot,10, vpColor::blue,2 );
-
-      //      std::vector<vpImagePoint> corners(m_blob_list.begin(),m_blob_list.end());
-
-
-
-      // Now we create a map of VpPoint in order to order the points
-
-      std::map< double,vpImagePoint> poly_verteces;
-
-      double theta;
-      for(std::list<vpDot2>::iterator it=m_blob_list.begin(); it != m_blob_list.end(); ++it)
-      {
-        // Get the cog of the blob
-        vpImagePoint cog = it->getCog();
+  if (nb_dots > 0)
+    cv::parallel_for_(cv::Range(0, nb_dots), vpBlobsTrackingTasks(dots, images, tracked), nb_dots);
+
+  nb_dots = 0;
+  for (unsigned int t = 0; t < nb; t++) {
+    const bool *blob_tracked = &tracked[nb_dots];
+    for (unsigned int i = 0; i < trackers[t]->m_nbBlobs; i++, nb_dots++) {
+      vpDot2 &dot = trackers[t]->m_blobs[i];
+      dot.setGraphics(true);
+      if (!tracked[nb_dots])
+        std::cout << "Exception tracking: blob " << i << " of " << trackers[t]->m_name << " is lost" << std::endl;
+      else if (I[t]->display != NULL)
+        dot.display(*I[t], vpColor::red);
+    }
+    trackers[t]->endTracking(*I[t], blob_tracked);
+  }
+}
 
-        theta = atan2(cog.get_v() - m_cog.get_v(), cog.get_u() - m_cog.get_u());
-        // Insert the vertexes in the map (ordered)
-        poly_verteces.insert ( std::pair<double,vpImagePoint>(theta,cog) );
+/*!
+  Update the target from the blobs tracked in the current frame. When the local recovery is
+  enabled, the blobs that are lost or that collapsed on another blob are searched again around
+  their projection with the previous pose, and the target is detected again only if this fails.
+  \param I : Image where the blobs were tracked.
+  \param blob_tracked : false for each blob whose tracking failed.
+  \return true if the target is found.
+  */
+bool vpBlobsTargetTracker::endTracking(const vpImage<unsigned char> &I, const bool *blob_tracked)
+{
+  m_target_found = false;
+
+  bool lost[maxBlobs];
+  unsigned int nb_lost = 0;
+  for (unsigned int i = 0; i < m_nbBlobs; i++) {
+    lost[i] = !blob_tracked[i];
+    if (lost[i])
+      nb_lost++;
+  }
 
+  vpImagePoint predicted[maxBlobs];
+  bool recovery = m_localRecovery && predictBlobs(m_cMo, predicted);
+  if (recovery) {
+    // Of two blobs on the same point, keep the one closest to its projection
+    for (unsigned int i = 0; i + 1 < m_nbBlobs; i++) {
+      for (unsigned int j = i+1; j < m_nbBlobs; j++) {
+        if (lost[i] || lost[j] || vpImagePoint::sqrDistance(m_blobs[i].getCog(), m_blobs[j].getCog()) >= 5.0)
+          continue;
+        if (vpImagePoint::sqrDistance(m_blobs[i].getCog(), predicted[i]) > vpImagePoint::sqrDistance(m_blobs[j].getCog(), predicted[j]))
+          lost[i] = true;
+        else
+          lost[j] = true;
+        nb_lost++;
       }
+    }
+  }
 
-      // Now we create a Vector containing the ordered vertexes
-
-      std::vector<vpImagePoint> poly_vert;
-      int index_first= 0;
-      unsigned int count = 0;
-
-      for( std::map<double,vpImagePoint>::iterator it = poly_verteces.begin();  it!=poly_verteces.end(); ++it )
-      {
-
-        poly_vert.push_back( it->second );
-        if (m_blob_list.front().getCog() == it->second )
-          index_first = count;
-        count++;
+  if (nb_lost == 0 || (recovery && recoverBlobs(I, lost, predicted))) {
+    try {
+      m_target_found = updateTarget(I);
+    }
+    catch(vpException &e) {
+      std::cout << "Exception tracking: " << e.getStringMessage() << std::endl;
+    }
+  }
 
-      }
+  if (!m_target_found) {
+    m_state = detection;
+    m_nbFullRecoveries++;
+  }
+  else if (nb_lost > 0)
+    m_nbLocalRecoveries++;
 
-      std::rotate(poly_vert.begin(), poly_vert.begin() + index_first, poly_vert.end());
-      //std::cout << "---------------------------------------" << std::endl;
-      for(unsigned int j = 0; j<poly_vert.size();j++)
-      {
-        std::ostringstream s;
-        s << j;
-        vpDisplay::displayText(I, poly_vert[j], s.str(), vpColor::green);
-        //std::cout << "Cog blob " << j << " :" << poly_vert[j] << std::endl;
-      }
-      computePose(m_P, poly_vert, m_cam, m_initPose, m_cMo);
+  return m_target_found;
+}
 
+/*!
+  Project the points of the target.
+  \param cMo : Pose of the target, the one of the previous frame or a predicted one.
+  \param predicted : Expected location of each tracked blob.
+  \return false if the blobs cannot be associated to the points of the target yet.
+  */
+bool vpBlobsTargetTracker::predictBlobs(const vpHomogeneousMatrix &cMo, vpImagePoint *predicted) const
+{
+  if (m_initPose || m_nbBlobs != m_numBlobs || m_P.size() != m_nbBlobs)
+    return false;
+
+  for (unsigned int i = 0; i < m_nbBlobs; i++) {
+    const vpPoint &P = m_P[m_blobPoint[i]];
+    double X[3];
+    for (unsigned int r = 0; r < 3; r++)
+      X[r] = cMo[r][0] * P.get_oX() + cMo[r][1] * P.get_oY() + cMo[r][2] * P.get_oZ() + cMo[r][3];
+    if (X[2] <= 0)
+      return false;
+    vpMeterPixelConversion::convertPoint(m_cam, X[0] / X[2], X[1] / X[2], predicted[i]);
+  }
+  return true;
+}
 
+/*!
+  Search the lost blobs in a window around their projection with the previous pose, that is
+  twice the size of the blob around it. The blob closest to the projection that is not already
+  tracked is kept.
+  \param I : Image where the blobs are searched.
+  \param lost : true for each blob to search.
+  \param predicted : Expected location of each blob, given by predictBlobs().
+  \return true if all the lost blobs are found.
+  */
+bool vpBlobsTargetTracker::recoverBlobs(const vpImage<unsigned char> &I, const bool *lost, const vpImagePoint *predicted)
+{
+  for (unsigned int i = 0; i < m_nbBlobs; i++) {
+    if (!lost[i])
+      continue;
 
+    try {
+      // The lost blob keeps the size and the gray levels used as reference by the search
+      vpDot2 &dot = m_blobs[i];
+      double size = std::max(dot.getWidth(), dot.getHeight());
+      double half_size = std::max(2.0 * size, 10.0);
+      int left = std::max(0, (int)(predicted[i].get_u() - half_size));
+      int top = std::max(0, (int)(predicted[i].get_v() - half_size));
+      int right = std::min((int)I.getWidth() - 1, (int)(predicted[i].get_u() + half_size));
+      int bottom = std::min((int)I.getHeight() - 1, (int)(predicted[i].get_v() + half_size));
+      if (right <= left || bottom <= top)
+        return false;
+
+      m_blob_list.clear();
+      if (m_batchedDotSearch)
+        m_dotExtractor.searchDotsInArea(I, dot, left, top, right - left + 1, bottom - top + 1, m_blob_list);
+      else
+        dot.searchDotsInArea(I, left, top, right - left + 1, bottom - top + 1, m_blob_list);
 
-      bool duplicate = false;
-      for(unsigned int i = 0; i < poly_vert.size()-1; i++)
+      std::list<vpDot2>::const_iterator best = m_blob_list.end();
+      double best_distance = 0;
+      for(std::list<vpDot2>::const_iterator it = m_blob_list.begin(); it != m_blob_list.end(); ++it)
       {
-        for(unsigned int j = i+1; j < poly_vert.size(); j++)
-        {
-          //std::cout << "Distance " << i <<"-" << j << " :" << vpImagePoint::sqrDistance(poly_vert[i],poly_vert[j] )<< std::endl;
-          if (vpImagePoint::sqrDistance(poly_vert[i],poly_vert[j]) < 5.0)
-            duplicate = true;
+        bool tracked = false;
+        for (unsigned int j = 0; j < m_nbBlobs; j++) {
+          if (j != i && !lost[j] && vpImagePoint::sqrDistance(it->getCog(), m_blobs[j].getCog()) < 5.0)
+            tracked = true;
+        }
+        double distance = vpImagePoint::sqrDistance(it->getCog(), predicted[i]);
+        if (!tracked && (best == m_blob_list.end() || distance < best_distance)) {
+          best = it;
+          best_distance = distance;
         }
       }
+      if (best == m_blob_list.end())
+        return false;
 
-      //std::cout << "---------------------------------------" << std::endl;
-
-      // std::cout << "Number blobs found is "<< poly_vert.size() << ". Expected number: " << m_numBlobs << std::endl;
-
-      //      int i = m_blob_list.front().getCog().get_i()-m_blob_list.front().getHeight()*2.3;
-      //      int j = m_blob_list.front().getCog().get_j()-m_blob_list.front().getWidth()*3.3;
-      //      unsigned int ai = m_blob_list.front().getHeight()*5;
-      //      unsigned int aj =m_blob_list.front().getWidth()*5;
-      //      vpDisplay::displayRectangle(I,i, j, ai,aj, vpColor::red,false,1);
-
+      dot = *best;
+      dot.initTracking(I, dot.getCog());
+    }
+    catch(vpException &e) {
+      std::cout << "Exception recovering blob " << i << ": " << e.getStringMessage() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
 
-      if (duplicate)
-      {
-        m_target_found = false;
-        m_state = detection;
-        std::cout << "PROBLEM: tracking failed " << m_numBlobs << std::endl;
+/*!
+  Compute the pose from the tracked blobs, each blob being associated to the point of the target
+  given by the matching of the detection (m_blobPoint), and check that the blobs are still
+  distinct. No memory is allocated.
+  \param I : Image where the blobs were tracked, used for the display.
+  \return true if the target is found.
+  */
+bool vpBlobsTargetTracker::updateTarget(const vpImage<unsigned char> &I)
+{
+  const unsigned int nb = m_nbBlobs;
+  if (nb == 0)
+    return false;
+
+  if (nb != m_numBlobs || m_P.size() != nb)
+  {
+    std::cout << "PROBLEM: Expected number: " << m_numBlobs << std::endl;
+    return false;
+  }
 
-      }
-      else if (poly_vert.size() != m_numBlobs)
+  m_cog.set_uv(0.0,0.0);
+  for(unsigned int i = 0; i < nb; i++)
+    m_cog += m_blobs[i].getCog();
+  m_cog /= nb;
+
+  // The vertices follow the order of the points of the target
+  for(unsigned int i = 0; i < nb; i++)
+    m_vertices[m_blobPoint[i]] = m_blobs[i].getCog();
+
+  // Sub-pixel centers
+  m_cogNoise = 0.5;
+  if (m_subPixel)
+  {
+    double variance = 0;
+    for(unsigned int i = 0; i < nb; i++)
+    {
+      if (!m_refiner.refine(I, m_blobs[i]))
       {
-        m_target_found = false;
-        m_state = detection;
-        std::cout << "PROBLEM: Expected number: " << m_numBlobs << std::endl;
+        variance = std::max(variance, 0.25);
+        continue;
       }
+      m_vertices[m_blobPoint[i]] = m_refiner.getCog();
+      vpMatrix covariance = m_refiner.getCovariance();
+      variance = std::max(variance, std::max(covariance[0][0], covariance[1][1]));
+    }
+    m_cogNoise = sqrt(variance);
+  }
 
-      else
-        m_target_found = true;
-
+  if (I.display != NULL)
+  {
+    for(unsigned int k = 0; k < nb; k++)
+    {
+      char label[8];
+      sprintf(label, "%u", k);
+      vpDisplay::displayText(I, m_vertices[k], label, vpColor::green);
     }
-    catch(vpException &e) {
-      std::cout << "Exception tracking: " << e.getStringMessage() << std::endl;
-      m_state = detection;
-      m_target_found = false;
+  }
+
+  computePose(m_P, m_vertices, m_cam, m_initPose, m_cMo);
+
+  bool duplicate = false;
+  for(unsigned int i = 0; i + 1 < nb; i++)
+  {
+    for(unsigned int j = i+1; j < nb; j++)
+    {
+      if (vpImagePoint::sqrDistance(m_vertices[i], m_vertices[j]) < 5.0)
+        duplicate = true;
     }
   }
-  return m_target_found;
+
+  if (duplicate)
+  {
+    std::cout << "PROBLEM: tracking failed " << m_numBlobs << std::endl;
+    return false;
+  }
+
+  return true;
 }
 
 //std::vector<vpImagePoint> vpBlobsTargetTracker::getTemplateTrackerCorners(const vpTemplateTrackerZone &zone)
@@ -345,19 +733,23 @@ bool vpBlobsTargetTracker::track(const cv::Mat &cvI, const vpImage<unsigned char
 //  return corners_ordered;
 //}
 
-void vpBlobsTargetTracker::computePose(std::vector<vpPoint> &point, const std::vector<vpImagePoint> &corners,
+void vpBlobsTargetTracker::computePose(std::vector<vpPoint> &point, const vpImagePoint *corners,
                                        const vpCameraParameters &cam, bool &init, vpHomogeneousMatrix &cMo)
 {
-  vpPose pose;
   double x=0, y=0;
   for (unsigned int i=0; i < point.size(); i ++) {
     vpPixelMeterConversion::convertPoint(cam, corners[i], x, y);
     point[i].set_x(x);
     point[i].set_y(y);
-    pose.addPoint(point[i]);
   }
 
-  if (init) {
+  m_poseSolver.setPoints(point);
+
+  // Closed-form initial pose of the planar target when it is found, vpPose for the other models
+  if (init && !m_poseSolver.initPose(cMo)) {
+    vpPose pose;
+    for (unsigned int i=0; i < point.size(); i ++)
+      pose.addPoint(point[i]);
     vpHomogeneousMatrix cMo_dementhon, cMo_lagrange;
     pose.computePose(vpPose::DEMENTHON_VIRTUAL_VS, cMo_dementhon);
     double residual_dementhon = pose.computeResidual(cMo_dementhon);
@@ -369,6 +761,12 @@ void vpBlobsTargetTracker::computePose(std::vector<vpPoint> &point, const std::v
       cMo = cMo_lagrange;
   }
 
-  pose.computePose(vpPose::VIRTUAL_VS, cMo) ;
+  // Same minimisation as vpPose::VIRTUAL_VS, from the previous pose and without allocation
+  m_poseSolver.computePose(cMo);
+
+  // Time of the frame, the pose being computed after its processing
+  if (m_filterPose)
+    m_poseFilter.update(cMo, m_poseSolver.getCovariance(m_cogNoise / cam.get_px()), m_frameTime >= 0 ? m_frameTime : vpTime::measureTimeMs());
+  m_frameTime = -1;
   init = false;
 }
@@ -7,10 +7,22 @@
 #include <visp/vpPixelMeterConversion.h>
 
 
+#include <vpBlobConstellation.h>
+#include <vpBlobRefiner.h>
 #include <vpColorDetection.h>
+#include <vpDotExtractor.h>
+#include <vpMotionPredictor.h>
+#include <vpPointPoseSolver.h>
+#include <vpPoseFilter.h>
+
 class vpBlobsTargetTracker
 {
+  friend class vpMultiBlobsTargetTracker;
+
 public:
+  static const unsigned int maxBlobs = 8; //!< Maximum number of blobs of a target
+  static const unsigned int maxTrackers = 4; //!< Maximum number of targets tracked together by trackTargets() or vpMultiBlobsTargetTracker
+
   typedef enum {
     detection,
     init_tracking,
@@ -33,14 +45,33 @@ protected:
   bool m_force_detection;
   std::string m_name;
   std::list<vpDot2> m_blob_list; // blob_list contains the list of the blobs that are detected in the image
+  vpDot2 m_blobs[maxBlobs]; // Tracked blobs, the colored one first
+  unsigned int m_nbBlobs; // Number of tracked blobs in m_blobs
+  vpImagePoint m_vertices[maxBlobs]; // Centers of the blobs in the order of the points of the target
+  vpPointPoseSolver m_poseSolver; // Pose refined at each frame from the previous one
   vpImagePoint m_cog;
   bool m_initPose;
   unsigned int m_numBlobs;
   bool m_manual_blob_init;
-  bool m_left_hand_target;
   unsigned int m_grayLevelMaxBlob;
   unsigned int m_grayLevelMinBlob;
   bool m_full_manual;
+  vpAdaptiveColorModel m_colorModel; // Color of the target learned from the tracked colored blob
+  bool m_adaptiveColor;
+  bool m_parallelTracking; // Track the blobs in parallel
+  bool m_localRecovery; // Search the lost blobs around their projection before detecting the target again
+  unsigned int m_blobPoint[maxBlobs]; // Index in m_P of each tracked blob, given by the matching of the detection
+  unsigned long m_nbLocalRecoveries;
+  unsigned long m_nbFullRecoveries;
+  vpBlobConstellation m_constellation; // Matching of the detected blobs with the points of the target
+  vpPoseFilter m_poseFilter; // Filtered pose, updated when m_filterPose is set
+  bool m_filterPose;
+  double m_frameTime; // Time given to setFrameTime(), negative when none
+  vpDotExtractor m_dotExtractor; // Search of the blobs in an area in a single scan
+  bool m_batchedDotSearch; // Search the blobs with m_dotExtractor rather than vpDot2::searchDotsInArea()
+  vpBlobRefiner m_refiner; // Sub-pixel centers of the blobs, used when m_subPixel is set
+  bool m_subPixel;
+  double m_cogNoise; // Standard deviation of the centers of the blobs, in pixels
 
 public:
 
@@ -53,13 +84,45 @@ public:
 
   vpHomogeneousMatrix get_cMo() const {return m_cMo;}
 
+  vpPoseFilter &getPoseFilter() { return m_poseFilter; }
+
+  /*!
+    Filter the pose with getPoseFilter() at each frame where the target is tracked, with the
+    covariance given by the pose solver. Disabled by default.
+    */
+  void setPoseFiltering(const bool &enable)
+  {
+    m_filterPose = enable;
+    if (!enable)
+      m_poseFilter.reset();
+  }
+
+  /*!
+    Capture time of the frame given to the next track(), in ms like vpTime::measureTimeMs(), used
+    to update getPoseFilter(). It is used for the next pose only. Without it, the filter is
+    updated with the time of the pose computation, which adds the latency of the processing.
+    */
+  void setFrameTime(const double &time) { m_frameTime = time; }
+
   /*!
     Return the center of gravity location of the tracked bar code.
     */
   vpImagePoint getCog();
 
+  const vpAdaptiveColorModel &getColorModel() const {return m_colorModel;}
   unsigned int getGrayLevelMinBlob() const {return m_grayLevelMinBlob;}
   unsigned int getGrayLevelMaxBlob() const {return m_grayLevelMaxBlob;}
+  bool getParallelTracking() const {return m_parallelTracking;}
+
+  /*!
+    Return the number of frames where lost blobs were found again around their projection.
+    */
+  unsigned long getNbLocalRecoveries() const {return m_nbLocalRecoveries;}
+
+  /*!
+    Return the number of times the tracked target was lost and had to be detected again.
+    */
+  unsigned long getNbFullRecoveries() const {return m_nbFullRecoveries;}
 
   void setCameraParameters(const vpCameraParameters &cam) { m_cam = cam; }
 
@@ -81,6 +144,8 @@ public:
 
 
   void setNumBlobs(const unsigned int &num) {
+    if (num > maxBlobs)
+      throw vpException(vpException::dimensionError, "Cannot track %d blobs: at most %d blobs are supported", (int)num, (int)maxBlobs);
     m_numBlobs = num;
   }
 
@@ -89,36 +154,123 @@ public:
     m_colBlob.setName(name);
   }
 
-  void setLeftHandTarget(const bool &left_target) {
-    m_left_hand_target = left_target;
-  }
 
+  bool loadHSV(const std::string name_file);
+
+  bool loadColorModel(const std::string &filename)
+  {
+    return m_colorModel.load(filename);
+  }
 
-  bool loadHSV(const std::string name_file)
+  bool saveColorModel(const std::string &filename) const
   {
-    return  m_colBlob.loadHSV(name_file);
+    return m_colorModel.save(filename);
   }
 
+  void setAdaptiveColor(const bool &enable);
+
   void setMaxAndMinObjectAreaColor(const double &area_min, const double &area_max)
   {
     m_colBlob.setMaxAndMinObjectArea(area_min, area_max);
   }
 
+  void setPyramidLevelColor(const unsigned int &level)
+  {
+    m_colBlob.setPyramidLevel(level);
+  }
+
+  /*!
+    Track the blobs in parallel with cv::parallel_for_() in the tracking state.
+    The blobs are then displayed once they are all tracked.
+    */
+  void setParallelTracking(const bool &enable)
+  {
+    m_parallelTracking = enable;
+  }
+
+  /*!
+    When a blob is lost, or two blobs collapse on the same point, search the blob around its
+    projection with the previous pose before detecting the whole target again. Enabled by default.
+    */
+  void setLocalRecovery(const bool &enable)
+  {
+    m_localRecovery = enable;
+  }
+
+  /*!
+    Search the blobs around the colored one, and the lost blobs, by thresholding and labeling the
+    area once with vpDotExtractor rather than with vpDot2::searchDotsInArea(). Enabled by default.
+    */
+  void setBatchedDotSearch(const bool &enable)
+  {
+    m_batchedDotSearch = enable;
+  }
+
+  /*!
+    Compute the centers of the blobs used for the pose with vpBlobRefiner, from the gray levels
+    of their pixels rather than from the pixels inside the gray level range of vpDot2. The
+    uncertainty of the pose given to the filter then comes from the covariance of the centers.
+    Disabled by default.
+    */
+  void setSubPixelRefinement(const bool &enable)
+  {
+    m_subPixel = enable;
+  }
+
+  vpBlobRefiner &getBlobRefiner() { return m_refiner; }
+
   void setGrayLevelMinBlob(const unsigned int & valueMin)  { m_grayLevelMinBlob = valueMin; }
   void setGrayLevelMaxBlob(const unsigned int & valueMax)  { m_grayLevelMaxBlob = valueMax; }
 
 
+  /*!
+    Diameter of the blobs in meter, used to get the scale of the target from the apparent size
+    of the colored blob. By default 0.4 times the smallest distance between two points, to set
+    after setPoints().
+    */
+  void setBlobDiameter(const double &diameter)
+  {
+    m_constellation.setBlobDiameter(diameter);
+  }
+
+  /*!
+    Points of the target, the colored blob being the first one.
+    */
   void setPoints(const std::vector<vpPoint> &points)
   {
+    if (points.size() > maxBlobs)
+      throw vpException(vpException::dimensionError, "Cannot track %d blobs: at most %d blobs are supported", (int)points.size(), (int)maxBlobs);
     m_P = points;
+    m_constellation.setModel(points, 0);
   }
 
+  void predictMotion(const vpMotionPredictor &predictor);
+
   bool track(const cv::Mat &cvI, const vpImage<unsigned char> &I );
+  bool trackYUV422(const unsigned char *yuyv, vpImage<unsigned char> &I);
+
+  static void trackTargets(const std::vector<vpBlobsTargetTracker*> &trackers, const std::vector<cv::Mat> &cvI,
+                           const std::vector<vpImage<unsigned char> > &I, std::vector<bool> &status);
+  static void trackTargets(const std::vector<vpBlobsTargetTracker*> &trackers, const cv::Mat &cvI,
+                           const vpImage<unsigned char> &I, std::vector<bool> &status);
+
+protected:
+  bool trackBlobs(const vpImage<unsigned char> &I, bool obj_found);
+  bool endTracking(const vpImage<unsigned char> &I, const bool *blob_tracked);
+  bool predictBlobs(const vpHomogeneousMatrix &cMo, vpImagePoint *predicted) const;
+  bool recoverBlobs(const vpImage<unsigned char> &I, const bool *lost, const vpImagePoint *predicted);
+  bool updateTarget(const vpImage<unsigned char> &I);
+  void updateColorModel(const cv::Mat &cvI);
+
+  static void trackBlobsInParallel(vpBlobsTargetTracker * const *trackers, const vpImage<unsigned char> * const *I,
+                                   unsigned int nb);
+  static void trackTargets(vpBlobsTargetTracker * const *trackers, const cv::Mat * const *cvI,
+                           const vpImage<unsigned char> * const *I, unsigned int nb, std::vector<bool> &status);
 
 private:
 
 
-  void computePose(std::vector<vpPoint> &point, const std::vector<vpImagePoint> &corners,
+  void computePose(std::vector<vpPoint> &point, const vpImagePoint *corners,
                    const vpCameraParameters &cam, bool &init, vpHomogeneousMatrix &cMo);
 };
 
@@ -37,8 +37,95 @@
  *****************************************************************************/
 
 #include <vpColorDetection.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 
+#include <visp/vpException.h>
+
+namespace {
+
+/*
+  Return a header on the top left corner of a work buffer, growing the buffer when needed,
+  so that the same memory is used for all the frames of a given resolution and for the
+  search windows inside them.
+ */
+cv::Mat getWorkBuffer(cv::Mat &buffer, const cv::Size &size)
+{
+    if (buffer.rows < size.height || buffer.cols < size.width)
+        buffer.create(size, CV_8UC1);
+    return buffer(cv::Rect(0, 0, size.width, size.height));
+}
+
+struct vpMinOp { static unsigned char apply(unsigned char a, unsigned char b) { return std::min(a, b); } };
+struct vpMaxOp { static unsigned char apply(unsigned char a, unsigned char b) { return std::max(a, b); } };
+struct vpAndOp { static unsigned char apply(unsigned char a, unsigned char b) { return a & b; } };
+struct vpOrOp { static unsigned char apply(unsigned char a, unsigned char b) { return a | b; } };
+
+/*
+  Rectangular erosion (vpMinOp) or dilation (vpMaxOp) in two separable passes, with the anchor
+  and the border handling of cv::erode() and cv::dilate(): the pixels outside the image are ignored.
+ */
+template <class Op>
+void filterRect(cv::Mat &T, cv::Mat &buffer, const cv::Size &ksize)
+{
+    const int ax = ksize.width / 2, ay = ksize.height / 2;
+
+    for (int i = 0; i < T.rows; i++)
+    {
+        const unsigned char *src = T.ptr<unsigned char>(i);
+        unsigned char *dst = buffer.ptr<unsigned char>(i);
+        for (int j = 0; j < T.cols; j++)
+        {
+            int first = std::max(j - ax, 0);
+            int last = std::min(j - ax + ksize.width - 1, T.cols - 1);
+            unsigned char value = src[first];
+            for (int k = first + 1; k <= last; k++)
+                value = Op::apply(value, src[k]);
+            dst[j] = value;
+        }
+    }
+
+    for (int i = 0; i < T.rows; i++)
+    {
+        int first = std::max(i - ay, 0);
+        int last = std::min(i - ay + ksize.height - 1, T.rows - 1);
+        unsigned char *dst = T.ptr<unsigned char>(i);
+        memcpy(dst, buffer.ptr<unsigned char>(first), T.cols);
+        for (int k = first + 1; k <= last; k++)
+        {
+            const unsigned char *src = buffer.ptr<unsigned char>(k);
+            for (int j = 0; j < T.cols; j++)
+                dst[j] = Op::apply(dst[j], src[j]);
+        }
+    }
+}
+
+}
+
+
+/*
+  Process the bands of vpColorDetection::detect(const cv::Mat &, const cv::Rect &) in parallel.
+ */
+class vpColorDetectionBands : public cv::ParallelLoopBody
+{
+public:
+    vpColorDetectionBands(vpColorDetection &detector, const cv::Mat &I, const cv::Rect &roi, unsigned int nb_bands)
+        : m_detector(detector), m_I(I), m_roi(roi), m_nb_bands(nb_bands) {}
+
+    void operator()(const cv::Range &range) const
+    {
+        for (int band = range.start; band < range.end; band++)
+            m_detector.segmentBand(band, m_nb_bands, m_I, m_roi);
+    }
+
+private:
+    vpColorDetection &m_detector;
+    const cv::Mat &m_I;
+    cv::Rect m_roi;
+    unsigned int m_nb_bands;
+};
 
 /*!
   Default constructor.
@@ -46,7 +133,15 @@
 vpColorDetection::vpColorDetection() :
     m_init_learning(0), m_learning_phase(0) ,m_min_obj_area(400), m_max_obj_area(100000),
     m_max_objs_num(10), m_name("object"), m_objects(), m_trackbarWindowName("Trackbars"),
-    m_T(), m_levelMorphOps(true),m_geometricShape(), m_shapeRecognition(false)
+    m_T(), m_levelMorphOps(true),m_geometricShape(), m_shapeRecognition(false),
+    m_fusedThreshold(true), m_yuvClassifier(), m_searchWindow(false), m_maxMisses(5), m_nbMisses(0),
+    m_searchMargin(0.5), m_searchBBox(), m_searchVelocity(), m_searchRoi(),
+    m_morphEngine(MORPH_SEPARABLE), m_pyramidLevel(0), m_colorModel(NULL), m_threshold(), m_morphBuffer(), m_contourBuffer(),
+    m_erodeElement(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3,3))),
+    //dilate with larger element so make sure object is nicely visible
+    m_dilateElement(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(8,8))), m_binaryMorphology(),
+    m_components(), m_contours(), m_hierarchy(), m_approx(), m_coarseThreshold(), m_coarseComponents(),
+    m_pyramidRois(), m_nbThreads(1), m_bands(), m_bandComponents()
 
 {
     m_H_min = 0;
@@ -129,20 +224,45 @@ void vpColorDetection::createTrackbars(){
 }
 
 /*!
-  Create structuring element that will be used to "dilate" and "erode" image.
+  "Erode" then "dilate" the treshold image with the structuring elements created in the constructor.
   \param T : Image openCV to process.
 */
 void vpColorDetection::morphOps(cv::Mat &T){
 
-    cv::Mat erodeElement = getStructuringElement( cv::MORPH_RECT,cv::Size(3,3)); //3
-    //dilate with larger element so make sure object is nicely visible
-    cv::Mat dilateElement = getStructuringElement( cv::MORPH_RECT,cv::Size(8,8)); //8
+    morphOps(T, m_morphBuffer, m_binaryMorphology);
+}
+
+/*!
+  Same as morphOps(cv::Mat &) with the given work buffers, so that several bands can be processed in parallel.
+*/
+void vpColorDetection::morphOps(cv::Mat &T, cv::Mat &morphBuffer, vpBinaryMorphology &morphology) const{
+
+    if (m_morphEngine == MORPH_BITPACKED)
+    {
+        // The erosions and the dilations are merged in one erosion and one dilation
+        const unsigned int iter = m_levelMorphOps ? 2 : 1;
+        morphology.erodeDilate(T, m_erodeElement.size(), iter, m_dilateElement.size(), iter);
+        return;
+    }
+
+    if (m_morphEngine == MORPH_SEPARABLE)
+    {
+        cv::Mat buffer = getWorkBuffer(morphBuffer, T.size());
+        if(m_levelMorphOps)
+            filterRect<vpMinOp>(T, buffer, m_erodeElement.size());
+        filterRect<vpMinOp>(T, buffer, m_erodeElement.size());
+        if(m_levelMorphOps)
+            filterRect<vpMaxOp>(T, buffer, m_dilateElement.size());
+        filterRect<vpMaxOp>(T, buffer, m_dilateElement.size());
+        return;
+    }
+
     if(m_levelMorphOps)
-        cv::erode(T,T,erodeElement);
-    cv::erode(T,T,erodeElement);
+        cv::erode(T,T,m_erodeElement);
+    cv::erode(T,T,m_erodeElement);
     if(m_levelMorphOps)
-        cv::dilate(T,T,dilateElement);
-    cv::dilate(T,T,dilateElement);
+        cv::dilate(T,T,m_dilateElement);
+    cv::dilate(T,T,m_dilateElement);
 
 }
 
@@ -156,6 +276,9 @@ void vpColorDetection::morphOps(cv::Mat &T){
    If a object is found the functions getBBox(), getCog() return some information about the location of the object.
 
    The largest object is always available using getBBox(0) or getCog(0).
+
+   When the search window is enabled with setSearchWindow(), only the area around the objects
+   found in the previous frames is processed.
  */
 
 bool vpColorDetection::detect(const cv::Mat &I)
@@ -163,187 +286,690 @@ bool vpColorDetection::detect(const cv::Mat &I)
 {
     bool detected = false;
 
+    if (!m_learning_phase)
+    {
+        cv::Rect roi(0, 0, I.cols, I.rows);
+        bool windowed = m_searchWindow && m_searchBBox.area() > 0;
+        if (windowed)
+            roi = predictSearchWindow(I.size());
+        detected = detect(I, roi);
+        if (m_searchWindow)
+            updateSearchWindow(detected, windowed);
+        return detected;
+    }
+
+    // Learning phase: reference path to display the HSV image
     cv::Mat HSV;
     cv::Mat T; //Treshold
     cv::cvtColor(I,HSV,cv::COLOR_BGR2HSV);
     cv::inRange(HSV,cv::Scalar(m_H_min,m_S_min,m_V_min),cv::Scalar(m_H_max,m_S_max,m_V_max),T);
-    if (m_learning_phase)
-        cv::imshow("Range",T);
+    cv::imshow("Range",T);
     morphOps(T);
+    m_searchRoi = cv::Rect(0, 0, I.cols, I.rows);
     detected = trackFilteredObject(T);
-    if (m_learning_phase)
-    {
-        //cv::imshow("Original",I);
-        cv::imshow("HSV Image",HSV);
-        cv::imshow("Treshold",T);
-    }
+    //cv::imshow("Original",I);
+    cv::imshow("HSV Image",HSV);
+    cv::imshow("Treshold",T);
     return detected;
 }
 
-
 /*!
-   Find contours, the centroid and the boundary box of the objects
-   \param T : Treshold image to process.
+   Same as detect(const cv::Mat &) but only the area \e roi of the image is processed.
+   The bounding boxes and the centers of gravity of the objects are given in the full image.
+
+   Objects touching the border of \e roi may be slightly different from the ones found in
+   the full image, since the morphological operations are done inside \e roi.
+
+   When setNbThreads() is greater than 1, \e roi is split in horizontal bands that are
+   processed in parallel with cv::parallel_for_(), and the components crossing the bands
+   are merged. The objects are the same as with a single thread.
+
+   When setPyramidLevel() is greater than 0, the objects are searched in a decimated image
+   then refined at full resolution, see detectCoarseToFine().
+
+   \param I : Input image to process.
+   \param roi : Area of the image to process. It is clipped to the image.
    \return true if one or more object are found, false otherwise.
  */
+bool vpColorDetection::detect(const cv::Mat &I, const cv::Rect &roi)
+{
+    m_searchRoi = roi & cv::Rect(0, 0, I.cols, I.rows);
+    if (m_searchRoi.area() == 0)
+    {
+        m_nb_objects = 0;
+        m_message.clear();
+        m_polygon.clear();
+        m_objects.clear();
+        return false;
+    }
+
+    if (m_pyramidLevel > 0)
+        return detectCoarseToFine(I, m_searchRoi);
+
+    // Bands of at least 32 rows, to keep the halo small compared to the band
+    const unsigned int nb_bands = std::max(1u, std::min(m_nbThreads, (unsigned int)m_searchRoi.height / 32));
+    if (nb_bands > 1)
+    {
+        m_bands.resize(nb_bands);
+        m_bandComponents.resize(nb_bands);
+        cv::parallel_for_(cv::Range(0, nb_bands), vpColorDetectionBands(*this, I, m_searchRoi, nb_bands), nb_bands);
+        m_components.join(m_bandComponents);
+        return findObjects(m_components);
+    }
 
-bool vpColorDetection::trackFilteredObject(cv::Mat threshold)
+    cv::Mat T = getWorkBuffer(m_threshold, m_searchRoi.size()); //Treshold
+    thresholdHSV(I(m_searchRoi), T);
+    morphOps(T);
+    return trackFilteredObject(T, m_searchRoi.tl());
+}
+
+/*!
+   Coarse-to-fine detection in \e roi.
+
+   The image is first sampled every 2^level pixels, where level is given by setPyramidLevel().
+   The samples are tresholded, filtered with structuring elements reduced by the same factor and
+   labeled. The area limits of setMaxAndMinObjectArea() are scaled to the decimated image, with
+   a margin since the area of a sampled component is only an estimate.
+
+   Each candidate is then processed again at full resolution in its bounding box, expanded by the
+   sampling step and by the extent of the morphological operations. Overlapping boxes are merged.
+   The objects, their areas and their bounding boxes come from this full resolution pass, so
+   they are the same as with detect(const cv::Mat &, const cv::Rect &) at full resolution, as
+   long as the object is large enough to be seen in the decimated image. The candidates are only
+   filtered by their area, never counted, since the reduced erosion keeps the isolated noisy
+   pixels. As in detect(), no object is found when the full resolution pass gives m_max_objs_num
+   components or more.
+
+   \param I : Input image to process.
+   \param roi : Area of the image to process, inside the image.
+   \return true if one or more object are found, false otherwise.
+ */
+bool vpColorDetection::detectCoarseToFine(const cv::Mat &I, const cv::Rect &roi)
 {
+    const int step = 1 << m_pyramidLevel;
+
     m_nb_objects = 0;
-    m_polygon.clear();
     m_objects.clear();
 
-    //cv::Mat drawing = cv::Mat::zeros( I.size(), CV_8UC3 );
-    //cv::RNG rng(12345);
-
-    int x = 0;
-    int y = 0;
-    cv::Mat temp;
-    threshold.copyTo(temp);
-    //these two vectors needed for output of findContours
-    std::vector< std::vector<cv::Point> > contours;
-    std::vector<cv::Vec4i> hierarchy;
-    //find contours of filtered image using openCV findContours function
-    cv::findContours(temp, contours, hierarchy, CV_RETR_CCOMP, CV_CHAIN_APPROX_SIMPLE );
-    //use moments method to find our filtered object
-    bool objectFound = false;
-    if (hierarchy.size() > 0)
+    // Treshold one pixel out of step in each direction
+    const int hsv_min[3] = {m_H_min, m_S_min, m_V_min};
+    const int hsv_max[3] = {m_H_max, m_S_max, m_V_max};
+    cv::Mat coarse = getWorkBuffer(m_coarseThreshold, cv::Size((roi.width + step - 1) / step, (roi.height + step - 1) / step));
+    for (int i = 0; i < coarse.rows; i++)
     {
-        int numObjects = hierarchy.size();
-        //if number of objects greater than m_max_objs_num we have a noisy filter
-        if(numObjects < m_max_objs_num)
+        const unsigned char *src = I.ptr<unsigned char>(roi.y + i * step) + 3 * roi.x;
+        unsigned char *dst = coarse.ptr<unsigned char>(i);
+        for (int j = 0; j < coarse.cols; j++, src += 3 * step)
         {
-            //std::vector<std::pair<cv::Rect, GeometricShape>> objects;
+            const bool inside = m_colorModel ? m_colorModel->isForeground(src) : vpColorThreshold::isInRangeHSV(src, hsv_min, hsv_max);
+            dst[j] = inside ? 255 : 0;
+        }
+    }
+
+    // Same morphological operations, with the structuring elements reduced to the decimated image
+    const cv::Size erode_size(std::max(1, m_erodeElement.cols / step), std::max(1, m_erodeElement.rows / step));
+    const cv::Size dilate_size(std::max(1, m_dilateElement.cols / step), std::max(1, m_dilateElement.rows / step));
+    cv::Mat buffer = getWorkBuffer(m_morphBuffer, coarse.size());
+    const int iter = m_levelMorphOps ? 2 : 1;
+    for (int n = 0; n < iter; n++)
+        filterRect<vpMinOp>(coarse, buffer, erode_size);
+    for (int n = 0; n < iter; n++)
+        filterRect<vpMaxOp>(coarse, buffer, dilate_size);
+
+    m_coarseComponents.label(coarse);
+    const unsigned int numCandidates = m_coarseComponents.getNbComponents();
+    // The reduced erosion does not remove the isolated pixels, so the candidates are not counted:
+    // only the full resolution components are compared to m_max_objs_num, as in detect()
+    if (numCandidates == 0)
+        return publishObjects();
+
+    // Area limits in the decimated image, with a factor 2 of margin
+    const double min_area = 0.5 * m_min_obj_area / (step * step);
+    const double max_area = 2. * m_max_obj_area / (step * step);
+
+    // Pixels that can change the full resolution result around a candidate
+    const int pad = step + iter * (std::max(m_erodeElement.cols, m_erodeElement.rows)
+                                   + std::max(m_dilateElement.cols, m_dilateElement.rows));
+
+    m_pyramidRois.clear();
+    for (unsigned int index = 0; index < numCandidates; index++)
+    {
+        const vpConnectedComponents::vpComponent &candidate = m_coarseComponents.getComponent(index);
+        if (candidate.m00 < min_area || candidate.m00 > max_area)
+            continue;
 
-            for (int index = 0; index >= 0; index = hierarchy[index][0])
+        cv::Rect box(cv::Point(roi.x + candidate.x_min * step - pad, roi.y + candidate.y_min * step - pad),
+                     cv::Point(roi.x + (candidate.x_max + 1) * step + pad, roi.y + (candidate.y_max + 1) * step + pad));
+        m_pyramidRois.push_back(box & roi);
+    }
+
+    // Merge the overlapping or adjacent areas, so that an object is only found once
+    for (size_t i = 0; i < m_pyramidRois.size(); )
+    {
+        const cv::Rect &area = m_pyramidRois[i];
+        const cv::Rect neighborhood(area.x - 1, area.y - 1, area.width + 2, area.height + 2);
+        bool merged = false;
+        for (size_t j = i + 1; j < m_pyramidRois.size() && !merged; j++)
+        {
+            if ((neighborhood & m_pyramidRois[j]).area() > 0)
             {
-                cv::Moments moment = cv::moments((cv::Mat)contours[index]);
-                double area = moment.m00;
-
-                //if the area is less than m_min_obj_area then it is probably just noise
-                //if the area bigger than m_max_obj_area, probably just a bad filter
-                //we only want the object with the largest area so we safe a reference area each
-                //iteration and compare it to the area in the next iteration.
-                if(area >= m_min_obj_area && area <= m_max_obj_area)
-                {
-                    found_objects object;
-                    x = moment.m10/area;
-                    y = moment.m01/area;
-                    //drawObject(x,y,I);
-                    m_nb_objects++;
-
-                    if (m_learning_phase)
-                        std::cout << "Area obj n " << index << "= " << area << std::endl;
-
-                    //cv::Scalar color = cv::Scalar( rng.uniform(0, 255), rng.uniform(0,255), rng.uniform(0,255) );
-                    //cv::drawContours( I, contours, index, color, 2, 8, hierarchy, 0, cv::Point() );
-                    // cv::Rect rect = cv::boundingRect(contours[index]);
-                    //cv::rectangle(I, cv::Point(rect.x, rect.y),cv::Point(rect.x+rect.width, rect.y+rect.height),cv::Scalar(0, 0, 255, 0),2, 8, 0);
-                    //--m_objects.push_back(rect);
-                    object.rect =  cv::boundingRect(contours[index]);
-                    //object.type = found_objects::Unknown;
-
-                    if (m_shapeRecognition)
-                    {
-                        std::vector<cv::Point> approx;
-                        // Approximate contour with accuracy proportional to the contour perimeter
-                        cv::approxPolyDP(cv::Mat(contours[index]), approx, cv::arcLength(cv::Mat(contours[index]), true) * 0.02, true);
-
-                        if (!cv::isContourConvex(approx))
-                        {
-                            object.type = found_objects::Concave;
-                        }
-                        else if (approx.size() == 3 )
-                        {
-                            object.type = found_objects::Triangle;
-                        }
-                        else if (approx.size() >= 4 && approx.size() <= 6)
-                        {
-                            // Number of vertices of polygonal curve
-                            int vtc = approx.size();
-
-                            // Get the cosines of all corners
-                            std::vector<double> cos;
-                            for (int j = 2; j < vtc+1; j++)
-                                cos.push_back(angle(approx[j%vtc], approx[j-2], approx[j-1]));
-
-                            // Sort ascending the cosine values
-                            std::sort(cos.begin(), cos.end());
-
-                            // Get the lowest and the highest cosine
-                            double mincos = cos.front();
-                            double maxcos = cos.back();
-
-                            // Use the degrees obtained above and the number of vertices
-                            // to determine the shape of the contour
-                            if (vtc == 4 && mincos >= -0.1 && maxcos <= 0.3)
-                                object.type = found_objects::Rectangle;
-                            else if (vtc == 5 && mincos >= -0.34 && maxcos <= -0.27)
-                                object.type = found_objects::Penta;
-                            else if (vtc == 6 && mincos >= -0.55 && maxcos <= -0.45)
-                                object.type = found_objects::Exa;
-                        }
-                        else
-                        {
-                            // Detect and label circles
-                            double area = cv::contourArea(contours[index]);
-                            cv::Rect r = cv::boundingRect(contours[index]);
-                            int radius = r.width / 2;
-
-                            if (std::abs(1 - ((double)r.width / r.height)) <= 0.2 &&
-                                    std::abs(1 - (area / (CV_PI * std::pow(radius, 2)))) <= 0.2)
-                                object.type = found_objects::Circle;
-                        }
-                    } // End Shape recognition
-
-                    m_objects.push_back(object);
+                m_pyramidRois[i] |= m_pyramidRois[j];
+                m_pyramidRois.erase(m_pyramidRois.begin() + j);
+                merged = true;
+            }
+        }
+        // A merged area can overlap areas already checked
+        i = merged ? 0 : i + 1;
+    }
 
-                }
+    // Refine the candidates at full resolution
+    unsigned int numComponents = 0;
+    for (size_t i = 0; i < m_pyramidRois.size(); i++)
+    {
+        const cv::Rect &area = m_pyramidRois[i];
+        cv::Mat T = getWorkBuffer(m_threshold, area.size()); //Treshold
+        thresholdHSV(I(area), T);
+        morphOps(T);
+        m_components.label(T, area.tl());
+        numComponents += m_components.getNbComponents();
+        selectObjects(m_components);
+    }
+
+    //same limit as detect() on the full resolution components, the areas being disjoint
+    if (numComponents >= m_max_objs_num)
+    {
+        m_nb_objects = 0;
+        m_objects.clear();
+    }
+
+    return publishObjects();
+}
+
+/*!
+   Treshold an image with the HSV range, with the fused kernel or with cv::cvtColor() and cv::inRange(),
+   or with the color model given to setColorModel().
+ */
+void vpColorDetection::thresholdHSV(const cv::Mat &I, cv::Mat &T) const
+{
+    if (m_colorModel)
+    {
+        m_colorModel->threshold(I, T);
+        return;
+    }
+
+    const int hsv_min[3] = {m_H_min, m_S_min, m_V_min};
+    const int hsv_max[3] = {m_H_max, m_S_max, m_V_max};
+    if (m_fusedThreshold)
+        vpColorThreshold::thresholdHSV(I, T, hsv_min, hsv_max);
+    else
+        vpColorThreshold::thresholdHSVReference(I, T, hsv_min, hsv_max);
+}
+
+/*!
+   Treshold, filter and label one horizontal band of \e roi.
+
+   The band is extended by the rows needed by the morphological operations (halo), so that the
+   filtered band is the same as the corresponding rows of the whole filtered \e roi.
+
+   \param band : Index of the band.
+   \param nb_bands : Number of bands.
+   \param I : Input image.
+   \param roi : Area of the image to process.
+ */
+void vpColorDetection::segmentBand(unsigned int band, unsigned int nb_bands, const cv::Mat &I, const cv::Rect &roi)
+{
+    const int y0 = roi.y + (int)(roi.height * band / nb_bands);
+    const int y1 = roi.y + (int)(roi.height * (band + 1) / nb_bands);
+
+    // Rows read by the erosions then the dilations above and below the band
+    const int iter = m_levelMorphOps ? 2 : 1;
+    const int erode = m_erodeElement.rows, dilate = m_dilateElement.rows;
+    const int halo_top = iter * (erode / 2) + iter * (dilate / 2);
+    const int halo_bottom = iter * (erode - 1 - erode / 2) + iter * (dilate - 1 - dilate / 2);
+    const int ext0 = std::max(y0 - halo_top, roi.y);
+    const int ext1 = std::min(y1 + halo_bottom, roi.y + roi.height);
+    const cv::Rect extended(roi.x, ext0, roi.width, ext1 - ext0);
+
+    vpBand &data = m_bands[band];
+    cv::Mat T = getWorkBuffer(data.threshold, extended.size()); //Treshold
+    thresholdHSV(I(extended), T);
+    morphOps(T, data.morphBuffer, data.morphology);
+    m_bandComponents[band].label(T(cv::Rect(0, y0 - ext0, roi.width, y1 - y0)), cv::Point(roi.x, y0));
+}
+
+/*!
+   Enable or disable the search window. When enabled, detect(const cv::Mat &) only processes an area
+   around the objects found in the previous frame, expanded by their motion between the two last
+   detections. The full image is processed again after \e max_misses consecutive frames without
+   any object in the search window.
+
+   \param enable : true to enable the search window.
+   \param max_misses : Number of consecutive misses before going back to a full frame search.
+ */
+void vpColorDetection::setSearchWindow(const bool &enable, const unsigned int &max_misses)
+{
+    m_searchWindow = enable;
+    m_maxMisses = max_misses;
+    m_nbMisses = 0;
+    m_searchBBox = cv::Rect();
+    m_searchVelocity = cv::Point2d();
+}
+
+/*!
+   Compute the area where the objects are searched: the bounding box of the previous objects,
+   moved by their last displacement and expanded by the search margin and the displacement.
+ */
+cv::Rect vpColorDetection::predictSearchWindow(const cv::Size &size) const
+{
+    // Keep room for the 8x8 dilation around the objects
+    const double min_margin = 16.;
+    double cx = m_searchBBox.x + 0.5 * m_searchBBox.width + m_searchVelocity.x;
+    double cy = m_searchBBox.y + 0.5 * m_searchBBox.height + m_searchVelocity.y;
+    double half_w = 0.5 * m_searchBBox.width + std::max(m_searchMargin * m_searchBBox.width, min_margin) + std::fabs(m_searchVelocity.x);
+    double half_h = 0.5 * m_searchBBox.height + std::max(m_searchMargin * m_searchBBox.height, min_margin) + std::fabs(m_searchVelocity.y);
+
+    cv::Rect window(cv::Point((int)std::floor(cx - half_w), (int)std::floor(cy - half_h)),
+                    cv::Point((int)std::ceil(cx + half_w), (int)std::ceil(cy + half_h)));
+    return window & cv::Rect(0, 0, size.width, size.height);
+}
+
+/*!
+   Update the state of the search window after a detection.
+   \param detected : true if objects were found.
+   \param windowed : true if the detection was done in the search window, false if it was done in the full image.
+ */
+void vpColorDetection::updateSearchWindow(bool detected, bool windowed)
+{
+    if (detected)
+    {
+        cv::Rect bbox = m_objects[0].rect;
+        for (size_t i = 1; i < m_objects.size(); i++)
+            bbox |= m_objects[i].rect;
+
+        if (windowed)
+            m_searchVelocity = cv::Point2d(bbox.x + 0.5 * bbox.width - (m_searchBBox.x + 0.5 * m_searchBBox.width),
+                                           bbox.y + 0.5 * bbox.height - (m_searchBBox.y + 0.5 * m_searchBBox.height));
+        else
+            m_searchVelocity = cv::Point2d();
+        m_searchBBox = bbox;
+        m_nbMisses = 0;
+    }
+    else if (windowed)
+    {
+        m_nbMisses++;
+        if (m_nbMisses >= m_maxMisses)
+        {
+            // Back to a full frame search
+            m_searchBBox = cv::Rect();
+            m_searchVelocity = cv::Point2d();
+            m_nbMisses = 0;
+        }
+    }
+}
+
+
+/*!
+   Same as detect(const cv::Mat &) but on a YUV422 camera buffer (Y0 U Y1 V), without conversion to BGR.
+   The search window of setSearchWindow() and the color model of setColorModel() are used as in
+   detect(const cv::Mat &). The pyramid level and the number of threads are not used.
+
+   Each time the HSV range changes, its translation in the YUV space is built over the next
+   frames, see vpYUVColorClassifier::buildTable(), so that tuning the range with the trackbars
+   does not stall the loop.
+
+   \param yuyv : Buffer of width*height*2 bytes.
+   \param width, height : Size of the image. The width has to be even.
+   \return true if one or more object are found, false otherwise.
+ */
+bool vpColorDetection::detectYUV422(const unsigned char *yuyv, unsigned int width, unsigned int height)
+{
+    return detectYUV422(yuyv, width, height, NULL);
+}
+
+/*!
+   Same as detectYUV422(const unsigned char *, unsigned int, unsigned int) but the luma plane
+   is also copied in \e I during the thresholding pass, so that the same camera buffer feeds
+   the gray level processing (vpDot2, trackers) without any other conversion.
+
+   \param yuyv : Buffer of I.getWidth()*I.getHeight()*2 bytes.
+   \param I : Image with the size of the camera image, updated with the luma plane.
+   \return true if one or more object are found, false otherwise.
+ */
+bool vpColorDetection::detectYUV422(const unsigned char *yuyv, vpImage<unsigned char> &I)
+{
+    return detectYUV422(yuyv, I.getWidth(), I.getHeight(), I.bitmap);
+}
 
+/*!
+   Implementation of the detectYUV422() methods.
+   \param luma : If not NULL, a buffer of width*height bytes where the whole luma plane is copied.
+ */
+bool vpColorDetection::detectYUV422(const unsigned char *yuyv, unsigned int width, unsigned int height,
+                                    unsigned char *luma)
+{
+    // Number of U values of the YUV table built per frame, about 5 ms on a desktop CPU
+    const unsigned int table_rows_per_frame = 8;
+
+    const int hsv_min[3] = {m_H_min, m_S_min, m_V_min};
+    const int hsv_max[3] = {m_H_max, m_S_max, m_V_max};
+    if (!m_colorModel)
+    {
+        m_yuvClassifier.setValuesHSV(hsv_min, hsv_max);
+        m_yuvClassifier.buildTable(table_rows_per_frame);
+    }
+
+    const cv::Rect frame(0, 0, (int)width, (int)height);
+    bool windowed = m_searchWindow && m_searchBBox.area() > 0;
+    m_searchRoi = windowed ? predictSearchWindow(frame.size()) : frame;
+
+    // The thresholding pass only copies the luma of the processed area
+    if (luma && (m_colorModel || m_searchRoi != frame))
+    {
+        vpYUVColorClassifier::extractLuma(yuyv, (int)width, (int)height, luma);
+        luma = NULL;
+    }
+
+    bool detected = false;
+    if (m_searchRoi.area() == 0)
+    {
+        m_nb_objects = 0;
+        m_message.clear();
+        m_polygon.clear();
+        m_objects.clear();
+    }
+    else
+    {
+        cv::Mat T = getWorkBuffer(m_threshold, m_searchRoi.size()); //Treshold
+        if (m_colorModel)
+        {
+            for (int i = 0; i < m_searchRoi.height; i++)
+            {
+                const unsigned char *src = yuyv + 2 * (m_searchRoi.y + i) * (int)width;
+                unsigned char *dst = T.ptr<unsigned char>(i);
+                for (int j = 0; j < m_searchRoi.width; j++)
+                {
+                    const int x = m_searchRoi.x + j;
+                    const unsigned char *pair = src + 4 * (x / 2);
+                    unsigned char bgr[3];
+                    vpYUVColorClassifier::convertToBGR(src[2 * x], pair[1], pair[3], bgr);
+                    dst[j] = m_colorModel->isForeground(bgr) ? 255 : 0;
+                }
             }
+        }
+        else
+            m_yuvClassifier.threshold(yuyv, (int)width, (int)height, m_searchRoi, T, luma);
+        morphOps(T);
+        detected = trackFilteredObject(T, m_searchRoi.tl());
+    }
+
+    if (m_searchWindow)
+        updateSearchWindow(detected, windowed);
+    return detected;
+}
+
+/*!
+   Same as detect(const cv::Mat &) but the thresholding is taken from a label image computed
+   once for several detectors by vpMultiColorClassifier::classify().
+
+   \param labels : Label image of type CV_8UC1.
+   \param index : Index of the profile of this detector, returned by vpMultiColorClassifier::addProfile().
+   \return true if one or more object are found, false otherwise.
+ */
+bool vpColorDetection::detect(const cv::Mat &labels, unsigned int index)
+{
+    m_searchRoi = cv::Rect(0, 0, labels.cols, labels.rows);
+    cv::Mat T = getWorkBuffer(m_threshold, m_searchRoi.size()); //Treshold
+    vpMultiColorClassifier::extractMask(labels, index, T);
+    morphOps(T);
+    return trackFilteredObject(T);
+}
 
+/*!
+   Same as detect(const cv::Mat &, unsigned int) but the morphological operations and the labeling
+   are also done once for several detectors: the label image has been filtered with morphLabels()
+   then labeled with vpConnectedComponents::labelValues().
+
+   The components whose value is the bit of this detector are the objects. When the filtered
+   objects of two profiles touch, their pixels have both bits and this detector labels its own
+   mask again, so that the result is always the same as with detect(const cv::Mat &, unsigned int).
+
+   \param labels : Label image of vpMultiColorClassifier::classify(), filtered with morphLabels().
+   \param components : Components of \e labels given by vpConnectedComponents::labelValues().
+   \param index : Index of the profile of this detector.
+   \return true if one or more object are found, false otherwise.
+ */
+bool vpColorDetection::detect(const cv::Mat &labels, const vpConnectedComponents &components, unsigned int index)
+{
+    m_searchRoi = cv::Rect(0, 0, labels.cols, labels.rows);
+    const unsigned char bit = (unsigned char)(1 << index);
+    for (unsigned int c = 0; c < components.getNbComponents(); c++)
+    {
+        const unsigned char value = components.getComponent(c).value;
+        if ((value & bit) && value != bit)
+        {
+            cv::Mat T = getWorkBuffer(m_threshold, m_searchRoi.size()); //Treshold
+            vpMultiColorClassifier::extractMask(labels, index, T);
+            return trackFilteredObject(T);
         }
+    }
+    return findObjects(components, bit);
+}
 
+/*!
+   Apply the morphological operations of this detector to all the profiles of a label image of
+   vpMultiColorClassifier at once. The erosion and the dilation of each bit are the bitwise and
+   and or of the labels over the structuring element, so that each mask given by
+   vpMultiColorClassifier::extractMask() is the one morphOps() would give.
+   \param labels : Label image of type CV_8UC1, filtered in place.
+ */
+void vpColorDetection::morphLabels(cv::Mat &labels)
+{
+    cv::Mat buffer = getWorkBuffer(m_morphBuffer, labels.size());
+    if(m_levelMorphOps)
+        filterRect<vpAndOp>(labels, buffer, m_erodeElement.size());
+    filterRect<vpAndOp>(labels, buffer, m_erodeElement.size());
+    if(m_levelMorphOps)
+        filterRect<vpOrOp>(labels, buffer, m_dilateElement.size());
+    filterRect<vpOrOp>(labels, buffer, m_dilateElement.size());
+}
+
+/*!
+   Find the connected components, the centroid and the boundary box of the objects.
+   The area of an object is its number of pixels.
+   \param threshold : Treshold image to process.
+   \param offset : Position of the treshold image in the full image.
+   \return true if one or more object are found, false otherwise.
+ */
+
+bool vpColorDetection::trackFilteredObject(const cv::Mat &threshold, const cv::Point &offset)
+{
+    // Area, centroid and bounding box of the components in one scan of the treshold image
+    m_components.label(threshold, offset);
+    return findObjects(m_components);
+}
+
+/*!
+   Select the objects among the connected components of the treshold image, by area, and sort them.
+   \param components : Connected components of the treshold image.
+   \param value : If not negative, only the components with this value are considered.
+   \return true if one or more object are found, false otherwise.
+ */
+bool vpColorDetection::findObjects(const vpConnectedComponents &components, int value)
+{
+    m_nb_objects = 0;
+    m_objects.clear();
+
+    unsigned int numObjects = components.getNbComponents();
+    if (value >= 0)
+    {
+        numObjects = 0;
+        for (unsigned int index = 0; index < components.getNbComponents(); index++)
+            if (components.getComponent(index).value == value)
+                numObjects++;
     }
+    //if number of objects greater than m_max_objs_num we have a noisy filter
+    if (numObjects > 0 && numObjects < m_max_objs_num)
+        selectObjects(components, value);
+
+    return publishObjects();
+}
+
+/*!
+   Add to the objects the connected components whose area is in the limits.
+   \param components : Connected components of the treshold image.
+   \param value : If not negative, only the components with this value are considered.
+ */
+void vpColorDetection::selectObjects(const vpConnectedComponents &components, int value)
+{
+    for (unsigned int index = 0; index < components.getNbComponents(); index++)
+    {
+        const vpConnectedComponents::vpComponent &component = components.getComponent(index);
+        if (value >= 0 && component.value != value)
+            continue;
+        double area = component.m00;
+
+        //if the area is less than m_min_obj_area then it is probably just noise
+        //if the area bigger than m_max_obj_area, probably just a bad filter
+        if(area >= m_min_obj_area && area <= m_max_obj_area)
+        {
+            found_objects object;
+            m_nb_objects++;
+
+            if (m_learning_phase)
+                std::cout << "Area obj n " << index << "= " << area << std::endl;
+
+            object.rect = component.getBBox();
+            object.type = found_objects::Unknown;
+
+            // The contour is only needed by the shape recognition
+            if (m_shapeRecognition)
+                object.type = recognizeShape(components, index);
+
+            m_objects.push_back(object);
+        }
+    }
+}
+
+/*!
+   Sort the objects from the largest to the smallest and update the messages and the polygons of vpDetectorBase.
+   \return true if one or more object are found, false otherwise.
+ */
+bool vpColorDetection::publishObjects()
+{
+    bool objectFound = false;
+
+    // Outputs of vpDetectorBase, resized rather than cleared to keep their memory
+    m_message.resize(m_nb_objects);
+    m_polygon.resize(m_nb_objects);
 
     if (m_nb_objects > 0)
     {
         objectFound = true;
 
-        //std::vector<std::pair<cv::Rect, GeometricShape>> objects;
-
         std::sort(m_objects.begin(), m_objects.end(), vpSortLargestObject);
 
         for( size_t i = 0; i < m_objects.size(); i++ )
         {
-            std::cout << m_objects[i].type << std::endl;
-            std::ostringstream message;
-            message << m_name << " " << int(i);
+            char index[16];
+            sprintf(index, " %d", int(i));
+            std::string &message = m_message[i];
+            message = m_name;
+            message += index;
             if (m_shapeRecognition)
-                message <<"_" << getGeometricShapeString(m_objects[i].type);
-            m_message.push_back( message.str() );
+            {
+                message += "_";
+                message += getGeometricShapeString(m_objects[i].type);
+            }
 
-            std::vector<vpImagePoint> polygon;
+            std::vector<vpImagePoint> &polygon = m_polygon[i];
             double x = m_objects[i].rect.tl().x;
             double y = m_objects[i].rect.tl().y;
             double w = m_objects[i].rect.size().width;
             double h = m_objects[i].rect.size().height;
 
-            polygon.push_back(vpImagePoint(y  , x  ));
-            polygon.push_back(vpImagePoint(y+h, x  ));
-            polygon.push_back(vpImagePoint(y+h, x+w));
-            polygon.push_back(vpImagePoint(y  , x+w));
-
-            m_polygon.push_back(polygon);
+            polygon.resize(4);
+            polygon[0].set_ij(y  , x  );
+            polygon[1].set_ij(y+h, x  );
+            polygon[2].set_ij(y+h, x+w);
+            polygon[3].set_ij(y  , x+w);
         }
 
     }
 
-    //  cv::imshow("Cont",drawing);
     return objectFound;
 
 }
 
+/*!
+   Recognize the geometric shape of a connected component from its contour.
+   \param components : Connected components of the treshold image.
+   \param index : Index of the component in \e components.
+ */
+found_objects::GeometricShape vpColorDetection::recognizeShape(const vpConnectedComponents &components, unsigned int index)
+{
+    // Draw the component alone, with a background border, and find its contour
+    cv::Rect bbox = components.getComponent(index).getBBox();
+    cv::Point origin = bbox.tl() - cv::Point(1, 1);
+    cv::Mat temp = getWorkBuffer(m_contourBuffer, cv::Size(bbox.width + 2, bbox.height + 2));
+    for (int i = 0; i < temp.rows; i++)
+        memset(temp.ptr<unsigned char>(i), 0, temp.cols);
+    components.drawComponent(index, temp, origin);
+    cv::findContours(temp, m_contours, m_hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE, origin);
+    if (m_contours.empty())
+        return found_objects::Unknown;
+    const std::vector<cv::Point> &contour = m_contours[0];
+
+    // Approximate contour with accuracy proportional to the contour perimeter
+    cv::approxPolyDP(cv::Mat(contour), m_approx, cv::arcLength(cv::Mat(contour), true) * 0.02, true);
+
+    if (!cv::isContourConvex(m_approx))
+    {
+        return found_objects::Concave;
+    }
+    else if (m_approx.size() == 3 )
+    {
+        return found_objects::Triangle;
+    }
+    else if (m_approx.size() >= 4 && m_approx.size() <= 6)
+    {
+        // Number of vertices of polygonal curve
+        int vtc = m_approx.size();
+
+        // Get the cosines of all corners
+        double cos[6];
+        for (int j = 2; j < vtc+1; j++)
+            cos[j-2] = angle(m_approx[j%vtc], m_approx[j-2], m_approx[j-1]);
+
+        // Sort ascending the cosine values
+        std::sort(cos, cos + vtc - 1);
+
+        // Get the lowest and the highest cosine
+        double mincos = cos[0];
+        double maxcos = cos[vtc-2];
+
+        // Use the degrees obtained above and the number of vertices
+        // to determine the shape of the contour
+        if (vtc == 4 && mincos >= -0.1 && maxcos <= 0.3)
+            return found_objects::Rectangle;
+        else if (vtc == 5 && mincos >= -0.34 && maxcos <= -0.27)
+            return found_objects::Penta;
+        else if (vtc == 6 && mincos >= -0.55 && maxcos <= -0.45)
+            return found_objects::Exa;
+    }
+    else
+    {
+        // Detect and label circles
+        double area = cv::contourArea(contour);
+        int radius = bbox.width / 2;
+
+        if (std::abs(1 - ((double)bbox.width / bbox.height)) <= 0.2 &&
+                std::abs(1 - (area / (CV_PI * std::pow(radius, 2)))) <= 0.2)
+            return found_objects::Circle;
+    }
+
+    return found_objects::Unknown;
+}
+
 
 void vpColorDetection::drawObject(int &x, int &y, cv::Mat &frame){
 
@@ -387,6 +1013,20 @@ void vpColorDetection::setMaxAndMinObjectArea(const double &area_min, const doub
     setMaxObjectArea(area_max);
 }
 
+/*!
+   Enable the coarse-to-fine detection of detect(const cv::Mat &). The candidates are searched in the
+   image decimated by 2^level, then refined at full resolution in their neighborhood only.
+   The area limits of setMaxAndMinObjectArea() stay expressed in full resolution pixels.
+
+   \param level : Pyramid level, 0 to disable the coarse-to-fine detection, at most 4.
+ */
+void vpColorDetection::setPyramidLevel(const unsigned int &level)
+{
+    if (level > 4)
+        throw vpException(vpException::badValue, "Pyramid level %d greater than 4", level);
+    m_pyramidLevel = level;
+}
+
 /*!
    Save in a file the current value of HSV
    \param filename : name of the file to create.
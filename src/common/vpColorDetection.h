@@ -38,6 +38,7 @@
 #ifndef __vpColorDetection_h__
 #define __vpColorDetection_h__
 
+#include <algorithm>
 #include <iostream>
 
 
@@ -53,6 +54,12 @@
 #include <visp/vpImage.h>
 #include <visp/vpImageConvert.h>
 
+#include <vpAdaptiveColorModel.h>
+#include <vpBinaryMorphology.h>
+#include <vpColorThreshold.h>
+#include <vpConnectedComponents.h>
+#include <vpMultiColorClassifier.h>
+#include <vpYUVColorClassifier.h>
 
 
 struct found_objects {
@@ -85,11 +92,15 @@ struct found_objects {
 
 class VISP_EXPORT vpColorDetection : public vpDetectorBase
 {
+  friend class vpColorDetectionBands;
 
 public:
 
-
-
+  typedef enum {
+    MORPH_OPENCV,    //!< cv::erode() and cv::dilate()
+    MORPH_SEPARABLE, //!< Separable min/max filters on preallocated buffers, same result as MORPH_OPENCV
+    MORPH_BITPACKED  //!< vpBinaryMorphology on the mask packed in 64 bits words, same result as MORPH_OPENCV
+  } MorphologyEngine;
 
 protected:
   int m_H_min; //!< Minumum H value
@@ -115,6 +126,43 @@ protected:
   //GeometricShape m_geometricShape; //!< Indicate the geometricShape of the object
   std::vector <found_objects::GeometricShape> m_geometricShape;
   bool m_shapeRecognition; //!< If true the geometric shape recognition is activated
+  bool m_fusedThreshold; //!< If true the HSV thresholding is done in one pass without building the HSV image
+  vpYUVColorClassifier m_yuvClassifier; //!< HSV range translated in the YUV space
+  bool m_searchWindow; //!< If true, search only around the objects found in the previous frames
+  unsigned int m_maxMisses; //!< Number of consecutive misses in the search window before going back to the full frame
+  unsigned int m_nbMisses; //!< Current number of consecutive misses in the search window
+  double m_searchMargin; //!< Margin added around the previous objects, as a ratio of their size
+  cv::Rect m_searchBBox; //!< Bounding box of the objects found in the last detection
+  cv::Point2d m_searchVelocity; //!< Displacement of the center of m_searchBBox between the two last detections
+  cv::Rect m_searchRoi; //!< Area of the image processed by the last detection
+  MorphologyEngine m_morphEngine; //!< Implementation of the morphological operations
+  unsigned int m_pyramidLevel; //!< Level of the coarse detection, 0 to detect at full resolution only
+  const vpAdaptiveColorModel *m_colorModel; //!< If not NULL, used instead of the HSV range
+
+  // Work buffers, allocated once for a given image size
+  cv::Mat m_threshold; //!< Treshold image
+  cv::Mat m_morphBuffer; //!< Intermediate image of the separable morphological operations
+  cv::Mat m_contourBuffer; //!< Image of one component given to cv::findContours()
+  cv::Mat m_erodeElement; //!< Structuring element of the erosion
+  cv::Mat m_dilateElement; //!< Structuring element of the dilation
+  vpBinaryMorphology m_binaryMorphology; //!< Morphological operations of MORPH_BITPACKED
+  vpConnectedComponents m_components; //!< Connected components of the treshold image
+  std::vector< std::vector<cv::Point> > m_contours; //!< Contours of one component
+  std::vector<cv::Vec4i> m_hierarchy; //!< Hierarchy of m_contours
+  std::vector<cv::Point> m_approx; //!< Polygonal approximation used by the shape recognition
+  cv::Mat m_coarseThreshold; //!< Treshold image of the decimated image
+  vpConnectedComponents m_coarseComponents; //!< Connected components of m_coarseThreshold
+  std::vector<cv::Rect> m_pyramidRois; //!< Full resolution areas around the candidates of the coarse detection
+
+  // Parallel segmentation by horizontal bands
+  struct vpBand {
+    cv::Mat threshold; //!< Treshold image of the band and its halo
+    cv::Mat morphBuffer; //!< Intermediate image of MORPH_SEPARABLE
+    vpBinaryMorphology morphology; //!< Morphological operations of MORPH_BITPACKED
+  };
+  unsigned int m_nbThreads; //!< Number of bands processed in parallel
+  std::vector<vpBand> m_bands; //!< Work buffers of each band
+  std::vector<vpConnectedComponents> m_bandComponents; //!< Connected components of each band
 
 
 
@@ -122,7 +170,18 @@ protected:
   void createTrackbars();
   void drawObject(int &x, int &y, cv::Mat &frame);
   void morphOps(cv::Mat &T);
-  bool trackFilteredObject(cv::Mat threshold);
+  void morphOps(cv::Mat &T, cv::Mat &morphBuffer, vpBinaryMorphology &morphology) const;
+  void thresholdHSV(const cv::Mat &I, cv::Mat &T) const;
+  void segmentBand(unsigned int band, unsigned int nb_bands, const cv::Mat &I, const cv::Rect &roi);
+  bool detectCoarseToFine(const cv::Mat &I, const cv::Rect &roi);
+  bool findObjects(const vpConnectedComponents &components, int value = -1);
+  void selectObjects(const vpConnectedComponents &components, int value = -1);
+  bool publishObjects();
+  bool trackFilteredObject(const cv::Mat &threshold, const cv::Point &offset = cv::Point());
+  bool detectYUV422(const unsigned char *yuyv, unsigned int width, unsigned int height, unsigned char *luma);
+  found_objects::GeometricShape recognizeShape(const vpConnectedComponents &components, unsigned int index);
+  cv::Rect predictSearchWindow(const cv::Size &size) const;
+  void updateSearchWindow(bool detected, bool windowed);
   std::string intToString(int number);
   std::string getGeometricShapeString(found_objects::GeometricShape shape);
 
@@ -134,20 +193,36 @@ public:
   static double angle(cv::Point pt1, cv::Point pt2, cv::Point pt0);
   bool detect(const vpImage<unsigned char> &I) { std::cout << "Not implemented" << std::endl;}
   bool detect(const cv::Mat &I);
+  bool detect(const cv::Mat &I, const cv::Rect &roi);
+  bool detect(const cv::Mat &labels, unsigned int index);
+  bool detect(const cv::Mat &labels, const vpConnectedComponents &components, unsigned int index);
+  bool detectYUV422(const unsigned char *yuyv, unsigned int width, unsigned int height);
+  bool detectYUV422(const unsigned char *yuyv, vpImage<unsigned char> &I);
 
+  bool getLevelMorphOps() const {return m_levelMorphOps;}
   std::string getName(){return m_name;}
+  unsigned int getPyramidLevel() const {return m_pyramidLevel;}
+  cv::Rect getSearchWindow() const {return m_searchRoi;}
   std::vector<int> getValueHSV();
 
   bool learningColor(const cv::Mat &I);
+  void morphLabels(cv::Mat &labels);
   bool loadHSV(const std::string &filename);
   bool saveHSV(const std::string &filename);
+  void setColorModel(const vpAdaptiveColorModel *model){m_colorModel = model;}
   void setShapeRecognition(const bool &enable){m_shapeRecognition = enable;}
+  void setSearchWindow(const bool &enable, const unsigned int &max_misses = 5);
+  void setSearchWindowMargin(const double &margin){m_searchMargin = margin;}
+  void setFusedThreshold(const bool &enable){m_fusedThreshold = enable;}
   //void setGeometricShape(const GeometricShape &shape)  { m_geometricShape = shape; }
   void setLevelMorphOps(const bool level){m_levelMorphOps = level;}
+  void setMorphologyEngine(const MorphologyEngine &engine){m_morphEngine = engine;}
   void setMinObjectArea(const double &area_min){m_min_obj_area = area_min; }
   void setMaxObjectArea(const double &area_max){m_max_obj_area = area_max; }
   void setMaxAndMinObjectArea(const double &area_min, const double &area_max );
   void setName(const std::string &name) {m_name = name;}
+  void setNbThreads(const unsigned int &nb_threads){m_nbThreads = std::max(1u, nb_threads);}
+  void setPyramidLevel(const unsigned int &level);
   void setValuesHSV(const int H_min, const int S_min, const int V_min,
                     const int H_max, const int S_max, const int V_max);
   void setValuesHSV(const std::vector<int> values);
@@ -0,0 +1,251 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Fused BGR to HSV range thresholding.
+ *
+ *****************************************************************************/
+
+#include <vpColorThreshold.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define VP_COLOR_THRESHOLD_NEON
+#endif
+
+namespace {
+
+const int hsv_shift = 12;
+
+/*
+  Fixed-point division tables of the 8 bits BGR2HSV conversion in OpenCV.
+  Using the same tables is what makes the fused path bit-exact.
+ */
+struct vpHsvDivTables
+{
+  int sdiv[256];
+  int hdiv[256];
+
+  vpHsvDivTables()
+  {
+    sdiv[0] = hdiv[0] = 0;
+    for (int i = 1; i < 256; i++) {
+      sdiv[i] = cvRound((255 << hsv_shift)/(1.*i));
+      hdiv[i] = cvRound((180 << hsv_shift)/(6.*i));
+    }
+  }
+};
+
+const vpHsvDivTables s_hsv_tables;
+
+inline int clampU8(int value)
+{
+  return std::min(std::max(value, 0), 255);
+}
+
+/*
+  Exact HSV range test of one BGR pixel.
+ */
+inline bool inRangeHSV(const unsigned char *p, const int *lo, const int *hi)
+{
+  int b = p[0], g = p[1], r = p[2];
+  int v = std::max(b, std::max(g, r));
+  if (v < lo[2] || v > hi[2])
+    return false;
+
+  int diff = v - std::min(b, std::min(g, r));
+  int s = (diff * s_hsv_tables.sdiv[v] + (1 << (hsv_shift-1))) >> hsv_shift;
+  if (s < lo[1] || s > hi[1])
+    return false;
+
+  int h;
+  if (v == r)
+    h = g - b;
+  else if (v == g)
+    h = b - r + 2*diff;
+  else
+    h = r - g + 4*diff;
+  h = (h * s_hsv_tables.hdiv[diff] + (1 << (hsv_shift-1))) >> hsv_shift;
+  if (h < 0)
+    h += 180;
+
+  return clampU8(h) >= lo[0] && clampU8(h) <= hi[0];
+}
+
+void thresholdRow(const unsigned char *src, unsigned char *dst, int width, const int *lo, const int *hi)
+{
+  int x = 0;
+
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i k255 = _mm_set1_epi16(255);
+  const __m128i v_lo = _mm_set1_epi8((char)clampU8(lo[2]));
+  const __m128i v_hi = _mm_set1_epi8((char)clampU8(hi[2]));
+  const __m128i s_lo = _mm_set1_epi16((short)clampU8(lo[1]-1));
+  const __m128i s_hi = _mm_set1_epi16((short)std::min(std::max(hi[1]+1, 0), 256));
+  // 16 BGR pixels span 3 registers. In each register, the lanes holding the first
+  // byte of a pixel get max(b,g,r) and min(b,g,r) from the loads shifted by 1 and 2 bytes.
+  const __m128i lanes[3] = { _mm_setr_epi8(-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1),
+                             _mm_setr_epi8(0,0,-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1,0),
+                             _mm_setr_epi8(0,-1,0,0,-1,0,0,-1,0,0,-1,0,0,-1,0,0) };
+
+  // The shifted loads read 2 bytes past the block: keep at least one pixel for the scalar loop
+  for (; x + 17 <= width; x += 16) {
+    const unsigned char *p = src + 3*x;
+    int candidates[3];
+    int any = 0;
+    for (int k = 0; k < 3; k++) {
+      __m128i c0 = _mm_loadu_si128((const __m128i *)(p + 16*k));
+      __m128i c1 = _mm_loadu_si128((const __m128i *)(p + 16*k + 1));
+      __m128i c2 = _mm_loadu_si128((const __m128i *)(p + 16*k + 2));
+      __m128i v = _mm_max_epu8(c0, _mm_max_epu8(c1, c2));
+      __m128i diff = _mm_subs_epu8(v, _mm_min_epu8(c0, _mm_min_epu8(c1, c2)));
+
+      // V is exact
+      __m128i m = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, v_lo), v),
+                                _mm_cmpeq_epi8(_mm_min_epu8(v, v_hi), v));
+
+      // Necessary condition on S: (S_min-1)*v <= 255*diff <= (S_max+1)*v
+      __m128i d16 = _mm_mullo_epi16(_mm_unpacklo_epi8(diff, zero), k255);
+      __m128i v16 = _mm_unpacklo_epi8(v, zero);
+      __m128i s_ok_lo = _mm_and_si128(_mm_cmpeq_epi16(_mm_subs_epu16(_mm_mullo_epi16(v16, s_lo), d16), zero),
+                                      _mm_cmpeq_epi16(_mm_subs_epu16(d16, _mm_mullo_epi16(v16, s_hi)), zero));
+      d16 = _mm_mullo_epi16(_mm_unpackhi_epi8(diff, zero), k255);
+      v16 = _mm_unpackhi_epi8(v, zero);
+      __m128i s_ok_hi = _mm_and_si128(_mm_cmpeq_epi16(_mm_subs_epu16(_mm_mullo_epi16(v16, s_lo), d16), zero),
+                                      _mm_cmpeq_epi16(_mm_subs_epu16(d16, _mm_mullo_epi16(v16, s_hi)), zero));
+      m = _mm_and_si128(m, _mm_packs_epi16(s_ok_lo, s_ok_hi));
+
+      candidates[k] = _mm_movemask_epi8(_mm_and_si128(m, lanes[k]));
+      any |= candidates[k];
+    }
+
+    memset(dst + x, 0, 16);
+    if (any) {
+      for (int k = 0; k < 3; k++) {
+        for (int j = 0; j < 16; j++) {
+          if (candidates[k] & (1 << j)) {
+            int i = (16*k + j) / 3;
+            if (inRangeHSV(p + 3*i, lo, hi))
+              dst[x + i] = 255;
+          }
+        }
+      }
+    }
+  }
+#elif defined(VP_COLOR_THRESHOLD_NEON)
+  const uint8x16_t v_lo = vdupq_n_u8((unsigned char)clampU8(lo[2]));
+  const uint8x16_t v_hi = vdupq_n_u8((unsigned char)clampU8(hi[2]));
+  const uint16x8_t s_lo = vdupq_n_u16((unsigned short)clampU8(lo[1]-1));
+  const uint16x8_t s_hi = vdupq_n_u16((unsigned short)std::min(std::max(hi[1]+1, 0), 256));
+  const uint8x8_t k255 = vdup_n_u8(255);
+
+  for (; x + 16 <= width; x += 16) {
+    const unsigned char *p = src + 3*x;
+    uint8x16x3_t bgr = vld3q_u8(p);
+    uint8x16_t v = vmaxq_u8(bgr.val[0], vmaxq_u8(bgr.val[1], bgr.val[2]));
+    uint8x16_t diff = vsubq_u8(v, vminq_u8(bgr.val[0], vminq_u8(bgr.val[1], bgr.val[2])));
+
+    // V is exact
+    uint8x16_t m = vandq_u8(vcgeq_u8(v, v_lo), vcleq_u8(v, v_hi));
+
+    // Necessary condition on S: (S_min-1)*v <= 255*diff <= (S_max+1)*v
+    uint16x8_t d16 = vmull_u8(vget_low_u8(diff), k255);
+    uint16x8_t v16 = vmovl_u8(vget_low_u8(v));
+    uint16x8_t s_ok_lo = vandq_u16(vcgeq_u16(d16, vmulq_u16(v16, s_lo)), vcleq_u16(d16, vmulq_u16(v16, s_hi)));
+    d16 = vmull_u8(vget_high_u8(diff), k255);
+    v16 = vmovl_u8(vget_high_u8(v));
+    uint16x8_t s_ok_hi = vandq_u16(vcgeq_u16(d16, vmulq_u16(v16, s_lo)), vcleq_u16(d16, vmulq_u16(v16, s_hi)));
+    m = vandq_u8(m, vcombine_u8(vmovn_u16(s_ok_lo), vmovn_u16(s_ok_hi)));
+
+    unsigned char candidates[16];
+    vst1q_u8(candidates, m);
+    memset(dst + x, 0, 16);
+    for (int i = 0; i < 16; i++) {
+      if (candidates[i] && inRangeHSV(p + 3*i, lo, hi))
+        dst[x + i] = 255;
+    }
+  }
+#endif
+
+  for (; x < width; x++)
+    dst[x] = inRangeHSV(src + 3*x, lo, hi) ? 255 : 0;
+}
+
+}
+
+/*!
+  Threshold a BGR image against an HSV range.
+
+  \param bgr : Input image of type CV_8UC3.
+  \param mask : Output mask of type CV_8UC1, 255 where the pixel is in the range, 0 otherwise.
+  \param hsv_min : Lower bounds H, S, V (inclusive). H is in [0, 180[ like in OpenCV.
+  \param hsv_max : Upper bounds H, S, V (inclusive).
+ */
+void vpColorThreshold::thresholdHSV(const cv::Mat &bgr, cv::Mat &mask, const int hsv_min[3], const int hsv_max[3])
+{
+  CV_Assert(bgr.type() == CV_8UC3);
+  mask.create(bgr.size(), CV_8UC1);
+  thresholdHSV(bgr.data, bgr.step, mask.data, mask.step, bgr.cols, bgr.rows, hsv_min, hsv_max);
+}
+
+/*!
+  Raw buffer version of thresholdHSV(const cv::Mat &, cv::Mat &, const int [3], const int [3]).
+ */
+void vpColorThreshold::thresholdHSV(const unsigned char *bgr, size_t bgr_step, unsigned char *mask, size_t mask_step,
+                                    int width, int height, const int hsv_min[3], const int hsv_max[3])
+{
+  for (int y = 0; y < height; y++)
+    thresholdRow(bgr + y*bgr_step, mask + y*mask_step, width, hsv_min, hsv_max);
+}
+
+/*!
+  Reference implementation based on cv::cvtColor() and cv::inRange().
+ */
+void vpColorThreshold::thresholdHSVReference(const cv::Mat &bgr, cv::Mat &mask, const int hsv_min[3], const int hsv_max[3])
+{
+  cv::Mat hsv;
+  cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
+  cv::inRange(hsv, cv::Scalar(hsv_min[0], hsv_min[1], hsv_min[2]),
+              cv::Scalar(hsv_max[0], hsv_max[1], hsv_max[2]), mask);
+}
+
+/*!
+  Exact HSV range test of a single BGR pixel, same result as the masks computed by thresholdHSV().
+ */
+bool vpColorThreshold::isInRangeHSV(const unsigned char *bgr, const int hsv_min[3], const int hsv_max[3])
+{
+  return inRangeHSV(bgr, hsv_min, hsv_max);
+}
@@ -0,0 +1,62 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Fused BGR to HSV range thresholding.
+ *
+ *****************************************************************************/
+#ifndef __vpColorThreshold_h__
+#define __vpColorThreshold_h__
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+/*!
+  Threshold a BGR image against an HSV range without building the HSV image.
+
+  The result is bit-exact with the reference
+  \code
+  cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
+  cv::inRange(hsv, cv::Scalar(H_min, S_min, V_min), cv::Scalar(H_max, S_max, V_max), mask);
+  \endcode
+  but it runs in a single pass over the BGR image. A SIMD stage (SSE2 or NEON)
+  rejects blocks of 16 pixels on V and on a conservative bound of S, only the
+  remaining candidates go through the exact fixed-point HSV computation used by OpenCV.
+ */
+class vpColorThreshold
+{
+public:
+  static void thresholdHSV(const cv::Mat &bgr, cv::Mat &mask, const int hsv_min[3], const int hsv_max[3]);
+  static void thresholdHSV(const unsigned char *bgr, size_t bgr_step, unsigned char *mask, size_t mask_step,
+                           int width, int height, const int hsv_min[3], const int hsv_max[3]);
+  static void thresholdHSVReference(const cv::Mat &bgr, cv::Mat &mask, const int hsv_min[3], const int hsv_max[3]);
+  static bool isInRangeHSV(const unsigned char *bgr, const int hsv_min[3], const int hsv_max[3]);
+};
+
+#endif
@@ -0,0 +1,326 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Connected component labeling of a binary mask with moments and bounding boxes.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include <vpConnectedComponents.h>
+
+/*!
+  Default constructor.
+ */
+vpConnectedComponents::vpConnectedComponents()
+  : m_runs(), m_parent(), m_stats(), m_index(), m_components(), m_first_row(0), m_last_row(-1)
+{
+}
+
+/*!
+  Add the moments and the bounding box of \e stats to \e component.
+ */
+void vpConnectedComponents::add(vpComponent &component, const vpComponent &stats)
+{
+  component.m00 += stats.m00;
+  component.m10 += stats.m10;
+  component.m01 += stats.m01;
+  component.m20 += stats.m20;
+  component.m02 += stats.m02;
+  component.m11 += stats.m11;
+  component.x_min = std::min(component.x_min, stats.x_min);
+  component.x_max = std::max(component.x_max, stats.x_max);
+  component.y_min = std::min(component.y_min, stats.y_min);
+  component.y_max = std::max(component.y_max, stats.y_max);
+}
+
+int vpConnectedComponents::findRoot(int label)
+{
+  int root = label;
+  while (m_parent[root] != root)
+    root = m_parent[root];
+  // Path compression
+  while (m_parent[label] != root) {
+    int next = m_parent[label];
+    m_parent[label] = root;
+    label = next;
+  }
+  return root;
+}
+
+void vpConnectedComponents::merge(int label1, int label2)
+{
+  int root1 = findRoot(label1);
+  int root2 = findRoot(label2);
+  // The root is always the smallest label
+  if (root1 < root2)
+    m_parent[root2] = root1;
+  else if (root2 < root1)
+    m_parent[root1] = root2;
+}
+
+/*!
+  Label the 8-connected components of a mask.
+  \param mask : Image of type CV_8UC1, the non zero pixels belong to the components.
+  \param offset : Position of the mask in the full image. The moments, bounding boxes and runs
+  are expressed in the full image.
+ */
+void vpConnectedComponents::label(const cv::Mat &mask, const cv::Point &offset)
+{
+  scan(mask, offset, false);
+}
+
+/*!
+  Label the 8-connected components of an image of classes. Two neighbour pixels belong to the
+  same component only if they have the same value, given by vpComponent::value. A mask with a
+  single non zero value gives the same components as label().
+  \param image : Image of type CV_8UC1, the non zero pixels belong to the components.
+  \param offset : Position of the image in the full image.
+ */
+void vpConnectedComponents::labelValues(const cv::Mat &image, const cv::Point &offset)
+{
+  scan(image, offset, true);
+}
+
+/*!
+  Scan of label() and labelValues().
+  \param by_value : If false, all the non zero pixels are in the same class, given the value 255.
+ */
+void vpConnectedComponents::scan(const cv::Mat &mask, const cv::Point &offset, bool by_value)
+{
+  CV_Assert(mask.type() == CV_8UC1);
+
+  m_runs.clear();
+  m_parent.clear();
+  m_stats.clear();
+  m_components.clear();
+  m_first_row = offset.y;
+  m_last_row = offset.y + mask.rows - 1;
+
+  size_t prev_begin = 0, prev_end = 0; // Runs of the previous row
+  for (int i = 0; i < mask.rows; i++) {
+    const unsigned char *row = mask.ptr<unsigned char>(i);
+    const int y = i + offset.y;
+    const size_t cur_begin = m_runs.size();
+    size_t j = prev_begin;
+    int x = 0;
+    while (x < mask.cols) {
+      // Skip the background 8 pixels at a time
+      while (x + 8 <= mask.cols) {
+        unsigned long long word;
+        memcpy(&word, row + x, 8);
+        if (word)
+          break;
+        x += 8;
+      }
+      while (x < mask.cols && !row[x])
+        x++;
+      if (x == mask.cols)
+        break;
+      const int start = x + offset.x;
+      const unsigned char value = by_value ? row[x] : 255;
+      if (by_value) {
+        while (x < mask.cols && row[x] == value)
+          x++;
+      }
+      else {
+        while (x < mask.cols && row[x])
+          x++;
+      }
+      const int end = x - 1 + offset.x;
+
+      // Runs of the previous row touching [start-1, end+1], with the same value
+      while (j < prev_end && m_runs[j].end < start - 1)
+        j++;
+      int label = -1;
+      for (size_t k = j; k < prev_end && m_runs[k].start <= end + 1; k++) {
+        if (m_runs[k].value != value)
+          continue;
+        if (label < 0)
+          label = findRoot(m_runs[k].label);
+        else
+          merge(label, m_runs[k].label);
+      }
+      if (label < 0) {
+        label = m_parent.size();
+        m_parent.push_back(label);
+        vpComponent stats;
+        stats.m00 = stats.m10 = stats.m01 = stats.m20 = stats.m02 = stats.m11 = 0.;
+        stats.x_min = start;
+        stats.x_max = end;
+        stats.y_min = stats.y_max = y;
+        stats.value = value;
+        m_stats.push_back(stats);
+      }
+
+      vpRun run;
+      run.row = y;
+      run.start = start;
+      run.end = end;
+      run.label = label;
+      run.value = value;
+      m_runs.push_back(run);
+
+      // Sums over the run, the one of the squares being S(end) - S(start-1) with S(k) = k(k+1)(2k+1)/6
+      const double n = end - start + 1;
+      const double sum_x = 0.5 * (run.start + run.end) * n;
+      const double s0 = start - 1.;
+      const double s1 = end;
+      vpComponent &stats = m_stats[label];
+      stats.m00 += n;
+      stats.m10 += sum_x;
+      stats.m01 += y * n;
+      stats.m20 += (s1 * (s1 + 1) * (2 * s1 + 1) - s0 * (s0 + 1) * (2 * s0 + 1)) / 6.;
+      stats.m02 += (double)y * y * n;
+      stats.m11 += y * sum_x;
+      stats.x_min = std::min(stats.x_min, run.start);
+      stats.x_max = std::max(stats.x_max, run.end);
+      stats.y_min = std::min(stats.y_min, y);
+      stats.y_max = std::max(stats.y_max, y);
+    }
+    prev_begin = cur_begin;
+    prev_end = m_runs.size();
+  }
+
+  // A label always points to a smaller one, so the roots are resolved in increasing order
+  m_index.resize(m_parent.size());
+  for (size_t l = 0; l < m_parent.size(); l++) {
+    int root = findRoot(l);
+    if (root == (int)l) {
+      m_index[l] = m_components.size();
+      m_components.push_back(m_stats[l]);
+    }
+    else {
+      m_index[l] = m_index[root];
+      add(m_components[m_index[root]], m_stats[l]);
+    }
+  }
+
+  for (size_t r = 0; r < m_runs.size(); r++)
+    m_runs[r].label = m_index[m_runs[r].label];
+}
+
+/*!
+  Merge the components of consecutive horizontal bands of a mask.
+  \param bands : Components of each band, labeled with label() from top to bottom. Each band
+  starts on the row following the last row of the previous one.
+ */
+void vpConnectedComponents::join(const std::vector<vpConnectedComponents> &bands)
+{
+  m_runs.clear();
+  m_parent.clear();
+  m_stats.clear();
+  m_components.clear();
+  m_first_row = bands.empty() ? 0 : bands.front().m_first_row;
+  m_last_row = bands.empty() ? -1 : bands.back().m_last_row;
+
+  // The components of the bands are the provisional labels
+  for (size_t b = 0; b < bands.size(); b++) {
+    const int base = m_parent.size();
+    for (size_t c = 0; c < bands[b].m_components.size(); c++) {
+      m_parent.push_back(base + c);
+      m_stats.push_back(bands[b].m_components[c]);
+    }
+    const size_t first_run = m_runs.size();
+    m_runs.insert(m_runs.end(), bands[b].m_runs.begin(), bands[b].m_runs.end());
+    for (size_t r = first_run; r < m_runs.size(); r++)
+      m_runs[r].label += base;
+  }
+
+  // Merge the runs of the last row of a band with the runs of the first row of the next band.
+  // Bands without any row are skipped.
+  size_t band_begin = 0, prev_begin = 0, prev_end = 0;
+  int prev_last_row = -1;
+  bool has_prev = false;
+  for (size_t b = 0; b < bands.size(); b++) {
+    const size_t band_end = band_begin + bands[b].m_runs.size();
+    if (bands[b].m_last_row < bands[b].m_first_row) {
+      band_begin = band_end;
+      continue;
+    }
+    if (has_prev) {
+      size_t i = prev_end;
+      while (i > prev_begin && m_runs[i-1].row == prev_last_row)
+        i--;
+      // Runs of the last row touching each run of the first row, as in label(). With labelValues()
+      // two runs of a row can be contiguous, so that a run can touch several runs on both sides.
+      for (size_t j = band_begin; j < band_end && m_runs[j].row == bands[b].m_first_row; j++) {
+        const vpRun &below = m_runs[j];
+        while (i < prev_end && m_runs[i].end < below.start - 1)
+          i++;
+        for (size_t k = i; k < prev_end && m_runs[k].start <= below.end + 1; k++) {
+          if (m_runs[k].value == below.value)
+            merge(m_runs[k].label, below.label);
+        }
+      }
+    }
+    has_prev = true;
+    prev_begin = band_begin;
+    prev_end = band_end;
+    prev_last_row = bands[b].m_last_row;
+    band_begin = band_end;
+  }
+
+  // Number the components in the order of their first run, like label() does
+  m_index.assign(m_parent.size(), -1);
+  for (size_t r = 0; r < m_runs.size(); r++) {
+    int root = findRoot(m_runs[r].label);
+    if (m_index[root] < 0) {
+      m_index[root] = m_components.size();
+      m_components.push_back(m_stats[root]);
+    }
+  }
+  for (size_t l = 0; l < m_parent.size(); l++) {
+    int root = findRoot(l);
+    if (root != (int)l) {
+      add(m_components[m_index[root]], m_stats[l]);
+    }
+  }
+
+  for (size_t r = 0; r < m_runs.size(); r++)
+    m_runs[r].label = m_index[findRoot(m_runs[r].label)];
+}
+
+/*!
+  Set to 255 the pixels of a component in an image.
+  \param index : Index of the component.
+  \param image : Image of type CV_8UC1 that has to contain the bounding box of the component.
+  \param origin : Position of \e image in the full image.
+ */
+void vpConnectedComponents::drawComponent(unsigned int index, cv::Mat &image, const cv::Point &origin) const
+{
+  for (size_t r = 0; r < m_runs.size(); r++) {
+    const vpRun &run = m_runs[r];
+    if (run.label == (int)index)
+      memset(image.ptr<unsigned char>(run.row - origin.y) + run.start - origin.x, 255, run.end - run.start + 1);
+  }
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Connected component labeling of a binary mask with moments and bounding boxes.
+ *
+ *****************************************************************************/
+#ifndef __vpConnectedComponents_h__
+#define __vpConnectedComponents_h__
+
+#include <vector>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+/*!
+  Label the 8-connected components of a binary mask in a single scan.
+
+  The mask is read row by row as runs of non zero pixels. Each run is merged with the
+  overlapping runs of the previous row using a union-find structure, and the moments up to the
+  second order and the bounding box of the components are accumulated during the same scan.
+
+  The runs are kept, so that the pixels of a component can be drawn afterwards, for example
+  to compute its contour only when it is needed. All the buffers are reused from one call
+  to the next.
+
+  labelValues() labels an image of several classes, like the label image of
+  vpMultiColorClassifier, in the same scan: the pixels of a component all have the same non
+  zero value, so that several detectors can share a single labeling of the image.
+
+  A mask can also be labeled by horizontal bands, possibly in parallel, each band with its own
+  vpConnectedComponents. join() then merges the components crossing the band boundaries. The
+  result, including the order of the components, is the same as labeling the whole mask.
+ */
+class vpConnectedComponents
+{
+public:
+  struct vpComponent
+  {
+    double m00; //!< Number of pixels
+    double m10; //!< Sum of the x coordinates
+    double m01; //!< Sum of the y coordinates
+    double m20; //!< Sum of the squared x coordinates
+    double m02; //!< Sum of the squared y coordinates
+    double m11; //!< Sum of the products of the x and y coordinates
+    int x_min, y_min, x_max, y_max; //!< Bounding box, bounds included
+    unsigned char value; //!< Value of the pixels with labelValues(), 255 with label()
+
+    cv::Rect getBBox() const { return cv::Rect(x_min, y_min, x_max - x_min + 1, y_max - y_min + 1); }
+    cv::Point2d getCog() const { return cv::Point2d(m10 / m00, m01 / m00); }
+  };
+
+protected:
+  struct vpRun
+  {
+    int row;
+    int start;
+    int end;   //!< Included
+    int label; //!< Provisional label during the scan, index of the component after
+    unsigned char value;
+  };
+
+  std::vector<vpRun> m_runs;
+  std::vector<int> m_parent; //!< Union-find forest of the provisional labels
+  std::vector<vpComponent> m_stats; //!< Moments of the provisional labels
+  std::vector<int> m_index; //!< Component of each provisional label
+  std::vector<vpComponent> m_components;
+  int m_first_row; //!< First row of the labeled mask in the full image
+  int m_last_row; //!< Last row of the labeled mask in the full image
+
+  static void add(vpComponent &component, const vpComponent &stats);
+  int findRoot(int label);
+  void merge(int label1, int label2);
+  void scan(const cv::Mat &mask, const cv::Point &offset, bool by_value);
+
+public:
+  vpConnectedComponents();
+  virtual ~vpConnectedComponents() {}
+
+  void drawComponent(unsigned int index, cv::Mat &image, const cv::Point &origin = cv::Point()) const;
+  const vpComponent &getComponent(unsigned int index) const { return m_components[index]; }
+  unsigned int getNbComponents() const { return m_components.size(); }
+  void join(const std::vector<vpConnectedComponents> &bands);
+  void label(const cv::Mat &mask, const cv::Point &offset = cv::Point());
+  void labelValues(const cv::Mat &image, const cv::Point &offset = cv::Point());
+};
+
+#endif
@@ -0,0 +1,176 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Extraction of all the dots of an area in a single scan.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <visp/vpMath.h>
+
+#include <vpDotExtractor.h>
+
+/*!
+  Default constructor.
+ */
+vpDotExtractor::vpDotExtractor()
+  : m_mask(), m_components()
+{
+}
+
+/*!
+  Return true if the pixel is in the image and in the gray level range of the wanted dot.
+ */
+bool vpDotExtractor::hasGoodLevel(const vpImage<unsigned char> &I, const vpDot2 &wanted, double u, double v)
+{
+  if (u < 0 || v < 0 || u >= I.getWidth() || v >= I.getHeight())
+    return false;
+  const unsigned char level = I[(unsigned int)v][(unsigned int)u];
+  return level >= wanted.getGrayLevelMin() && level <= wanted.getGrayLevelMax();
+}
+
+/*!
+  Same checks as vpDot2::isValid(): the size and the area of the dot have to be the ones of the
+  wanted dot up to its size precision, the pixels of the ellipse of the dot shrunk by the ellipsoid
+  shape precision have to be in the gray level range, and the ones of the enlarged ellipse outside.
+ */
+bool vpDotExtractor::isValid(const vpImage<unsigned char> &I, const vpDot2 &wanted, const vpDot2 &dot)
+{
+  const double epsilon = std::numeric_limits<double>::epsilon();
+  const double size_precision = wanted.getSizePrecision();
+  if (size_precision > epsilon && wanted.getWidth() > 0 && wanted.getHeight() > 0) {
+    if (!(wanted.getWidth() * size_precision - epsilon < dot.getWidth())
+        || !(dot.getWidth() < wanted.getWidth() / (size_precision + epsilon)))
+      return false;
+    if (!(wanted.getHeight() * size_precision - epsilon < dot.getHeight())
+        || !(dot.getHeight() < wanted.getHeight() / (size_precision + epsilon)))
+      return false;
+    if (!(wanted.getArea() * size_precision * size_precision - epsilon < dot.getArea())
+        || !(dot.getArea() < wanted.getArea() / (size_precision * size_precision + epsilon)))
+      return false;
+  }
+
+  const double shape_precision = wanted.getEllipsoidShapePrecision();
+  if (shape_precision <= epsilon)
+    return true;
+
+  // Axes and orientation of the ellipse that has the same moments as the dot
+  const double sqrt_delta = std::sqrt(vpMath::sqr(dot.mu20 - dot.mu02) + 4 * dot.mu11 * dot.mu11);
+  const double a1 = std::sqrt(2 * (dot.mu20 + dot.mu02 + sqrt_delta) / dot.m00);
+  const double a2 = std::sqrt(std::max(0.0, 2 * (dot.mu20 + dot.mu02 - sqrt_delta) / dot.m00));
+  const double alpha = 0.5 * std::atan2(2 * dot.mu11, dot.mu20 - dot.mu02);
+  const double cos_alpha = std::cos(alpha);
+  const double sin_alpha = std::sin(alpha);
+  const double cog_u = dot.getCog().get_u();
+  const double cog_v = dot.getCog().get_v();
+
+  const int nb_points = 20;
+  const int nb_max_bad_points = (int)(nb_points * wanted.getEllipsoidBadPointsPercentage());
+  const double coef[2] = { shape_precision, 2 - shape_precision };
+  for (int e = 0; e < 2; e++) {
+    int nb_bad_points = 0;
+    for (int k = 0; k < nb_points; k++) {
+      const double theta = 2 * M_PI * k / nb_points;
+      const double x = coef[e] * a1 * std::cos(theta);
+      const double y = coef[e] * a2 * std::sin(theta);
+      const double u = cog_u + x * cos_alpha - y * sin_alpha;
+      const double v = cog_v + x * sin_alpha + y * cos_alpha;
+      // Inside the dot the level has to be in the range, outside it has to be out of the range
+      bool good;
+      if (e == 0)
+        good = hasGoodLevel(I, wanted, u, v);
+      else
+        good = u >= 0 && v >= 0 && u < I.getWidth() && v < I.getHeight() && !hasGoodLevel(I, wanted, u, v);
+      if (!good && ++nb_bad_points > nb_max_bad_points)
+        return false;
+    }
+  }
+  return true;
+}
+
+/*!
+  Find the dots of an area that look like a wanted dot.
+  \param I : Image.
+  \param wanted : Dot that gives the gray level range, the size, the area and the precisions. When
+  its size is null, only the shape of the dots is checked.
+  \param area_u, area_v : Top left corner of the area.
+  \param area_w, area_h : Size of the area. The area is clipped to the image, and only the dots
+  that are completely inside are kept, as with vpDot2::searchDotsInArea().
+  \param dots : Dots found in the area.
+ */
+void vpDotExtractor::searchDotsInArea(const vpImage<unsigned char> &I, const vpDot2 &wanted, int area_u, int area_v,
+                                      unsigned int area_w, unsigned int area_h, std::list<vpDot2> &dots)
+{
+  dots.clear();
+
+  const int left = std::max(area_u, 0);
+  const int top = std::max(area_v, 0);
+  const int right = std::min(area_u + (int)area_w, (int)I.getWidth()) - 1;
+  const int bottom = std::min(area_v + (int)area_h, (int)I.getHeight()) - 1;
+  if (right < left || bottom < top)
+    return;
+
+  // One more pixel around the area, to know whether the dots touching its border end there
+  const cv::Rect roi(cv::Point(std::max(left - 1, 0), std::max(top - 1, 0)),
+                     cv::Point(std::min(right + 2, (int)I.getWidth()), std::min(bottom + 2, (int)I.getHeight())));
+  const cv::Mat image((int)I.getHeight(), (int)I.getWidth(), CV_8UC1, (void *)I.bitmap);
+  cv::inRange(image(roi), cv::Scalar(wanted.getGrayLevelMin()), cv::Scalar(wanted.getGrayLevelMax()), m_mask);
+  m_components.label(m_mask, roi.tl());
+
+  for (unsigned int index = 0; index < m_components.getNbComponents(); index++) {
+    const vpConnectedComponents::vpComponent &component = m_components.getComponent(index);
+    if (component.x_min < left || component.x_max > right || component.y_min < top || component.y_max > bottom)
+      continue;
+
+    vpDot2 dot = wanted;
+    const double u = component.m10 / component.m00;
+    const double v = component.m01 / component.m00;
+    dot.setCog(vpImagePoint(v, u));
+    dot.setWidth(component.x_max - component.x_min + 1);
+    dot.setHeight(component.y_max - component.y_min + 1);
+    dot.setArea(component.m00);
+    dot.m00 = component.m00;
+    dot.m10 = component.m10;
+    dot.m01 = component.m01;
+    dot.m20 = component.m20;
+    dot.m02 = component.m02;
+    dot.m11 = component.m11;
+    dot.mu20 = component.m20 - u * component.m10;
+    dot.mu02 = component.m02 - v * component.m01;
+    dot.mu11 = component.m11 - u * component.m01;
+
+    if (isValid(I, wanted, dot))
+      dots.push_back(dot);
+  }
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Extraction of all the dots of an area in a single scan.
+ *
+ *****************************************************************************/
+#ifndef __vpDotExtractor_h__
+#define __vpDotExtractor_h__
+
+#include <list>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <visp/vpDot2.h>
+#include <visp/vpImage.h>
+
+#include <vpConnectedComponents.h>
+
+/*!
+  Find the dots of an area like vpDot2::searchDotsInArea(), in a bounded time.
+
+  vpDot2::searchDotsInArea() grows a region from each seed of a grid, so that its cost depends
+  on the content of the image. Here the area is thresholded once to the gray level range of the
+  wanted dot, the components are labeled with vpConnectedComponents in the same scan, then each
+  component goes through the checks of vpDot2: the size and area compared to the wanted dot with
+  its size precision, then the inner and outer ellipses given by the second order moments with
+  its ellipsoid shape precision. The cost is linear in the size of the area, plus 40 pixels read
+  per component of the right size.
+
+  The dots are returned in the order of their first row, with their center of gravity, size,
+  area, moments and the parameters of the wanted dot, so that they can be tracked directly.
+  All the buffers are reused from one call to the next.
+
+  \code
+  vpDotExtractor extractor;
+  std::list<vpDot2> dots;
+  extractor.searchDotsInArea(I, black_blob, left, top, width, height, dots);
+  \endcode
+ */
+class vpDotExtractor
+{
+protected:
+  cv::Mat m_mask; //!< Pixels of the area in the gray level range
+  vpConnectedComponents m_components; //!< Components of m_mask
+
+  static bool hasGoodLevel(const vpImage<unsigned char> &I, const vpDot2 &wanted, double u, double v);
+  static bool isValid(const vpImage<unsigned char> &I, const vpDot2 &wanted, const vpDot2 &dot);
+
+public:
+  vpDotExtractor();
+  virtual ~vpDotExtractor() {}
+
+  void searchDotsInArea(const vpImage<unsigned char> &I, const vpDot2 &wanted, int area_u, int area_v,
+                        unsigned int area_w, unsigned int area_h, std::list<vpDot2> &dots);
+};
+
+#endif
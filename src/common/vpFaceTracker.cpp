@@ -4,13 +4,15 @@
 
 vpFaceTracker::vpFaceTracker() : m_warp(), m_tracker(NULL), m_faces(), m_state(detection),
   m_face_cascade(), m_frame_gray(), m_zone_ref(), m_zone_cur(),
-  m_area_zone_ref(0), m_area_zone_cur(0), m_area_zone_prev(0), m_p()
+  m_p(), m_target(),
+  m_frame(), m_templateLevel(1), m_quality()
 {
-  m_tracker = new vpTemplateTrackerSSDInverseCompositional(&m_warp);
+  m_tracker = new vpTemplateTrackerResidual(&m_warp);
   m_tracker->setSampling(2,2);
   m_tracker->setLambda(0.001);
   m_tracker->setIterationMax(5);
-  m_tracker->setPyramidal(2, 1);
+  // The frame context gives the blurred level
+  m_tracker->setBlur(false);
 }
 
 vpFaceTracker::~vpFaceTracker()
@@ -26,8 +28,46 @@ void vpFaceTracker::setFaceCascade(const std::string &filename)
   }
 }
 
+/*!
+  Move the tracked face by the motion of the camera predicted from the joints of the robot, so
+  that the next track() starts the template tracker from the expected location. The face is
+  supposed not to move. Nothing is done when the face is not tracked.
+  \param predictor : Camera displacement since the last call to track().
+  \param cam : Camera parameters.
+  \param Z : Approximate distance of the face, in meter.
+  */
+void vpFaceTracker::predictMotion(const vpMotionPredictor &predictor, const vpCameraParameters &cam, const double &Z)
+{
+  if (m_state != tracking)
+    return;
+
+  vpImagePoint cog = m_target.getCenter();
+  vpImagePoint displacement = predictor.predict(cam, cog, Z) - cog;
+
+  // Translation of the SRT warp, in the level of the pyramid where the template is tracked
+  const double scale = 1. / (1 << m_templateLevel);
+  m_p = m_tracker->getp();
+  m_p[2] += scale * displacement.get_u();
+  m_p[3] += scale * displacement.get_v();
+  m_tracker->setp(m_p);
+}
+
 bool vpFaceTracker::track(const vpImage<unsigned char> &I)
 {
+  m_frame.setFrame(I, m_frame.getFrameIndex() + 1);
+  return track(m_frame);
+}
+
+/*!
+  Detect the face in the frame and track it on the level of the pyramid of the frame shared with
+  the other trackers.
+  \param frame : Context of the current frame.
+  \return true if a face is found.
+  */
+bool vpFaceTracker::track(vpFrameContext &frame)
+{
+  const vpImage<unsigned char> &I = frame.getImage();
+  const vpImage<unsigned char> &J = frame.getLevel(m_templateLevel);
   vpImageConvert::convert(I, m_frame_gray);
 
 
@@ -75,15 +115,14 @@ bool vpFaceTracker::track(const vpImage<unsigned char> &I)
     corners.push_back( vpImagePoint(y+(1-scale)*height, x+scale*width) );
     try {
       m_tracker->resetTracker();
-      m_tracker->initFromPoints(I, corners, true);
-      m_tracker->track(I);
+      m_tracker->initFromPoints(J, vpFrameContext::pyramidDown(corners, m_templateLevel), true);
+      const vpImage<unsigned char> &B = frame.getBlurredLevel(m_templateLevel);
+      m_tracker->track(B);
       //m_tracker->display(I, vpColor::green);
       m_zone_ref = m_tracker->getZoneRef();
-      m_area_zone_ref = m_zone_ref.getArea();
       m_p = m_tracker->getp();
       m_warp.warpZone(m_zone_ref, m_p, m_zone_cur);
-      m_area_zone_prev = m_area_zone_cur = m_zone_cur.getArea();
-      m_state = tracking;
+      m_state = m_quality.update(*m_tracker, m_zone_ref, m_zone_cur) ? tracking : detection;
     }
     catch(...) {
       std::cout << "Exception init tracking" << std::endl;
@@ -93,29 +132,25 @@ bool vpFaceTracker::track(const vpImage<unsigned char> &I)
   else if (m_state == tracking) {
     try {
       //vpDisplay::displayText(I, 10,10, "state: tracking", vpColor::red);
-      m_tracker->track(I);
+      const vpImage<unsigned char> &B = frame.getBlurredLevel(m_templateLevel);
+      m_tracker->track(B);
 
       //m_tracker->display(I, vpColor::blue);
       {
         // Instantiate and get the reference zone
         m_p = m_tracker->getp();
         m_warp.warpZone(m_zone_ref, m_p, m_zone_cur);
-        m_area_zone_cur = m_zone_cur.getArea();
 
-        //          std::cout << "Area ref: " << m_area_zone_ref << std::endl;
-        //std::cout << "Area tracked: " << m_area_zone_cur << std::endl;
-
-        double size_percent = 0.6;
-        if (m_area_zone_cur/m_area_zone_prev < size_percent || m_area_zone_cur/m_area_zone_prev > (1+size_percent)) {
-          //std::cout << "reinit caused by size" << std::endl;
+        if (! m_quality.update(*m_tracker, m_zone_ref, m_zone_cur)) {
+          //std::cout << "reinit caused by the tracking quality" << std::endl;
           m_state = detection;
         }
         else {
-          m_target = m_zone_cur.getBoundingBox();
+          const vpRect bbox = m_zone_cur.getBoundingBox();
+          const double scale = (double)(1 << m_templateLevel);
+          m_target.set(scale * bbox.getLeft(), scale * bbox.getTop(), scale * bbox.getWidth(), scale * bbox.getHeight());
           target_found = true;
         }
-
-        m_area_zone_prev = m_area_zone_cur;
       }
     }
     catch(...) {
@@ -5,9 +5,13 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
-#include <visp/vpTemplateTrackerSSDInverseCompositional.h>
 #include <visp/vpTemplateTrackerWarpSRT.h>
 
+#include <vpFrameContext.h>
+#include <vpMotionPredictor.h>
+#include <vpTemplateTrackerResidual.h>
+#include <vpTrackingQuality.h>
+
 
 class vpFaceTracker
 {
@@ -19,15 +23,17 @@ protected:
     none
   } state_t;
   vpTemplateTrackerWarpSRT m_warp;
-  vpTemplateTrackerSSDInverseCompositional *m_tracker;
+  vpTemplateTrackerResidual *m_tracker;
   std::vector<cv::Rect> m_faces;
   state_t m_state;
   cv::CascadeClassifier m_face_cascade;
   cv::Mat m_frame_gray;
   vpTemplateTrackerZone m_zone_ref, m_zone_cur;
-  double m_area_zone_ref, m_area_zone_cur, m_area_zone_prev;
   vpColVector m_p;
   vpRect m_target;
+  vpFrameContext m_frame; // Context of the frames given without one to track()
+  unsigned int m_templateLevel; // Level of the pyramid where the template is tracked
+  vpTrackingQuality m_quality; // Quality of the template tracking, that decides when the face is lost
 
 
 public:
@@ -35,8 +41,16 @@ public:
   ~vpFaceTracker();
 
   vpRect getFace() const { return m_target;}
+
+  /*!
+    Quality of the tracking of the face in the last frame, with its thresholds and the histogram
+    of its scores.
+    */
+  vpTrackingQuality &getTrackingQuality() { return m_quality; }
+  void predictMotion(const vpMotionPredictor &predictor, const vpCameraParameters &cam, const double &Z=1.0);
   void setFaceCascade(const std::string &filename);
   bool track(const vpImage<unsigned char> &I);
+  bool track(vpFrameContext &frame);
 };
 
 #endif
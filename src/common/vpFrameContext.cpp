@@ -0,0 +1,144 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Gaussian pyramid of a frame, built once for all the trackers.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include <visp/vpException.h>
+#include <visp/vpImageFilter.h>
+
+#include <vpFrameContext.h>
+
+/*!
+  Default constructor, without frame.
+ */
+vpFrameContext::vpFrameContext()
+  : m_I(NULL), m_index(0), m_nbLevels(0), m_nbLevelBuilds(0), m_blurBuffer(), m_nbBlurs(0)
+{
+  vpImageFilter::getGaussianKernel(m_blurKernel, blurSize);
+  for (unsigned int l = 0; l <= maxLevels; l++)
+    m_isBlurred[l] = false;
+}
+
+/*!
+  Level of the pyramid of the frame blurred as vpTemplateTrackerSSDInverseCompositional::track()
+  blurs its image, the first time it is asked for the frame.
+  \param level : Level, 0 being the frame itself.
+ */
+const vpImage<unsigned char> &vpFrameContext::getBlurredLevel(unsigned int level)
+{
+  const vpImage<unsigned char> &I = getLevel(level);
+  if (! m_isBlurred[level]) {
+    vpImageFilter::filter(I, m_blurBuffer, m_blurKernel, blurSize);
+    vpImage<unsigned char> &B = m_blurred[level];
+    B.resize(I.getHeight(), I.getWidth());
+    for (unsigned int k = 0; k < B.getSize(); k++)
+      B.bitmap[k] = (unsigned char)(std::min(255., std::max(0., m_blurBuffer.bitmap[k])) + 0.5);
+    m_isBlurred[level] = true;
+    m_nbBlurs++;
+  }
+  return m_blurred[level];
+}
+
+/*!
+  Frame given to setFrame().
+ */
+const vpImage<unsigned char> &vpFrameContext::getImage() const
+{
+  if (m_I == NULL)
+    throw vpException(vpException::notInitialized, "No frame in the context");
+  return *m_I;
+}
+
+/*!
+  Level of the pyramid of the frame, built with the lower levels the first time it is asked for
+  the frame.
+  \param level : Level, 0 being the frame itself.
+ */
+const vpImage<unsigned char> &vpFrameContext::getLevel(unsigned int level)
+{
+  if (level > maxLevels)
+    throw vpException(vpException::dimensionError, "Cannot build the level %d of the pyramid: at most %d levels are supported",
+                      (int)level, (int)maxLevels);
+  if (level == 0)
+    return getImage();
+
+  for (unsigned int l = m_nbLevels + 1; l <= level; l++) {
+    vpImageFilter::getGaussPyramidal(l == 1 ? getImage() : m_levels[l - 2], m_levels[l - 1]);
+    m_nbLevels = l;
+    m_nbLevelBuilds++;
+  }
+  return m_levels[level - 1];
+}
+
+/*!
+  Set the frame of the trackers. The levels already built or blurred are kept when \e index is the index
+  of the current frame, otherwise they are built again when asked.
+  \param I : Frame, that has to exist as long as the context is used with it.
+  \param index : Index of the frame, different from the one of the previous frame.
+ */
+void vpFrameContext::setFrame(const vpImage<unsigned char> &I, const unsigned long &index)
+{
+  if (m_I == NULL || index != m_index) {
+    m_nbLevels = 0;
+    for (unsigned int l = 0; l <= maxLevels; l++)
+      m_isBlurred[l] = false;
+  }
+  m_I = &I;
+  m_index = index;
+}
+
+/*!
+  Coordinates in the level \e level of points of the frame.
+ */
+std::vector<vpImagePoint> vpFrameContext::pyramidDown(const std::vector<vpImagePoint> &points, unsigned int level)
+{
+  const double scale = 1. / (1 << level);
+  std::vector<vpImagePoint> points_level(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+    points_level[i].set_uv(points[i].get_u() * scale, points[i].get_v() * scale);
+  return points_level;
+}
+
+/*!
+  Coordinates in the frame of points of the level \e level.
+ */
+std::vector<vpImagePoint> vpFrameContext::pyramidUp(const std::vector<vpImagePoint> &points, unsigned int level)
+{
+  const double scale = (double)(1 << level);
+  std::vector<vpImagePoint> points_frame(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+    points_frame[i].set_uv(points[i].get_u() * scale, points[i].get_v() * scale);
+  return points_frame;
+}
@@ -0,0 +1,121 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Gaussian pyramid of a frame, built once for all the trackers.
+ *
+ *****************************************************************************/
+#ifndef __vpFrameContext_h__
+#define __vpFrameContext_h__
+
+#include <vector>
+
+#include <visp/vpImage.h>
+#include <visp/vpImagePoint.h>
+
+/*!
+  Frame shared by the trackers of a loop, with its Gaussian pyramid built on demand.
+
+  vpFaceTracker, vpQRCodeTracker and vpTemplateLocatization track their template on the level 1
+  of the pyramid of the frame. When they all get the same context, the level is blurred and
+  decimated once per frame instead of once per tracker. The levels are kept until the frame
+  index given to setFrame() changes, and their buffers are reused from a frame to the next.
+  The level l is the image decimated l times by vpImageFilter::getGaussPyramidal(), a point
+  (u, v) of the level l being (u 2^l, v 2^l) in the frame.
+
+  vpTemplateTrackerSSDInverseCompositional also blurs the image given to each call of track()
+  with a Gaussian kernel of blurSize coefficients. getBlurredLevel() gives this blurred level once
+  per frame, so that the trackers of the context call setBlur(false) and track it directly. The
+  template is still initialized on getLevel(), as the tracker does not blur it. The blurred
+  level is rounded to unsigned char, that is at most half a gray level from the image the
+  tracker blurs itself.
+
+  The frame is not copied and has to exist as long as the context is used with it. A context is
+  not protected for a use by several threads.
+
+  \code
+  vpFrameContext frame;
+  unsigned long index = 0;
+  while (1) {
+    g.acquire(I);
+    frame.setFrame(I, index++);
+    face_tracker.track(frame);
+    qrcode_tracker.track(frame);
+  }
+  \endcode
+ */
+class vpFrameContext
+{
+public:
+  static const unsigned int maxLevels = 4; //!< Largest level of the pyramid
+  static const unsigned int blurSize = 7; //!< Size of the Gaussian kernel of vpTemplateTracker
+
+protected:
+  const vpImage<unsigned char> *m_I; //!< Frame, not owned
+  unsigned long m_index; //!< Index of the frame
+  unsigned int m_nbLevels; //!< Number of levels built for the frame
+  vpImage<unsigned char> m_levels[maxLevels]; //!< Levels 1 to maxLevels
+  unsigned long m_nbLevelBuilds; //!< Number of levels built since the construction
+  double m_blurKernel[blurSize]; //!< Gaussian kernel of vpTemplateTracker
+  bool m_isBlurred[maxLevels + 1]; //!< Levels 0 to maxLevels blurred for the frame
+  vpImage<unsigned char> m_blurred[maxLevels + 1]; //!< Blurred levels 0 to maxLevels
+  vpImage<double> m_blurBuffer; //!< Blurred level before its rounding
+  unsigned long m_nbBlurs; //!< Number of levels blurred since the construction
+
+public:
+  vpFrameContext();
+  virtual ~vpFrameContext() {}
+
+  const vpImage<unsigned char> &getBlurredLevel(unsigned int level);
+  const vpImage<unsigned char> &getImage() const;
+
+  /*!
+    Index of the frame given to setFrame().
+    */
+  unsigned long getFrameIndex() const { return m_index; }
+  const vpImage<unsigned char> &getLevel(unsigned int level);
+
+  /*!
+    Number of levels blurred and decimated since the construction, for all the frames.
+    */
+  unsigned long getNbLevelBuilds() const { return m_nbLevelBuilds; }
+
+  /*!
+    Number of levels blurred by getBlurredLevel() since the construction, for all the frames.
+    */
+  unsigned long getNbBlurs() const { return m_nbBlurs; }
+  bool hasFrame() const { return m_I != NULL; }
+  void setFrame(const vpImage<unsigned char> &I, const unsigned long &index);
+
+  static std::vector<vpImagePoint> pyramidDown(const std::vector<vpImagePoint> &points, unsigned int level);
+  static std::vector<vpImagePoint> pyramidUp(const std::vector<vpImagePoint> &points, unsigned int level);
+};
+
+#endif
@@ -40,6 +40,8 @@
  *
  *****************************************************************************/
 
+#include <visp/vpTime.h>
+
 # include <vpMbLocalization.h>
 
 
@@ -50,7 +52,8 @@
   */
 vpMbLocalization::vpMbLocalization(const std::string &model, const std::string &configuration_file_folder, const vpCameraParameters &cam)
   : m_tracker(NULL), m_keypoint_learning(NULL), m_keypoint_detection (NULL), m_init_detection (false),m_state(detection),
-    m_num_iteration_detection(6), m_counter_detection(0), m_manual_detection (0), m_checkValiditycMo(NULL), m_only_detection(false), m_status_single_detection(false)
+    m_num_iteration_detection(6), m_counter_detection(0), m_manual_detection (0), m_checkValiditycMo(NULL), m_only_detection(false), m_status_single_detection(false),
+    m_poseFilter(), m_filterPose(false), m_frameTime(-1)
 
 {
   m_model = model;
@@ -176,6 +179,43 @@ bool vpMbLocalization::isIdentity(const vpHomogeneousMatrix & A) const
 
 }
 
+/*!
+  Filter the pose with getPoseFilter() at each frame where the object is tracked, with the
+  covariance computed by the model-based tracker. Disabled by default.
+ */
+void vpMbLocalization::setPoseFiltering(const bool &enable)
+{
+  m_filterPose = enable;
+  m_tracker->setCovarianceComputation(enable);
+  if (!enable)
+    m_poseFilter.reset();
+}
+
+/*!
+  Move the tracked object by the motion of the camera and of the object predicted from the joints
+  of the robot, so that the next track() starts from the predicted pose. Nothing is done when the
+  object is not tracked.
+  \param I : Image that will be given to track().
+  \param predictor : Camera and object displacements since the last call to track().
+ */
+void vpMbLocalization::predictMotion(const vpImage<unsigned char> &I, const vpMotionPredictor &predictor)
+{
+  if (m_state != tracking)
+    return;
+
+  try
+  {
+    vpHomogeneousMatrix cMo = predictor.predict(m_cMo);
+    m_tracker->setPose(I, cMo);
+    m_cMo = cMo;
+  }
+  catch(vpException &e)
+  {
+    std::cout << "Catch an exception: " << e.getMessage() << std::endl;
+    m_state = detection;
+  }
+}
+
 /*!
   This function will detect and track an object. If the tracking fails the algorithm will try to detect again the box.
   \param I : Image to process.
@@ -325,6 +365,10 @@ bool vpMbLocalization::track(const vpImage<unsigned char> &I)
     {
       m_tracker->track(I);
       m_tracker->getPose(m_cMo);
+      // Time of the frame, the pose being computed after its processing
+      if (m_filterPose)
+        m_poseFilter.update(m_cMo, m_tracker->getCovarianceMatrix(), m_frameTime >= 0 ? m_frameTime : vpTime::measureTimeMs());
+      m_frameTime = -1;
       //printPose("cMo teabox: ", cMo_teabox);
       //if (!m_checkValiditycMo(m_cMo))
       // std::cout << "OK";
@@ -52,6 +52,9 @@
 #include <visp/vpImage.h>
 #include <visp/vpIoTools.h>
 
+#include <vpMotionPredictor.h>
+#include <vpPoseFilter.h>
+
 
 /*!
   This class allows to learn, detect and track an object. We use keypoints to detect and estimate the pose of a known object
@@ -97,6 +100,9 @@ protected:
   unsigned int m_num_iteration_detection;
   vpMatrix m_stack_cMo_detection;
   bool (*m_checkValiditycMo)(vpHomogeneousMatrix);
+  vpPoseFilter m_poseFilter; // Filtered pose, updated when m_filterPose is set
+  bool m_filterPose;
+  double m_frameTime; // Time given to setFrameTime(), negative when none
 
 
 public:
@@ -107,6 +113,7 @@ public:
   bool detectObject(vpImage<unsigned char> &I, vpHomogeneousMatrix &cMo);
 
   vpHomogeneousMatrix get_cMo() const {return m_cMo;}
+  vpPoseFilter &getPoseFilter() { return m_poseFilter; }
   vpMbEdgeKltTracker * getTracker() const {return m_tracker;}
   //vpMbKltTracker * getTracker() const {return m_tracker;}
   vpImagePoint get_cog() const {return m_cog;}
@@ -114,11 +121,14 @@ public:
   void initDetection(const std::string & name_file_learning_data);
   bool isIdentity (const vpHomogeneousMatrix &A) const;
   void learnObject(vpImage<unsigned char> &I);
+  void predictMotion(const vpImage<unsigned char> &I, const vpMotionPredictor &predictor);
   void saveLearningData(const std::string & name_new_file_learning_data);
   void setForceDetection() {m_state = detection; }
+  void setFrameTime(const double &time) { m_frameTime = time; }
   void setCameraParameters(const vpCameraParameters &cam) { m_cam = cam; }
   void setManualDetection(){m_manual_detection = true;}
   void setOnlyDetection(const bool only_detection){m_only_detection = only_detection;}
+  void setPoseFiltering(const bool &enable);
   void setNumberDetectionIteration (unsigned int &num) { m_num_iteration_detection = num;}
   void setValiditycMoFunction (bool (*funct)(vpHomogeneousMatrix)) { m_checkValiditycMo = funct;}
   bool track(const vpImage<unsigned char> &I);
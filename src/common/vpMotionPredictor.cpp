@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Prediction of the motion of a target from the motion of the robot joints.
+ *
+ *****************************************************************************/
+
+#include <visp/vpException.h>
+#include <visp/vpExponentialMap.h>
+#include <visp/vpMeterPixelConversion.h>
+#include <visp/vpPixelMeterConversion.h>
+#include <visp/vpVelocityTwistMatrix.h>
+
+#include <vpMotionPredictor.h>
+
+/*!
+  Default constructor, without any motion.
+ */
+vpMotionPredictor::vpMotionPredictor()
+  : m_cMc(), m_oMo()
+{
+}
+
+/*!
+  Predict the pose of the target in the next frame.
+  \param cMo : Pose of the target in the previous frame.
+  \return Pose of the target once the camera and the target moved.
+ */
+vpHomogeneousMatrix vpMotionPredictor::predict(const vpHomogeneousMatrix &cMo) const
+{
+  return m_cMc.inverse() * cMo * m_oMo;
+}
+
+/*!
+  Predict the location in the next frame of a point that does not move, like a face, when only
+  its location in the image and an approximate depth are known. The target motion is not used.
+  \param cam : Camera parameters.
+  \param ip : Location of the point in the previous frame.
+  \param Z : Depth of the point in the previous camera frame, in meter.
+  \return Location of the point once the camera moved, or \e ip if the point goes behind the camera.
+ */
+vpImagePoint vpMotionPredictor::predict(const vpCameraParameters &cam, const vpImagePoint &ip, const double &Z) const
+{
+  double x, y;
+  vpPixelMeterConversion::convertPoint(cam, ip, x, y);
+  const double cP[3] = {x * Z, y * Z, Z};
+
+  vpHomogeneousMatrix cMc = m_cMc.inverse();
+  double X[3];
+  for (unsigned int i = 0; i < 3; i++)
+    X[i] = cMc[i][0] * cP[0] + cMc[i][1] * cP[1] + cMc[i][2] * cP[2] + cMc[i][3];
+  if (X[2] <= 0)
+    return ip;
+
+  vpImagePoint predicted;
+  vpMeterPixelConversion::convertPoint(cam, X[0] / X[2], X[1] / X[2], predicted);
+  return predicted;
+}
+
+/*!
+  Remove the camera and the target motions.
+ */
+void vpMotionPredictor::reset()
+{
+  m_cMc.eye();
+  m_oMo.eye();
+}
+
+/*!
+  Set the displacement of the camera between the two frames.
+  \param eMc : Pose of the camera in the end-effector frame of the head chain.
+  \param eJe : Jacobian of the head chain, expressed in its end-effector frame.
+  \param dq : Displacement of the joints of the head chain.
+ */
+void vpMotionPredictor::setCameraMotion(const vpHomogeneousMatrix &eMc, const vpMatrix &eJe, const vpColVector &dq)
+{
+  if (eJe.getRows() != 6 || eJe.getCols() != dq.getRows())
+    throw vpException(vpException::dimensionError, "Cannot predict the camera motion from a %dx%d Jacobian and %d joints",
+                      (int)eJe.getRows(), (int)eJe.getCols(), (int)dq.getRows());
+
+  // Displacement of the end-effector expressed in the camera frame
+  vpColVector v = vpVelocityTwistMatrix(eMc.inverse()) * (eJe * dq);
+  m_cMc = vpExponentialMap::direct(v);
+}
+
+/*!
+  Set the displacement between the two frames of a target held by the robot.
+  \param oMe : Pose of the end-effector of the arm in the target frame.
+  \param eJe : Jacobian of the arm, expressed in its end-effector frame.
+  \param dq : Displacement of the joints of the arm.
+ */
+void vpMotionPredictor::setTargetMotion(const vpHomogeneousMatrix &oMe, const vpMatrix &eJe, const vpColVector &dq)
+{
+  if (eJe.getRows() != 6 || eJe.getCols() != dq.getRows())
+    throw vpException(vpException::dimensionError, "Cannot predict the target motion from a %dx%d Jacobian and %d joints",
+                      (int)eJe.getRows(), (int)eJe.getCols(), (int)dq.getRows());
+
+  // Displacement of the end-effector expressed in the target frame
+  vpColVector v = vpVelocityTwistMatrix(oMe) * (eJe * dq);
+  m_oMo = vpExponentialMap::direct(v);
+}
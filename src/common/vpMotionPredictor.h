@@ -0,0 +1,83 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Prediction of the motion of a target from the motion of the robot joints.
+ *
+ *****************************************************************************/
+#ifndef __vpMotionPredictor_h__
+#define __vpMotionPredictor_h__
+
+#include <visp/vpCameraParameters.h>
+#include <visp/vpColVector.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpImagePoint.h>
+#include <visp/vpMatrix.h>
+
+/*!
+  Predict where a target is seen in the next frame from the joint displacements of the robot
+  between the two frames.
+
+  The camera displacement is given by the joints of the head and the eyes, and the displacement
+  of a target held by the robot, like the hand targets, by the joints of the arm. The Jacobians
+  are the ones given by vpNaoqiRobot::get_eJe(), expressed in the end-effector frame. Both
+  displacements are applied to the pose of the target in the previous frame.
+
+  \code
+  vpMotionPredictor predictor;
+  predictor.setCameraMotion(eMc, robot.get_eJe("LEye") * MAP_head, q_head - q_head_prev);
+  predictor.setTargetMotion(oMe_arm, robot.get_eJe("LArm"), q_arm - q_arm_prev);
+  hand_tracker.predictMotion(predictor);
+  hand_tracker.track(cvI, I);
+  \endcode
+ */
+class vpMotionPredictor
+{
+protected:
+  vpHomogeneousMatrix m_cMc; //!< Pose of the camera in the frame of the previous camera
+  vpHomogeneousMatrix m_oMo; //!< Pose of the target in the frame of the previous target
+
+public:
+  vpMotionPredictor();
+  virtual ~vpMotionPredictor() {}
+
+  vpHomogeneousMatrix getCameraDisplacement() const { return m_cMc; }
+  vpHomogeneousMatrix getTargetDisplacement() const { return m_oMo; }
+
+  vpHomogeneousMatrix predict(const vpHomogeneousMatrix &cMo) const;
+  vpImagePoint predict(const vpCameraParameters &cam, const vpImagePoint &ip, const double &Z) const;
+
+  void reset();
+  void resetTargetMotion() { m_oMo.eye(); }
+  void setCameraMotion(const vpHomogeneousMatrix &eMc, const vpMatrix &eJe, const vpColVector &dq);
+  void setTargetMotion(const vpHomogeneousMatrix &oMe, const vpMatrix &eJe, const vpColVector &dq);
+};
+
+#endif
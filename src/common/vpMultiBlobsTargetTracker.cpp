@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tracking of several blob targets with a single segmentation of the image.
+ *
+ *****************************************************************************/
+
+#include <visp/vpException.h>
+
+#include <vpMultiBlobsTargetTracker.h>
+
+/*!
+  Default constructor, without any target.
+ */
+vpMultiBlobsTargetTracker::vpMultiBlobsTargetTracker()
+  : m_targets(), m_active(), m_status(), m_classifier(), m_labels(), m_components(), m_sharedLabeling(true)
+{
+}
+
+/*!
+  Add a target, set up with its name, HSV range, points and camera parameters. The target is not
+  copied and has to exist as long as it is tracked.
+  \param target : Target with a name that is not already used.
+  \return The index of the target.
+ */
+unsigned int vpMultiBlobsTargetTracker::addTarget(vpBlobsTargetTracker &target)
+{
+  if (m_targets.size() >= vpBlobsTargetTracker::maxTrackers)
+    throw vpException(vpException::dimensionError, "Cannot add the target %s: at most %d targets are supported",
+                      target.m_name.c_str(), (int)vpBlobsTargetTracker::maxTrackers);
+  if (getTargetIndex(target.m_name) >= 0)
+    throw vpException(vpException::badValue, "A target named %s is already tracked", target.m_name.c_str());
+
+  std::vector<int> values = target.m_colBlob.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+  const int hsv_min[3] = {values[0], values[2], values[4]};
+  const int hsv_max[3] = {values[1], values[3], values[5]};
+  m_classifier.addProfile(target.m_name, hsv_min, hsv_max);
+
+  m_targets.push_back(&target);
+  m_active.push_back(true);
+  m_status.push_back(false);
+  return m_targets.size() - 1;
+}
+
+/*!
+  Return the index of the target with the given name, -1 if there is none.
+ */
+int vpMultiBlobsTargetTracker::getTargetIndex(const std::string &name) const
+{
+  for (size_t t = 0; t < m_targets.size(); t++) {
+    if (m_targets[t]->m_name == name)
+      return (int)t;
+  }
+  return -1;
+}
+
+/*!
+  Give to the classifier the HSV range of a target, that may have been loaded again since the
+  target was added. The lookup table of the classifier is only rebuilt when the range changed.
+ */
+void vpMultiBlobsTargetTracker::updateProfile(unsigned int index)
+{
+  std::vector<int> values = m_targets[index]->m_colBlob.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+  const int hsv_min[3] = {values[0], values[2], values[4]};
+  const int hsv_max[3] = {values[1], values[3], values[5]};
+  int current_min[3], current_max[3];
+  m_classifier.getValuesHSV(index, current_min, current_max);
+  for (int c = 0; c < 3; c++) {
+    if (hsv_min[c] != current_min[c] || hsv_max[c] != current_max[c]) {
+      m_classifier.setValuesHSV(index, hsv_min, hsv_max);
+      return;
+    }
+  }
+}
+
+/*!
+  Detect and track the active targets. The targets to detect share the segmentation of the
+  image, then they are processed one after the other, and the blobs of the targets in the
+  tracking state are tracked together in parallel. The results are the same as when each
+  target is tracked with vpBlobsTargetTracker::track().
+  \param cvI : Color image, used to detect the colored blobs.
+  \param I : Gray level image of the same frame, used to track the blobs.
+  \return true if all the active targets are tracked. The status of each target is given by getStatus().
+ */
+bool vpMultiBlobsTargetTracker::track(const cv::Mat &cvI, const vpImage<unsigned char> &I)
+{
+  const unsigned int nb = m_targets.size();
+  m_status.assign(nb, false);
+
+  // Targets whose colored blob is searched in this frame
+  bool detect[vpBlobsTargetTracker::maxTrackers];
+  bool obj_found[vpBlobsTargetTracker::maxTrackers];
+  vpBlobsTargetTracker *reference = NULL; // First target classified, whose morphological operations are shared
+  bool shared = m_sharedLabeling;
+  for (unsigned int t = 0; t < nb; t++) {
+    vpBlobsTargetTracker *target = m_targets[t];
+    detect[t] = m_active[t] && (target->m_state == vpBlobsTargetTracker::detection || target->m_force_detection)
+        && !target->m_manual_blob_init && !target->m_full_manual;
+    obj_found[t] = false;
+    if (detect[t] && !target->m_adaptiveColor) {
+      updateProfile(t);
+      if (reference == NULL)
+        reference = target;
+      else if (target->m_colBlob.getLevelMorphOps() != reference->m_colBlob.getLevelMorphOps())
+        shared = false;
+    }
+  }
+
+  // One classification, filtering and labeling of the image for all these targets
+  if (reference != NULL) {
+    m_classifier.classify(cvI, m_labels);
+    if (shared) {
+      reference->m_colBlob.morphLabels(m_labels);
+      m_components.labelValues(m_labels);
+    }
+  }
+
+  for (unsigned int t = 0; t < nb; t++) {
+    if (!detect[t])
+      continue;
+    vpColorDetection &detector = m_targets[t]->m_colBlob;
+    if (m_targets[t]->m_adaptiveColor)
+      obj_found[t] = detector.detect(cvI);
+    else if (shared)
+      obj_found[t] = detector.detect(m_labels, m_components, t);
+    else
+      obj_found[t] = detector.detect(m_labels, t);
+  }
+
+  // The targets to detect are processed first, then the blobs of the tracked ones together
+  vpBlobsTargetTracker *batch[vpBlobsTargetTracker::maxTrackers];
+  const vpImage<unsigned char> *batch_I[vpBlobsTargetTracker::maxTrackers];
+  unsigned int batch_index[vpBlobsTargetTracker::maxTrackers];
+  unsigned int batch_size = 0;
+  for (unsigned int t = 0; t < nb; t++) {
+    vpBlobsTargetTracker *target = m_targets[t];
+    if (!m_active[t])
+      continue;
+    if (target->m_state == vpBlobsTargetTracker::tracking && !target->m_force_detection) {
+      batch[batch_size] = target;
+      batch_I[batch_size] = &I;
+      batch_index[batch_size] = t;
+      batch_size++;
+    }
+    else {
+      m_status[t] = target->trackBlobs(I, obj_found[t]);
+      if (m_status[t])
+        target->updateColorModel(cvI);
+    }
+  }
+
+  vpBlobsTargetTracker::trackBlobsInParallel(batch, batch_I, batch_size);
+
+  for (unsigned int k = 0; k < batch_size; k++) {
+    const unsigned int t = batch_index[k];
+    m_status[t] = batch[k]->m_target_found;
+    if (m_status[t])
+      batch[k]->updateColorModel(cvI);
+  }
+
+  bool all_tracked = true;
+  for (unsigned int t = 0; t < nb; t++) {
+    if (m_active[t] && !m_status[t])
+      all_tracked = false;
+  }
+  return all_tracked;
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tracking of several blob targets with a single segmentation of the image.
+ *
+ *****************************************************************************/
+#ifndef __vpMultiBlobsTargetTracker_h__
+#define __vpMultiBlobsTargetTracker_h__
+
+#include <string>
+#include <vector>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <visp/vpImage.h>
+
+#include <vpBlobsTargetTracker.h>
+#include <vpConnectedComponents.h>
+#include <vpMultiColorClassifier.h>
+
+/*!
+  Track several vpBlobsTargetTracker in the same image, with a single segmentation per frame.
+
+  Each target keeps its own HSV range, points and tracking state, and is set up as usual before
+  being added with addTarget(). When some targets have to be detected, the image is classified
+  once against the HSV ranges of all the targets with vpMultiColorClassifier, the erosion and the
+  dilation are applied once to the label image for all the targets, and the label image is
+  labeled once with vpConnectedComponents::labelValues(). Each target then takes its components
+  from this labeling, so that the cost of the segmentation does not depend on the number of
+  targets. The targets in the tracking state only track their blobs, all together in parallel
+  as with vpBlobsTargetTracker::trackTargets().
+
+  The colored blobs found are the same as with vpBlobsTargetTracker::track(), except that the
+  whole image is searched: the pyramid level of vpBlobsTargetTracker::setPyramidLevelColor() is
+  not used. A target with an adaptive color model detects its colored blob alone.
+
+  \code
+  vpMultiBlobsTargetTracker trackers;
+  trackers.addTarget(hand_tracker_l);
+  trackers.addTarget(hand_tracker_r);
+  trackers.addTarget(pen_tracker);
+  while (1) {
+    ...
+    trackers.track(cvI, I);
+    if (trackers.getStatus(0))
+      cMo_hand_l = hand_tracker_l.get_cMo();
+  }
+  \endcode
+ */
+class vpMultiBlobsTargetTracker
+{
+protected:
+  std::vector<vpBlobsTargetTracker*> m_targets; //!< Targets, not owned
+  std::vector<bool> m_active; //!< Targets tracked by track()
+  std::vector<bool> m_status; //!< true for each target tracked in the last frame
+  vpMultiColorClassifier m_classifier; //!< HSV range of each target, with the index of the target
+  cv::Mat m_labels; //!< Label image of the frame
+  vpConnectedComponents m_components; //!< Components of m_labels
+  bool m_sharedLabeling; //!< Filter and label m_labels once for all the targets
+
+  void updateProfile(unsigned int index);
+
+public:
+  vpMultiBlobsTargetTracker();
+  virtual ~vpMultiBlobsTargetTracker() {}
+
+  unsigned int addTarget(vpBlobsTargetTracker &target);
+  unsigned int getNbTargets() const { return m_targets.size(); }
+  bool getStatus(unsigned int index) const { return m_status[index]; }
+  const std::vector<bool> &getStatus() const { return m_status; }
+  vpBlobsTargetTracker &getTarget(unsigned int index) { return *m_targets[index]; }
+  int getTargetIndex(const std::string &name) const;
+  bool isActive(unsigned int index) const { return m_active[index]; }
+
+  /*!
+    Choose if a target is tracked by track(). An inactive target keeps its state and is not
+    tracked until it is active again. All the targets are active when added.
+    */
+  void setActive(unsigned int index, const bool &active) { m_active[index] = active; }
+
+  /*!
+    Apply the erosion and the dilation, and label the components, once for all the targets.
+    When disabled, each target extracts its mask from the label image and labels it alone.
+    Enabled by default. The colored blobs found are the same in both cases.
+    */
+  void setSharedLabeling(const bool &enable) { m_sharedLabeling = enable; }
+
+  bool track(const cv::Mat &cvI, const vpImage<unsigned char> &I);
+};
+
+#endif
@@ -0,0 +1,264 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Classification of a BGR image against several HSV profiles in one pass.
+ *
+ *****************************************************************************/
+
+#include <fstream>
+#include <iostream>
+
+#include <visp/vpException.h>
+
+#include <vpMultiColorClassifier.h>
+#include <vpColorDetection.h>
+#include <vpColorThreshold.h>
+
+namespace {
+
+const int lut_bits = 6;
+const int lut_shift = 8 - lut_bits;
+const int lut_side = 1 << lut_bits;
+
+inline unsigned int lutIndex(const unsigned char *bgr)
+{
+  return ((bgr[0] >> lut_shift) << (2*lut_bits)) | ((bgr[1] >> lut_shift) << lut_bits) | (bgr[2] >> lut_shift);
+}
+
+}
+
+/*!
+  Default constructor, without any profile.
+ */
+vpMultiColorClassifier::vpMultiColorClassifier()
+  : m_profiles(), m_lut(), m_lut_ready(false)
+{
+}
+
+/*!
+  Add an HSV profile.
+  \param name : Name of the profile.
+  \param hsv_min : Lower bounds H, S, V (inclusive).
+  \param hsv_max : Upper bounds H, S, V (inclusive).
+  \return The index of the profile, that is the bit set in the label image.
+ */
+unsigned int vpMultiColorClassifier::addProfile(const std::string &name, const int hsv_min[3], const int hsv_max[3])
+{
+  if (m_profiles.size() >= maxProfiles)
+    throw vpException(vpException::dimensionError, "Cannot add the color profile %s: at most %d profiles are supported",
+                      name.c_str(), maxProfiles);
+
+  vpHSVProfile profile;
+  profile.name = name;
+  for (int c = 0; c < 3; c++) {
+    profile.hsv_min[c] = hsv_min[c];
+    profile.hsv_max[c] = hsv_max[c];
+  }
+  m_profiles.push_back(profile);
+  m_lut_ready = false;
+
+  return m_profiles.size() - 1;
+}
+
+/*!
+  Add the HSV profile of a color detector, with the same name.
+  \return The index of the profile, to pass to vpColorDetection::detect(const cv::Mat &, unsigned int).
+ */
+unsigned int vpMultiColorClassifier::addProfile(vpColorDetection &detector)
+{
+  std::vector<int> values = detector.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+  const int hsv_min[3] = {values[0], values[2], values[4]};
+  const int hsv_max[3] = {values[1], values[3], values[5]};
+  return addProfile(detector.getName(), hsv_min, hsv_max);
+}
+
+/*!
+  Remove all the profiles.
+ */
+void vpMultiColorClassifier::clear()
+{
+  m_profiles.clear();
+  m_lut_ready = false;
+}
+
+/*!
+  Return the index of the profile with the given name, -1 if there is none.
+ */
+int vpMultiColorClassifier::getProfileIndex(const std::string &name) const
+{
+  for (size_t i = 0; i < m_profiles.size(); i++) {
+    if (m_profiles[i].name == name)
+      return (int)i;
+  }
+  return -1;
+}
+
+/*!
+  Get the HSV range of a profile.
+ */
+void vpMultiColorClassifier::getValuesHSV(unsigned int index, int hsv_min[3], int hsv_max[3]) const
+{
+  for (int c = 0; c < 3; c++) {
+    hsv_min[c] = m_profiles[index].hsv_min[c];
+    hsv_max[c] = m_profiles[index].hsv_max[c];
+  }
+}
+
+/*!
+  Load all the profiles of a file, one per line with the format used by vpColorDetection::saveHSV():
+  name H_min H_max S_min S_max V_min V_max
+  \return The number of profiles read.
+ */
+unsigned int vpMultiColorClassifier::loadProfiles(const std::string &filename)
+{
+  std::ifstream filein(filename.c_str(), std::ios_base::in);
+  if (!filein)
+  {
+    std::cerr << "ERROR: cannot open the file " << filename << std::endl;
+    return 0;
+  }
+
+  unsigned int nb = 0;
+  std::string name;
+  int hsv_min[3], hsv_max[3];
+  while (filein >> name >> hsv_min[0] >> hsv_max[0] >> hsv_min[1] >> hsv_max[1] >> hsv_min[2] >> hsv_max[2]) {
+    addProfile(name, hsv_min, hsv_max);
+    nb++;
+  }
+
+  filein.close();
+  return nb;
+}
+
+/*!
+  Change the HSV range of a profile. The lookup table is rebuilt on the next call to classify().
+ */
+void vpMultiColorClassifier::setValuesHSV(unsigned int index, const int hsv_min[3], const int hsv_max[3])
+{
+  for (int c = 0; c < 3; c++) {
+    m_profiles[index].hsv_min[c] = hsv_min[c];
+    m_profiles[index].hsv_max[c] = hsv_max[c];
+  }
+  m_lut_ready = false;
+}
+
+/*!
+  Compile all the profiles in the lookup table. Each bin covers 4x4x4 BGR colors.
+ */
+void vpMultiColorClassifier::buildLut()
+{
+  const int bin = 1 << lut_shift;
+  m_lut.assign(lut_side*lut_side*lut_side, 0);
+
+  unsigned char bgr[3];
+  for (int b = 0; b < lut_side; b++) {
+    for (int g = 0; g < lut_side; g++) {
+      for (int r = 0; r < lut_side; r++) {
+        unsigned int count[maxProfiles] = {0};
+        for (int db = 0; db < bin; db++) {
+          bgr[0] = (unsigned char)((b << lut_shift) + db);
+          for (int dg = 0; dg < bin; dg++) {
+            bgr[1] = (unsigned char)((g << lut_shift) + dg);
+            for (int dr = 0; dr < bin; dr++) {
+              bgr[2] = (unsigned char)((r << lut_shift) + dr);
+              for (size_t p = 0; p < m_profiles.size(); p++) {
+                if (vpColorThreshold::isInRangeHSV(bgr, m_profiles[p].hsv_min, m_profiles[p].hsv_max))
+                  count[p]++;
+              }
+            }
+          }
+        }
+
+        unsigned short entry = 0;
+        for (size_t p = 0; p < m_profiles.size(); p++) {
+          if (count[p] == (unsigned int)(bin*bin*bin))
+            entry |= (1 << p);
+          else if (count[p] > 0)
+            entry |= (1 << (p + 8));
+        }
+        m_lut[(b << (2*lut_bits)) | (g << lut_bits) | r] = entry;
+      }
+    }
+  }
+
+  m_lut_ready = true;
+}
+
+/*!
+  Classify a BGR image against all the profiles.
+  \param bgr : Input image of type CV_8UC3.
+  \param labels : Output image of type CV_8UC1 where bit \e i is set if the pixel is in the range of profile \e i.
+ */
+void vpMultiColorClassifier::classify(const cv::Mat &bgr, cv::Mat &labels)
+{
+  CV_Assert(bgr.type() == CV_8UC3);
+  if (!m_lut_ready)
+    buildLut();
+
+  labels.create(bgr.size(), CV_8UC1);
+  const unsigned short *lut = &m_lut[0];
+
+  for (int i = 0; i < bgr.rows; i++) {
+    const unsigned char *src = bgr.ptr<unsigned char>(i);
+    unsigned char *dst = labels.ptr<unsigned char>(i);
+    for (int j = 0; j < bgr.cols; j++, src += 3) {
+      unsigned short entry = lut[lutIndex(src)];
+      unsigned char label = (unsigned char)(entry & 0xFF);
+      unsigned int boundary = entry >> 8;
+      // Only the profiles whose boundary crosses the bin need an exact test
+      for (unsigned int p = 0; boundary; p++, boundary >>= 1) {
+        if ((boundary & 1) && vpColorThreshold::isInRangeHSV(src, m_profiles[p].hsv_min, m_profiles[p].hsv_max))
+          label |= (unsigned char)(1 << p);
+      }
+      dst[j] = label;
+    }
+  }
+}
+
+/*!
+  Extract the binary mask of one profile from a label image.
+  \param labels : Label image computed by classify().
+  \param index : Index of the profile.
+  \param mask : Output mask of type CV_8UC1, 255 where the pixel is in the range of the profile, 0 otherwise.
+ */
+void vpMultiColorClassifier::extractMask(const cv::Mat &labels, unsigned int index, cv::Mat &mask)
+{
+  CV_Assert(labels.type() == CV_8UC1);
+  mask.create(labels.size(), CV_8UC1);
+  const unsigned char bit = (unsigned char)(1 << index);
+
+  for (int i = 0; i < labels.rows; i++) {
+    const unsigned char *src = labels.ptr<unsigned char>(i);
+    unsigned char *dst = mask.ptr<unsigned char>(i);
+    for (int j = 0; j < labels.cols; j++)
+      dst[j] = (src[j] & bit) ? 255 : 0;
+  }
+}
@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Classification of a BGR image against several HSV profiles in one pass.
+ *
+ *****************************************************************************/
+#ifndef __vpMultiColorClassifier_h__
+#define __vpMultiColorClassifier_h__
+
+#include <string>
+#include <vector>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+class vpColorDetection;
+
+/*!
+  Classify a BGR image against several HSV profiles in a single pass.
+
+  All the profiles are compiled into a lookup table indexed by the BGR color quantised
+  on 6 bits per channel. Each entry holds one bit per profile for the bins entirely inside
+  the profile, and one bit per profile for the bins crossing its boundary. Only the pixels
+  falling in a boundary bin of a profile are tested exactly, so the cost per pixel does
+  not depend on the number of profiles and the result is bit-exact with vpColorThreshold.
+
+  classify() produces a label image where bit \e i is set if the pixel belongs to profile \e i.
+  Each vpColorDetection then consumes its own bit with vpColorDetection::detect(const cv::Mat &, unsigned int).
+
+  \code
+  vpMultiColorClassifier classifier;
+  unsigned int left = classifier.addProfile(detector_left);
+  unsigned int right = classifier.addProfile(detector_right);
+  cv::Mat labels;
+  classifier.classify(cvI, labels);
+  detector_left.detect(labels, left);
+  detector_right.detect(labels, right);
+  \endcode
+ */
+class vpMultiColorClassifier
+{
+public:
+  static const unsigned int maxProfiles = 8;
+
+protected:
+  struct vpHSVProfile {
+    std::string name;
+    int hsv_min[3];
+    int hsv_max[3];
+  };
+
+  std::vector<vpHSVProfile> m_profiles;
+  std::vector<unsigned short> m_lut; //!< Low byte: bins inside the profiles, high byte: bins crossing them
+  bool m_lut_ready;
+
+  void buildLut();
+
+public:
+  vpMultiColorClassifier();
+  virtual ~vpMultiColorClassifier() {}
+
+  unsigned int addProfile(const std::string &name, const int hsv_min[3], const int hsv_max[3]);
+  unsigned int addProfile(vpColorDetection &detector);
+  void classify(const cv::Mat &bgr, cv::Mat &labels);
+  void clear();
+  static void extractMask(const cv::Mat &labels, unsigned int index, cv::Mat &mask);
+  unsigned int getNbProfiles() const { return m_profiles.size(); }
+  int getProfileIndex(const std::string &name) const;
+  std::string getProfileName(unsigned int index) const { return m_profiles[index].name; }
+  void getValuesHSV(unsigned int index, int hsv_min[3], int hsv_max[3]) const;
+  unsigned int loadProfiles(const std::string &filename);
+  void setValuesHSV(unsigned int index, const int hsv_min[3], const int hsv_max[3]);
+};
+
+#endif
@@ -0,0 +1,299 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tracking of several qrcodes with a single decoding of the image.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <visp/vpException.h>
+
+#include <vpMultiQRCodeTracker.h>
+
+/*!
+  Default constructor, without any code.
+ */
+vpMultiQRCodeTracker::vpMultiQRCodeTracker()
+  : m_targets(), m_active(), m_status(), m_lastBBox(), m_lostFrames(), m_detector(), m_roi(), m_searchArea(),
+    m_verificationArea(), m_localSearchFrames(10), m_searchMargin(1.), m_nbDecodes(0), m_nbVerifications(0),
+    m_frame()
+{
+}
+
+/*!
+  Add a code, set up with its message, size and camera parameters. The tracker is not copied and
+  has to exist as long as it is tracked.
+  \param target : Tracker of a code whose message is not already tracked.
+  \return The index of the code.
+ */
+unsigned int vpMultiQRCodeTracker::addTarget(vpQRCodeTracker &target)
+{
+  if (getTargetIndex(target.m_message) >= 0)
+    throw vpException(vpException::badValue, "A code with the message %s is already tracked", target.m_message.c_str());
+
+  m_targets.push_back(&target);
+  m_active.push_back(true);
+  m_status.push_back(false);
+  m_lastBBox.push_back(vpRect());
+  m_lostFrames.push_back(UINT_MAX); // Never tracked, searched in the whole frame
+  return m_targets.size() - 1;
+}
+
+/*!
+  Return the index of the code with the given message, -1 if there is none.
+ */
+int vpMultiQRCodeTracker::getTargetIndex(const std::string &message) const
+{
+  for (size_t t = 0; t < m_targets.size(); t++) {
+    if (m_targets[t]->m_message == message)
+      return (int)t;
+  }
+  return -1;
+}
+
+/*!
+  Decode an area of the frame.
+  \param I : Frame.
+  \param area : Area to decode, inside the frame. The whole frame is decoded without copy, nothing
+  is decoded when the area is empty.
+  \param messages : Messages of the decoded codes.
+  \param polygons : Corners of the decoded codes, in the frame.
+ */
+void vpMultiQRCodeTracker::decode(const vpImage<unsigned char> &I, const vpRect &area, std::vector<std::string> &messages,
+                                  std::vector< std::vector<vpImagePoint> > &polygons)
+{
+  messages.clear();
+  polygons.clear();
+  if (area.getWidth() < 1 || area.getHeight() < 1)
+    return;
+  m_nbDecodes++;
+
+  const unsigned int left = (unsigned int)area.getLeft(), top = (unsigned int)area.getTop();
+  const unsigned int width = (unsigned int)area.getWidth(), height = (unsigned int)area.getHeight();
+  bool found;
+  if (width == I.getWidth() && height == I.getHeight())
+    found = m_detector.detect(I);
+  else {
+    m_roi.resize(height, width);
+    for (unsigned int i = 0; i < height; i++)
+      memcpy(m_roi[i], I[top + i] + left, width);
+    found = m_detector.detect(m_roi);
+  }
+  if (!found)
+    return;
+
+  const vpImagePoint offset(top, left);
+  for (size_t i = 0; i < m_detector.getNbObjects(); i++) {
+    std::vector<vpImagePoint> polygon = m_detector.getPolygon(i);
+    for (size_t k = 0; k < polygon.size(); k++)
+      polygon[k] += offset;
+    messages.push_back(m_detector.getMessage(i));
+    polygons.push_back(polygon);
+  }
+}
+
+/*!
+  Area of the frame covered by a rectangle, empty when the rectangle is outside of the frame.
+ */
+static vpRect clipArea(const vpImage<unsigned char> &I, double left, double top, double right, double bottom)
+{
+  const int u0 = (int)std::max(0., left), v0 = (int)std::max(0., top);
+  const int u1 = (int)std::min(I.getWidth() - 1., right + 1), v1 = (int)std::min(I.getHeight() - 1., bottom + 1);
+  if (u1 < u0 || v1 < v0)
+    return vpRect();
+  return vpRect(u0, v0, u1 - u0 + 1, v1 - v0 + 1);
+}
+
+/*!
+  Verify the tracked codes whose verification is enabled with one decoding of the area around
+  them, the decoded codes being dispatched by message. Each code goes back to the detection as
+  with vpQRCodeTracker::setVerificationPeriod().
+  \param I : Frame where the codes were just tracked.
+ */
+void vpMultiQRCodeTracker::verify(const vpImage<unsigned char> &I)
+{
+  std::vector<unsigned int> verified;
+  double left = I.getWidth(), top = I.getHeight(), right = -1, bottom = -1;
+  for (unsigned int t = 0; t < m_targets.size(); t++) {
+    const vpQRCodeTracker *target = m_targets[t];
+    // A verification started by the tracker alone still owns its members
+    if (!m_status[t] || target->m_verificationPeriod == 0 || target->m_verificationThread != NULL)
+      continue;
+    verified.push_back(t);
+    const vpRect &bbox = m_lastBBox[t];
+    const double margin_u = m_searchMargin * bbox.getWidth(), margin_v = m_searchMargin * bbox.getHeight();
+    left = std::min(left, bbox.getLeft() - margin_u);
+    top = std::min(top, bbox.getTop() - margin_v);
+    right = std::max(right, bbox.getRight() + margin_u);
+    bottom = std::max(bottom, bbox.getBottom() + margin_v);
+  }
+  if (verified.empty())
+    return;
+
+  m_verificationArea = clipArea(I, left, top, right, bottom);
+  std::vector<std::string> messages;
+  std::vector< std::vector<vpImagePoint> > polygons;
+  decode(I, m_verificationArea, messages, polygons);
+  m_nbVerifications++;
+
+  for (size_t k = 0; k < verified.size(); k++) {
+    vpQRCodeTracker *target = m_targets[verified[k]];
+    target->m_framesSinceVerification = 0;
+    target->m_verificationId = target->m_trackingId;
+    target->m_verificationTracked = target->m_corners_tracked;
+    target->m_verificationFound = false;
+    for (size_t i = 0; i < messages.size(); i++) {
+      if (messages[i] == target->m_message) {
+        target->m_verificationCorners = polygons[i];
+        target->m_verificationFound = true;
+        break;
+      }
+    }
+    target->applyVerification();
+  }
+}
+
+/*!
+  Detect and track the active codes. The codes to detect share one decoding of the frame, or of
+  the area around the recently lost ones, then each code runs its template tracker.
+  \param I : Frame.
+  \return true if all the active codes are tracked. The status of each code is given by getStatus().
+ */
+bool vpMultiQRCodeTracker::track(const vpImage<unsigned char> &I)
+{
+  m_frame.setFrame(I, m_frame.getFrameIndex() + 1);
+  return track(m_frame);
+}
+
+/*!
+  Same as track(const vpImage<unsigned char> &), the pyramid of the frame being shared by the
+  template trackers of the codes and with the other trackers of the frame.
+  \param frame : Context of the current frame.
+  \return true if all the active codes are tracked.
+ */
+bool vpMultiQRCodeTracker::track(vpFrameContext &frame)
+{
+  const vpImage<unsigned char> &I = frame.getImage();
+  const unsigned int nb = m_targets.size();
+  m_status.assign(nb, false);
+
+  // Area to decode: around the codes lost recently, the whole frame if another code is searched
+  bool search = false, whole = false;
+  double left = I.getWidth(), top = I.getHeight(), right = -1, bottom = -1;
+  for (unsigned int t = 0; t < nb; t++) {
+    vpQRCodeTracker *target = m_targets[t];
+    if (!m_active[t])
+      continue;
+    target->mergeVerification();
+    if (target->m_state != vpQRCodeTracker::detection && !target->m_force_detection)
+      continue;
+
+    search = true;
+    if (m_lostFrames[t] >= m_localSearchFrames) {
+      whole = true;
+      continue;
+    }
+    const vpRect &bbox = m_lastBBox[t];
+    const double margin_u = m_searchMargin * bbox.getWidth(), margin_v = m_searchMargin * bbox.getHeight();
+    left = std::min(left, bbox.getLeft() - margin_u);
+    top = std::min(top, bbox.getTop() - margin_v);
+    right = std::max(right, bbox.getRight() + margin_u);
+    bottom = std::max(bottom, bbox.getBottom() + margin_v);
+  }
+
+  m_searchArea = vpRect();
+  if (search) {
+    if (whole)
+      m_searchArea = vpRect(0, 0, I.getWidth(), I.getHeight());
+    else {
+      // Areas clipped to the frame, nothing to decode when they are all outside of it
+      m_searchArea = clipArea(I, left, top, right, bottom);
+      search = m_searchArea.getWidth() > 0;
+    }
+  }
+
+  if (search) {
+    // One decoding, whose codes are dispatched by message to the codes to detect
+    std::vector<std::string> messages;
+    std::vector< std::vector<vpImagePoint> > polygons;
+    decode(I, m_searchArea, messages, polygons);
+    for (size_t i = 0; i < messages.size(); i++) {
+      int t = getTargetIndex(messages[i]);
+      if (t < 0 || !m_active[t])
+        continue;
+      vpQRCodeTracker *target = m_targets[t];
+      if (target->m_state == vpQRCodeTracker::detection || target->m_force_detection) {
+        target->m_corners_detected = polygons[i];
+        target->m_state = vpQRCodeTracker::init_tracking;
+      }
+    }
+  }
+
+  // Template tracking of each code
+  bool all_tracked = true, verification = false;
+  for (unsigned int t = 0; t < nb; t++) {
+    if (!m_active[t])
+      continue;
+    vpQRCodeTracker *target = m_targets[t];
+    m_status[t] = target->trackTemplate(frame);
+    if (!m_status[t]) {
+      all_tracked = false;
+      if (m_lostFrames[t] < UINT_MAX)
+        m_lostFrames[t]++;
+      continue;
+    }
+
+    m_lostFrames[t] = 0;
+    const std::vector<vpImagePoint> &corners = target->m_corners_tracked;
+    double u_min = corners[0].get_u(), u_max = u_min, v_min = corners[0].get_v(), v_max = v_min;
+    for (size_t k = 1; k < corners.size(); k++) {
+      u_min = std::min(u_min, corners[k].get_u());
+      u_max = std::max(u_max, corners[k].get_u());
+      v_min = std::min(v_min, corners[k].get_v());
+      v_max = std::max(v_max, corners[k].get_v());
+    }
+    m_lastBBox[t] = vpRect(u_min, v_min, u_max - u_min + 1, v_max - v_min + 1);
+
+    if (target->m_verificationPeriod > 0 && ++target->m_framesSinceVerification >= target->m_verificationPeriod)
+      verification = true;
+  }
+
+  // When a code reaches its verification period, all the verified codes share a decoding, in a
+  // frame that was not already decoded for the detection
+  m_verificationArea = vpRect();
+  if (verification && !search)
+    verify(I);
+
+  return all_tracked;
+}
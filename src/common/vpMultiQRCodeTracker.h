@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tracking of several qrcodes with a single decoding of the image.
+ *
+ *****************************************************************************/
+#ifndef __vpMultiQRCodeTracker_h__
+#define __vpMultiQRCodeTracker_h__
+
+#include <string>
+#include <vector>
+
+#include <visp/vpDetectorQRCode.h>
+#include <visp/vpImage.h>
+#include <visp/vpRect.h>
+
+#include <vpQRCodeTracker.h>
+
+/*!
+  Track several vpQRCodeTracker in the same image, with at most one decoding per frame.
+
+  Each code keeps its own message, size, template tracker and state, and is set up as usual
+  before being added with addTarget(). When some codes have to be detected, the image is decoded
+  once and the decoded codes are dispatched by message to the trackers, whose template tracker
+  is initialized from them. The codes lost since less than setLocalSearchFrames() frames are
+  searched around their last location only: when no other code is searched in the whole image,
+  only the bounding box of these areas is decoded. The tracked codes only run their template
+  tracker, so that a frame costs one decoding at most plus a template tracking per code.
+
+  The verification of vpQRCodeTracker::setVerificationPeriod() is also shared: when a tracked
+  code reaches its period, the area around all the tracked codes whose verification is enabled is
+  decoded once, in a frame where no code is detected, and each code is checked against the
+  decoded code with its message. The codes are then verified together every setVerificationPeriod()
+  frames, with one decoding instead of one per code. The verification is done in track(), whatever
+  vpQRCodeTracker::setAsyncVerification().
+
+  \code
+  vpMultiQRCodeTracker trackers;
+  trackers.addTarget(arm_r);
+  trackers.addTarget(arm_l);
+  while (1) {
+    ...
+    trackers.track(I);
+    if (trackers.getStatus(0))
+      cMo_r = arm_r.get_cMo();
+  }
+  \endcode
+ */
+class vpMultiQRCodeTracker
+{
+protected:
+  std::vector<vpQRCodeTracker*> m_targets; //!< Trackers, not owned
+  std::vector<bool> m_active; //!< Trackers updated by track()
+  std::vector<bool> m_status; //!< true for each code tracked in the last frame
+  std::vector<vpRect> m_lastBBox; //!< Bounding box of each code in the last frame where it was tracked
+  std::vector<unsigned int> m_lostFrames; //!< Number of frames since each code was tracked
+  vpDetectorQRCode m_detector;
+  vpImage<unsigned char> m_roi; //!< Area of the frame decoded when the whole frame is not needed
+  vpRect m_searchArea; //!< Area decoded in the last frame, empty if none
+  vpRect m_verificationArea; //!< Area decoded in the last frame to verify the codes, empty if none
+  unsigned int m_localSearchFrames;
+  double m_searchMargin;
+  unsigned long m_nbDecodes;
+  unsigned long m_nbVerifications; //!< Number of decodings done to verify the codes
+  vpFrameContext m_frame; //!< Context of the frames given without one to track()
+
+  void decode(const vpImage<unsigned char> &I, const vpRect &area, std::vector<std::string> &messages,
+              std::vector< std::vector<vpImagePoint> > &polygons);
+  void verify(const vpImage<unsigned char> &I);
+
+public:
+  vpMultiQRCodeTracker();
+  virtual ~vpMultiQRCodeTracker() {}
+
+  unsigned int addTarget(vpQRCodeTracker &target);
+  unsigned int getNbTargets() const { return m_targets.size(); }
+
+  /*!
+    Number of frames where the image, or a part of it, was decoded.
+    */
+  unsigned long getNbDecodes() const { return m_nbDecodes; }
+
+  /*!
+    Number of frames where the tracked codes were decoded to verify them, also counted by
+    getNbDecodes().
+    */
+  unsigned long getNbVerifications() const { return m_nbVerifications; }
+
+  /*!
+    Area of the frame decoded by the last call to track(), empty when no code was searched or when
+    the areas of the lost codes are all outside of the frame.
+    */
+  vpRect getSearchArea() const { return m_searchArea; }
+  bool getStatus(unsigned int index) const { return m_status[index]; }
+  const std::vector<bool> &getStatus() const { return m_status; }
+  vpQRCodeTracker &getTarget(unsigned int index) { return *m_targets[index]; }
+  int getTargetIndex(const std::string &message) const;
+
+  /*!
+    Area of the frame decoded by the last call to track() to verify the tracked codes, empty when
+    no code was verified.
+    */
+  vpRect getVerificationArea() const { return m_verificationArea; }
+  bool isActive(unsigned int index) const { return m_active[index]; }
+
+  /*!
+    Choose if a code is tracked by track(). An inactive code keeps its state and is not tracked
+    until it is active again. All the codes are active when added.
+    */
+  void setActive(unsigned int index, const bool &active) { m_active[index] = active; }
+
+  /*!
+    Number of frames after the loss of a code where it is only searched around its last location,
+    10 by default. 0 always searches the lost codes in the whole image.
+    */
+  void setLocalSearchFrames(const unsigned int &frames) { m_localSearchFrames = frames; }
+
+  /*!
+    Size of the margin added on each side of the last bounding box of a lost code to search it,
+    relatively to the size of the bounding box. 1 by default.
+    */
+  void setSearchMargin(const double &margin) { m_searchMargin = margin; }
+
+  bool track(const vpImage<unsigned char> &I);
+  bool track(vpFrameContext &frame);
+};
+
+#endif
@@ -0,0 +1,521 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose from points refined by Gauss-Newton without heap allocation.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp/vpException.h>
+#include <visp/vpMath.h>
+
+#include <vpPointPoseSolver.h>
+
+namespace {
+
+/*
+  Solve A x = b for a 6x6 symmetric positive definite matrix by Cholesky decomposition.
+  \return false if A is not positive definite.
+ */
+bool solveCholesky6(double A[6][6], const double b[6], double x[6])
+{
+  double L[6][6];
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j <= i; j++) {
+      double sum = A[i][j];
+      for (int k = 0; k < j; k++)
+        sum -= L[i][k] * L[j][k];
+      if (i == j) {
+        if (sum <= 1e-30)
+          return false;
+        L[i][i] = std::sqrt(sum);
+      }
+      else
+        L[i][j] = sum / L[j][j];
+    }
+  }
+  double y[6];
+  for (int i = 0; i < 6; i++) {
+    double sum = b[i];
+    for (int k = 0; k < i; k++)
+      sum -= L[i][k] * y[k];
+    y[i] = sum / L[i][i];
+  }
+  for (int i = 5; i >= 0; i--) {
+    double sum = y[i];
+    for (int k = i + 1; k < 6; k++)
+      sum -= L[k][i] * x[k];
+    x[i] = sum / L[i][i];
+  }
+  return true;
+}
+
+/*
+  Rotation and translation of the exponential map of the velocity v during one unit of time,
+  like vpExponentialMap::direct().
+ */
+void expMap(const double v[6], double R[9], double t[3])
+{
+  const double wx = v[3], wy = v[4], wz = v[5];
+  const double theta2 = wx*wx + wy*wy + wz*wz;
+  const double theta = std::sqrt(theta2);
+  double sinc, mcosc, msinc; // sin(x)/x, (1-cos(x))/x^2, (1-sin(x)/x)/x^2
+  if (theta < 1e-4) {
+    sinc = 1. - theta2 / 6.;
+    mcosc = 0.5 - theta2 / 24.;
+    msinc = 1. / 6. - theta2 / 120.;
+  }
+  else {
+    sinc = std::sin(theta) / theta;
+    mcosc = (1. - std::cos(theta)) / theta2;
+    msinc = (1. - sinc) / theta2;
+  }
+
+  R[0] = 1. - mcosc * (wy*wy + wz*wz);
+  R[1] = -sinc * wz + mcosc * wx * wy;
+  R[2] = sinc * wy + mcosc * wx * wz;
+  R[3] = sinc * wz + mcosc * wx * wy;
+  R[4] = 1. - mcosc * (wx*wx + wz*wz);
+  R[5] = -sinc * wx + mcosc * wy * wz;
+  R[6] = -sinc * wy + mcosc * wx * wz;
+  R[7] = sinc * wx + mcosc * wy * wz;
+  R[8] = 1. - mcosc * (wx*wx + wy*wy);
+
+  t[0] = v[0] * (sinc + wx*wx*msinc) + v[1] * (wx*wy*msinc - wz*mcosc) + v[2] * (wx*wz*msinc + wy*mcosc);
+  t[1] = v[0] * (wx*wy*msinc + wz*mcosc) + v[1] * (sinc + wy*wy*msinc) + v[2] * (wy*wz*msinc - wx*mcosc);
+  t[2] = v[0] * (wx*wz*msinc - wy*mcosc) + v[1] * (wy*wz*msinc + wx*mcosc) + v[2] * (sinc + wz*wz*msinc);
+}
+
+/*
+  Solve A x = b for a n x n matrix by Gaussian elimination with partial pivoting. A and b are modified.
+  \return false if A is singular.
+ */
+template <int n>
+bool solveGauss(double A[n][n], double b[n], double x[n])
+{
+  for (int c = 0; c < n; c++) {
+    int pivot = c;
+    for (int r = c + 1; r < n; r++)
+      if (std::fabs(A[r][c]) > std::fabs(A[pivot][c]))
+        pivot = r;
+    if (std::fabs(A[pivot][c]) < 1e-14)
+      return false;
+    if (pivot != c) {
+      for (int k = 0; k < n; k++)
+        std::swap(A[c][k], A[pivot][k]);
+      std::swap(b[c], b[pivot]);
+    }
+    for (int r = c + 1; r < n; r++) {
+      const double f = A[r][c] / A[c][c];
+      for (int k = c; k < n; k++)
+        A[r][k] -= f * A[c][k];
+      b[r] -= f * b[c];
+    }
+  }
+  for (int r = n - 1; r >= 0; r--) {
+    double sum = b[r];
+    for (int k = r + 1; k < n; k++)
+      sum -= A[r][k] * x[k];
+    x[r] = sum / A[r][r];
+  }
+  return true;
+}
+
+/*
+  Product C = A B of 3x3 matrices stored by rows.
+ */
+void multiply3(const double A[9], const double B[9], double C[9])
+{
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      C[3*i + j] = A[3*i] * B[j] + A[3*i + 1] * B[3 + j] + A[3*i + 2] * B[6 + j];
+}
+
+}
+
+/*!
+  Default constructor, without any point.
+ */
+vpPointPoseSolver::vpPointPoseSolver()
+  : m_nbPoints(0), m_maxIter(20), m_threshold(1e-10), m_residual(0.)
+{
+  for (int r = 0; r < 6; r++)
+    for (int c = 0; c < 6; c++)
+      m_JtJ[r][c] = 0.;
+}
+
+/*!
+  Copy the object coordinates (oX, oY, oZ) and the normalized image coordinates (x, y) of the points.
+  \param points : At most maxPoints points.
+ */
+void vpPointPoseSolver::setPoints(const std::vector<vpPoint> &points)
+{
+  if (points.size() > maxPoints)
+    throw vpException(vpException::dimensionError, "Cannot compute a pose from %d points: at most %d points are supported",
+                      (int)points.size(), (int)maxPoints);
+
+  m_nbPoints = points.size();
+  for (unsigned int i = 0; i < m_nbPoints; i++) {
+    m_oP[i][0] = points[i].get_oX();
+    m_oP[i][1] = points[i].get_oY();
+    m_oP[i][2] = points[i].get_oZ();
+    m_p[i][0] = points[i].get_x();
+    m_p[i][1] = points[i].get_y();
+  }
+}
+
+/*!
+  Sum of the squared distances between the points and their projection, like vpPose::computeResidual().
+ */
+double vpPointPoseSolver::computeResidual(const double R[9], const double t[3]) const
+{
+  double residual = 0.;
+  for (unsigned int i = 0; i < m_nbPoints; i++) {
+    const double *oP = m_oP[i];
+    const double X = R[0]*oP[0] + R[1]*oP[1] + R[2]*oP[2] + t[0];
+    const double Y = R[3]*oP[0] + R[4]*oP[1] + R[5]*oP[2] + t[1];
+    const double Z = R[6]*oP[0] + R[7]*oP[1] + R[8]*oP[2] + t[2];
+    const double ex = X / Z - m_p[i][0], ey = Y / Z - m_p[i][1];
+    residual += ex*ex + ey*ey;
+  }
+  return residual;
+}
+
+/*!
+  Refine a pose by Gauss-Newton iterations.
+  \param cMo : Initial pose, updated with the refined pose.
+  \return false if there are less than 3 points, if a point is behind the camera or if the
+  system is degenerated. \e cMo is unchanged in that case.
+ */
+bool vpPointPoseSolver::computePose(vpHomogeneousMatrix &cMo)
+{
+  if (m_nbPoints < 3)
+    return false;
+
+  double R[9], t[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++)
+      R[3*i + j] = cMo[i][j];
+    t[i] = cMo[i][3];
+  }
+
+  for (unsigned int iter = 0; iter < m_maxIter; iter++) {
+    // Normal equations L^T L v = -L^T e, L being the interaction matrix of the points
+    double A[6][6] = {{0.}}, b[6] = {0.};
+    for (unsigned int i = 0; i < m_nbPoints; i++) {
+      const double *oP = m_oP[i];
+      const double X = R[0]*oP[0] + R[1]*oP[1] + R[2]*oP[2] + t[0];
+      const double Y = R[3]*oP[0] + R[4]*oP[1] + R[5]*oP[2] + t[1];
+      const double Z = R[6]*oP[0] + R[7]*oP[1] + R[8]*oP[2] + t[2];
+      if (Z <= 0.)
+        return false;
+      const double x = X / Z, y = Y / Z, iZ = 1. / Z;
+      const double Lx[6] = {-iZ, 0., x*iZ, x*y, -(1. + x*x), y};
+      const double Ly[6] = {0., -iZ, y*iZ, 1. + y*y, -x*y, -x};
+      const double ex = x - m_p[i][0], ey = y - m_p[i][1];
+      for (int r = 0; r < 6; r++) {
+        b[r] -= Lx[r] * ex + Ly[r] * ey;
+        for (int c = 0; c <= r; c++)
+          A[r][c] += Lx[r] * Lx[c] + Ly[r] * Ly[c];
+      }
+    }
+    for (int r = 0; r < 6; r++)
+      for (int c = r + 1; c < 6; c++)
+        A[r][c] = A[c][r];
+    for (int r = 0; r < 6; r++)
+      for (int c = 0; c < 6; c++)
+        m_JtJ[r][c] = A[r][c];
+
+    double v[6];
+    if (!solveCholesky6(A, b, v))
+      return false;
+
+    // cMo = exp(v)^-1 * cMo
+    double dR[9], dt[3];
+    expMap(v, dR, dt);
+    double nR[9], nt[3];
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++)
+        nR[3*i + j] = dR[i] * R[j] + dR[3 + i] * R[3 + j] + dR[6 + i] * R[6 + j];
+      nt[i] = dR[i] * (t[0] - dt[0]) + dR[3 + i] * (t[1] - dt[1]) + dR[6 + i] * (t[2] - dt[2]);
+    }
+    for (int k = 0; k < 9; k++)
+      R[k] = nR[k];
+    for (int k = 0; k < 3; k++)
+      t[k] = nt[k];
+
+    double norm2 = 0.;
+    for (int k = 0; k < 6; k++)
+      norm2 += v[k] * v[k];
+    if (norm2 < m_threshold * m_threshold)
+      break;
+  }
+
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++)
+      cMo[i][j] = R[3*i + j];
+    cMo[i][3] = t[i];
+  }
+  m_residual = computeResidual(R, t);
+  return true;
+}
+
+/*!
+  Covariance of the pose given by the last call to computePose(), as a twist in the camera frame
+  ordered like the velocities of vpExponentialMap, for vpPoseFilter.
+
+  The noise of the normalized coordinates is estimated from the residual, and kept above
+  \e sigma_min, for example half a pixel divided by the focal length px.
+  \param sigma_min : Smallest standard deviation of the normalized coordinates.
+ */
+vpMatrix vpPointPoseSolver::getCovariance(const double &sigma_min) const
+{
+  double sigma2 = sigma_min * sigma_min;
+  if (m_nbPoints > 3)
+    sigma2 = std::max(sigma2, m_residual / (2 * m_nbPoints - 6));
+
+  vpMatrix JtJ(6, 6);
+  for (unsigned int r = 0; r < 6; r++)
+    for (unsigned int c = 0; c < 6; c++)
+      JtJ[r][c] = m_JtJ[r][c];
+  return sigma2 * JtJ.pseudoInverse();
+}
+
+/*!
+  Return true if all the points are in the plane oZ = 0 of the object frame, like the points of
+  the QR codes, the templates and the blob targets.
+ */
+bool vpPointPoseSolver::isPlanar() const
+{
+  for (unsigned int i = 0; i < m_nbPoints; i++)
+    if (m_oP[i][2] != 0.)
+      return false;
+  return true;
+}
+
+/*!
+  Translation that minimizes the algebraic error of the points, centered on (cx, cy), for a rotation.
+ */
+bool vpPointPoseSolver::computeTranslation(const double R[9], double cx, double cy, double t[3]) const
+{
+  // x (r3.P + tz) = r1.P + tx and y (r3.P + tz) = r2.P + ty, linear in t
+  double A[3][3] = {{0.}}, b[3] = {0.};
+  for (unsigned int i = 0; i < m_nbPoints; i++) {
+    const double X = m_oP[i][0] - cx, Y = m_oP[i][1] - cy;
+    const double x = m_p[i][0], y = m_p[i][1];
+    const double r1P = R[0]*X + R[1]*Y, r2P = R[3]*X + R[4]*Y, r3P = R[6]*X + R[7]*Y;
+    A[0][0] += 1.;  A[0][2] -= x;
+    A[1][1] += 1.;  A[1][2] -= y;
+    A[2][2] += x*x + y*y;
+    b[0] += x * r3P - r1P;
+    b[1] += y * r3P - r2P;
+    b[2] -= x * (x * r3P - r1P) + y * (y * r3P - r2P);
+  }
+  A[2][0] = A[0][2];
+  A[2][1] = A[1][2];
+  double tc[3];
+  if (!solveGauss<3>(A, b, tc))
+    return false;
+
+  // Back to the object frame: R (P - c) + tc = R P + tc - R c
+  t[0] = tc[0] - R[0]*cx - R[1]*cy;
+  t[1] = tc[1] - R[3]*cx - R[4]*cy;
+  t[2] = tc[2] - R[6]*cx - R[7]*cy;
+  return true;
+}
+
+/*!
+  Closed-form pose of a planar target, from the decomposition of the homography between the
+  target plane and the image (IPPE, Collins and Bartoli, "Infinitesimal Plane-based Pose
+  Estimation", IJCV 2014).
+
+  The homography is estimated by least squares, then the rotation is given by its Jacobian at
+  the center of the points. A planar target seen with some perspective has two solutions, one
+  of them being the flipped target; when it is small or far, both have a similar residual and
+  the tracking has to choose with the previous pose.
+
+  \param cMo1 : Pose with the smallest residual.
+  \param cMo2 : Other solution.
+  \return false if there are less than 4 points, if they are not in the plane oZ = 0 or if they
+  are degenerated. The poses are unchanged in that case.
+ */
+bool vpPointPoseSolver::computePlanarPose(vpHomogeneousMatrix &cMo1, vpHomogeneousMatrix &cMo2)
+{
+  if (m_nbPoints < 4 || !isPlanar())
+    return false;
+
+  // Normalization of the object and image points, the object points being centered
+  double cx = 0., cy = 0., mx = 0., my = 0.;
+  for (unsigned int i = 0; i < m_nbPoints; i++) {
+    cx += m_oP[i][0];
+    cy += m_oP[i][1];
+    mx += m_p[i][0];
+    my += m_p[i][1];
+  }
+  cx /= m_nbPoints; cy /= m_nbPoints; mx /= m_nbPoints; my /= m_nbPoints;
+  double so = 0., sp = 0.;
+  for (unsigned int i = 0; i < m_nbPoints; i++) {
+    so += vpMath::sqr(m_oP[i][0] - cx) + vpMath::sqr(m_oP[i][1] - cy);
+    sp += vpMath::sqr(m_p[i][0] - mx) + vpMath::sqr(m_p[i][1] - my);
+  }
+  if (so <= 0. || sp <= 0.)
+    return false;
+  so = std::sqrt(so / m_nbPoints);
+  sp = std::sqrt(sp / m_nbPoints);
+
+  // Homography with h33 = 1 by least squares, the center of the target being visible
+  double A[8][8] = {{0.}}, b[8] = {0.};
+  for (unsigned int i = 0; i < m_nbPoints; i++) {
+    const double X = (m_oP[i][0] - cx) / so, Y = (m_oP[i][1] - cy) / so;
+    const double x = (m_p[i][0] - mx) / sp, y = (m_p[i][1] - my) / sp;
+    const double rx[8] = {X, Y, 1., 0., 0., 0., -x*X, -x*Y};
+    const double ry[8] = {0., 0., 0., X, Y, 1., -y*X, -y*Y};
+    for (int r = 0; r < 8; r++) {
+      b[r] += rx[r] * x + ry[r] * y;
+      for (int c = 0; c < 8; c++)
+        A[r][c] += rx[r] * rx[c] + ry[r] * ry[c];
+    }
+  }
+  double h[8];
+  if (!solveGauss<8>(A, b, h))
+    return false;
+
+  // Homography from the centered object points to the normalized coordinates: Tp^-1 Hn To
+  const double Hn[9] = {h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7], 1.};
+  const double Tp_inv[9] = {sp, 0., mx, 0., sp, my, 0., 0., 1.};
+  const double To[9] = {1. / so, 0., 0., 0., 1. / so, 0., 0., 0., 1.};
+  double tmp[9], H[9];
+  multiply3(Tp_inv, Hn, tmp);
+  multiply3(tmp, To, H);
+  for (int k = 0; k < 9; k++)
+    H[k] /= H[8];
+
+  // Image of the center and Jacobian of the homography at the center
+  const double v[2] = {H[2], H[5]};
+  const double J[4] = {H[0] - H[6] * H[2], H[1] - H[7] * H[2],
+                       H[3] - H[6] * H[5], H[4] - H[7] * H[5]};
+
+  // Rotation Rv bringing the line of sight of the center on the optical axis
+  double Rv[9] = {1., 0., 0., 0., 1., 0., 0., 0., 1.};
+  const double norm_v = std::sqrt(v[0]*v[0] + v[1]*v[1]);
+  if (norm_v > 1e-12) {
+    const double s = std::sqrt(1. + norm_v * norm_v);
+    const double cos_th = 1. / s, sin_th = std::sqrt(1. - 1. / (s * s));
+    const double K[9] = {0., 0., v[0] / norm_v, 0., 0., v[1] / norm_v, -v[0] / norm_v, -v[1] / norm_v, 0.};
+    double K2[9];
+    multiply3(K, K, K2);
+    for (int k = 0; k < 9; k++)
+      Rv[k] += sin_th * K[k] + (1. - cos_th) * K2[k];
+  }
+
+  // B = [I2 -v] Rv(:, 0:1), A = B^-1 J
+  const double B[4] = {Rv[0] - v[0] * Rv[6], Rv[1] - v[0] * Rv[7],
+                       Rv[3] - v[1] * Rv[6], Rv[4] - v[1] * Rv[7]};
+  const double det_B = B[0] * B[3] - B[1] * B[2];
+  if (std::fabs(det_B) < 1e-14)
+    return false;
+  const double Am[4] = {( B[3] * J[0] - B[1] * J[2]) / det_B, ( B[3] * J[1] - B[1] * J[3]) / det_B,
+                        (-B[2] * J[0] + B[0] * J[2]) / det_B, (-B[2] * J[1] + B[0] * J[3]) / det_B};
+
+  // Largest singular value of A, then the 2x2 upper left block of the rotation
+  const double a2 = Am[0]*Am[0] + Am[1]*Am[1], c2 = Am[2]*Am[2] + Am[3]*Am[3];
+  const double gamma = std::sqrt(0.5 * (a2 + c2 + std::sqrt(vpMath::sqr(a2 - c2)
+                                                           + 4 * vpMath::sqr(Am[0]*Am[2] + Am[1]*Am[3]))));
+  if (gamma < 1e-14)
+    return false;
+  const double R22[4] = {Am[0] / gamma, Am[1] / gamma, Am[2] / gamma, Am[3] / gamma};
+  const double h11 = 1. - R22[0]*R22[0] - R22[2]*R22[2];
+  const double h12 = -R22[0]*R22[1] - R22[2]*R22[3];
+  const double h22 = 1. - R22[1]*R22[1] - R22[3]*R22[3];
+  const double b1 = std::sqrt(std::max(0., h11));
+  const double b2 = (h12 < 0. ? -1. : 1.) * std::sqrt(std::max(0., h22));
+  // Third column, cross product of the first two ones
+  const double c[3] = {R22[2] * b2 - b1 * R22[3], b1 * R22[1] - R22[0] * b2, R22[0] * R22[3] - R22[2] * R22[1]};
+
+  double Rs[2][9];
+  const double sign[2] = {1., -1.};
+  for (int k = 0; k < 2; k++) {
+    const double M[9] = {R22[0], R22[1], sign[k] * c[0],
+                         R22[2], R22[3], sign[k] * c[1],
+                         sign[k] * b1, sign[k] * b2, c[2]};
+    multiply3(Rv, M, Rs[k]);
+  }
+
+  double ts[2][3], residual[2];
+  for (int k = 0; k < 2; k++) {
+    if (!computeTranslation(Rs[k], cx, cy, ts[k]))
+      return false;
+    residual[k] = computeResidual(Rs[k], ts[k]);
+  }
+  const int best = residual[1] < residual[0] ? 1 : 0;
+  vpHomogeneousMatrix *cMo[2] = {&cMo1, &cMo2};
+  for (int k = 0; k < 2; k++) {
+    const int l = (k == 0) ? best : 1 - best;
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j < 3; j++)
+        (*cMo[k])[i][j] = Rs[l][3*i + j];
+      (*cMo[k])[i][3] = ts[l][i];
+    }
+  }
+  m_residual = residual[best];
+  return true;
+}
+
+/*!
+  Initial pose of a target, when no previous pose is known. For a planar target, the two
+  solutions of computePlanarPose() are refined by computePose() and the one with the smallest
+  residual is kept. This replaces the comparison of vpPose::DEMENTHON_VIRTUAL_VS and
+  vpPose::LAGRANGE_VIRTUAL_VS, without any allocation.
+  \param cMo : Initial pose.
+  \return false if the target is not planar or if no solution can be refined.
+ */
+bool vpPointPoseSolver::initPose(vpHomogeneousMatrix &cMo)
+{
+  vpHomogeneousMatrix cMo1, cMo2;
+  if (!computePlanarPose(cMo1, cMo2))
+    return false;
+
+  const bool valid1 = computePose(cMo1);
+  const double residual1 = m_residual;
+  const bool valid2 = computePose(cMo2);
+  const double residual2 = m_residual;
+  if (!valid1 && !valid2)
+    return false;
+  if (valid1 && (!valid2 || residual1 <= residual2)) {
+    cMo = cMo1;
+    m_residual = residual1;
+  }
+  else
+    cMo = cMo2;
+  return true;
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose from points refined by Gauss-Newton without heap allocation.
+ *
+ *****************************************************************************/
+#ifndef __vpPointPoseSolver_h__
+#define __vpPointPoseSolver_h__
+
+#include <vector>
+
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpMatrix.h>
+#include <visp/vpPoint.h>
+
+/*!
+  Persistent pose solver for a small set of points, meant to be called at each frame of a tracker.
+
+  The points are copied in fixed-size arrays and the pose is refined by Gauss-Newton iterations
+  of the virtual visual servoing, the same minimisation as vpPose::VIRTUAL_VS, with the normal
+  equations solved on the stack. Starting from the pose of the previous frame, a few iterations
+  are enough, and no memory is allocated.
+
+  When the target is found for the first time, the initial pose of a planar target is given
+  by initPose(), that refines the two solutions of the closed-form computePlanarPose(). The
+  number of iterations can be fixed with setMaxIterations() and a null threshold, so that the
+  latency does not depend on the convergence.
+
+  \code
+  vpPointPoseSolver solver;
+  solver.setPoints(points); // x and y of the points set from the tracked image points
+  solver.initPose(cMo);     // When the target is found
+  solver.computePose(cMo);  // At the next frames, cMo being the pose of the previous frame
+  \endcode
+ */
+class vpPointPoseSolver
+{
+public:
+  static const unsigned int maxPoints = 16;
+
+protected:
+  double m_oP[maxPoints][3]; //!< Coordinates of the points in the object frame
+  double m_p[maxPoints][2]; //!< Normalized coordinates of the points in the image
+  unsigned int m_nbPoints;
+  unsigned int m_maxIter;
+  double m_threshold; //!< Stop when the norm of the update is smaller
+  double m_residual;
+  double m_JtJ[6][6]; //!< Normal matrix of the last iteration, for the covariance of the pose
+
+  double computeResidual(const double R[9], const double t[3]) const;
+  bool computeTranslation(const double R[9], double cx, double cy, double t[3]) const;
+
+public:
+  vpPointPoseSolver();
+  virtual ~vpPointPoseSolver() {}
+
+  bool computePlanarPose(vpHomogeneousMatrix &cMo1, vpHomogeneousMatrix &cMo2);
+  bool computePose(vpHomogeneousMatrix &cMo);
+  vpMatrix getCovariance(const double &sigma_min=0.) const;
+  unsigned int getNbPoints() const { return m_nbPoints; }
+  double getResidual() const { return m_residual; }
+  bool initPose(vpHomogeneousMatrix &cMo);
+  bool isPlanar() const;
+  void setMaxIterations(const unsigned int &max_iter) { m_maxIter = max_iter; }
+  void setPoints(const std::vector<vpPoint> &points);
+  void setThreshold(const double &threshold) { m_threshold = threshold; }
+};
+
+#endif
@@ -0,0 +1,211 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Constant velocity Kalman filter of the pose of a target.
+ *
+ *****************************************************************************/
+
+#include <visp/vpException.h>
+#include <visp/vpExponentialMap.h>
+#include <visp/vpMath.h>
+#include <visp/vpVelocityTwistMatrix.h>
+
+#include <vpPoseFilter.h>
+
+/*!
+  Default constructor. The target moves with accelerations of about 0.5 m/s^2 and 2 rad/s^2,
+  like a hand of the robot during a servo.
+ */
+vpPoseFilter::vpPoseFilter()
+  : m_cMo(), m_v(6, 0.), m_P(12, 12), m_time(0), m_lastUpdate(0), m_initialized(false),
+    m_sigmaLinearAcceleration(0.5), m_sigmaAngularAcceleration(2.0),
+    m_sigmaLinearVelocity(0.2), m_sigmaAngularVelocity(1.0), m_maxPredictionTime(200.)
+{
+}
+
+/*!
+  Covariance of the pose error, 6x6, translation then rotation in the camera frame.
+ */
+vpMatrix vpPoseFilter::getCovariance() const
+{
+  vpMatrix P(6, 6);
+  for (unsigned int i = 0; i < 6; i++)
+    for (unsigned int j = 0; j < 6; j++)
+      P[i][j] = m_P[i][j];
+  return P;
+}
+
+/*!
+  Return true if the filter got a measurement less than setMaxPredictionTime() before \e t.
+ */
+bool vpPoseFilter::isValid(const double &t) const
+{
+  return m_initialized && t - m_lastUpdate <= m_maxPredictionTime;
+}
+
+/*!
+  Move the state to the time \e t with the constant velocity model. Nothing is done for a time
+  before the time of the state.
+ */
+void vpPoseFilter::predict(const double &t)
+{
+  if (!m_initialized || t <= m_time)
+    return;
+
+  const double dt = (t - m_time) / 1000.;
+  vpHomogeneousMatrix E = vpExponentialMap::direct(m_v, dt);
+  m_cMo = E * m_cMo;
+
+  // Error propagation: the pose error is moved by the displacement and grows with the velocity error
+  vpVelocityTwistMatrix Ad(E);
+  vpMatrix F(12, 12);
+  F.eye();
+  for (unsigned int i = 0; i < 6; i++)
+    for (unsigned int j = 0; j < 6; j++) {
+      F[i][j] = Ad[i][j];
+      F[i][j + 6] = dt * Ad[i][j];
+    }
+
+  // White acceleration noise integrated over dt
+  vpMatrix Q(12, 12);
+  for (unsigned int i = 0; i < 6; i++) {
+    const double q = vpMath::sqr(i < 3 ? m_sigmaLinearAcceleration : m_sigmaAngularAcceleration);
+    Q[i][i] = q * dt * dt * dt / 3.;
+    Q[i][i + 6] = Q[i + 6][i] = q * dt * dt / 2.;
+    Q[i + 6][i + 6] = q * dt;
+  }
+
+  m_P = F * m_P * F.t() + Q;
+  m_time = t;
+}
+
+/*!
+  Pose predicted at the time \e t, without changing the state.
+ */
+vpHomogeneousMatrix vpPoseFilter::predictPose(const double &t) const
+{
+  if (!m_initialized || t <= m_time)
+    return m_cMo;
+  return vpExponentialMap::direct(m_v, (t - m_time) / 1000.) * m_cMo;
+}
+
+/*!
+  Forget the state, the next measurement initializes the filter.
+ */
+void vpPoseFilter::reset()
+{
+  m_initialized = false;
+  m_v = 0.;
+  m_P = 0.;
+}
+
+/*!
+  Uncertainty of the velocity when the filter is initialized from a single pose.
+  \param sigma_linear : Standard deviation of the velocity, in m/s.
+  \param sigma_angular : Standard deviation of the angular velocity, in rad/s.
+ */
+void vpPoseFilter::setInitialVelocityUncertainty(const double &sigma_linear, const double &sigma_angular)
+{
+  m_sigmaLinearVelocity = sigma_linear;
+  m_sigmaAngularVelocity = sigma_angular;
+}
+
+/*!
+  Set the white noise of the acceleration of the target. Larger values follow the target faster,
+  smaller values filter more.
+  \param sigma_linear : Standard deviation of the acceleration, in m/s^2.
+  \param sigma_angular : Standard deviation of the angular acceleration, in rad/s^2.
+ */
+void vpPoseFilter::setProcessNoise(const double &sigma_linear, const double &sigma_angular)
+{
+  m_sigmaLinearAcceleration = sigma_linear;
+  m_sigmaAngularAcceleration = sigma_angular;
+}
+
+/*!
+  Correct the state with a measured pose.
+  \param cMo : Pose given by the tracker.
+  \param R : 6x6 covariance of the measured pose, see vpPointPoseSolver::getCovariance().
+  \param t : Time of the image where the pose is measured.
+ */
+void vpPoseFilter::update(const vpHomogeneousMatrix &cMo, const vpMatrix &R, const double &t)
+{
+  if (R.getRows() != 6 || R.getCols() != 6)
+    throw vpException(vpException::dimensionError, "Cannot filter a pose with a %dx%d covariance",
+                      (int)R.getRows(), (int)R.getCols());
+
+  if (!isValid(t)) {
+    m_cMo = cMo;
+    m_v = 0.;
+    m_P = 0.;
+    for (unsigned int i = 0; i < 6; i++) {
+      for (unsigned int j = 0; j < 6; j++)
+        m_P[i][j] = R[i][j];
+      m_P[i + 6][i + 6] = vpMath::sqr(i < 3 ? m_sigmaLinearVelocity : m_sigmaAngularVelocity);
+    }
+    m_time = m_lastUpdate = t;
+    m_initialized = true;
+    return;
+  }
+
+  predict(t);
+
+  // Innovation: twist that brings the predicted pose on the measured one
+  vpColVector r = vpExponentialMap::inverse(cMo * m_cMo.inverse());
+
+  // The pose is measured, H = [I 0]
+  vpMatrix S(6, 6), PHt(12, 6);
+  for (unsigned int i = 0; i < 12; i++)
+    for (unsigned int j = 0; j < 6; j++)
+      PHt[i][j] = m_P[i][j];
+  for (unsigned int i = 0; i < 6; i++)
+    for (unsigned int j = 0; j < 6; j++)
+      S[i][j] = m_P[i][j] + R[i][j];
+  vpMatrix K = PHt * S.pseudoInverse();
+  vpColVector dx = K * r;
+
+  vpColVector dp(6), dv(6);
+  for (unsigned int i = 0; i < 6; i++) {
+    dp[i] = dx[i];
+    dv[i] = dx[i + 6];
+  }
+  m_cMo = vpExponentialMap::direct(dp) * m_cMo;
+  m_v += dv;
+
+  // Joseph form, that keeps the covariance symmetric and positive
+  vpMatrix IKH(12, 12);
+  IKH.eye();
+  for (unsigned int i = 0; i < 12; i++)
+    for (unsigned int j = 0; j < 6; j++)
+      IKH[i][j] -= K[i][j];
+  m_P = IKH * m_P * IKH.t() + K * R * K.t();
+  m_lastUpdate = t;
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Constant velocity Kalman filter of the pose of a target.
+ *
+ *****************************************************************************/
+#ifndef __vpPoseFilter_h__
+#define __vpPoseFilter_h__
+
+#include <visp/vpColVector.h>
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpMatrix.h>
+
+/*!
+  Filter the pose of a target given by a tracker, with a constant velocity model.
+
+  This is an error-state Kalman filter on SE(3): the state is the pose cMo and the velocity
+  twist of the target expressed in the camera frame, cMo(t+dt) = exp(v dt) cMo(t), and the
+  errors are the twists that bring the estimate on the true state. The acceleration is a white
+  noise set with setProcessNoise(). Each measured pose comes with its covariance, given by the
+  pose solver of the tracker, with the twist ordered as the velocities of vpExponentialMap:
+  translation then rotation, in the camera frame.
+
+  Between two measurements the pose can be predicted at any time, so that a servo can use the
+  filtered pose at the time of the command and keep running through a dropped frame. After
+  setMaxPredictionTime() without measurement, the filter is no longer valid and the next
+  measurement initializes it again.
+
+  The times are in milliseconds, like vpTime::measureTimeMs(), and the velocities per second. A
+  measurement has to be given with the capture time of its frame: the trackers take it from
+  setFrameTime().
+
+  \code
+  vpPoseFilter filter;
+  g.acquire(cvI);
+  double t_frame = vpTime::measureTimeMs(); // Time of the frame, not of the pose computation
+  if (tracker.track(cvI, I))
+    filter.update(tracker.get_cMo(), covariance, t_frame);
+  double t = vpTime::measureTimeMs();
+  if (filter.isValid(t))
+    servo.setCurrentFeature(filter.predictPose(t) * oMe);
+  \endcode
+ */
+class vpPoseFilter
+{
+protected:
+  vpHomogeneousMatrix m_cMo; //!< Filtered pose at m_time
+  vpColVector m_v; //!< Velocity twist of the target in the camera frame
+  vpMatrix m_P; //!< Covariance of the pose and velocity errors
+  double m_time; //!< Time of the state
+  double m_lastUpdate; //!< Time of the last measurement
+  bool m_initialized;
+  double m_sigmaLinearAcceleration; //!< Standard deviation of the acceleration, in m/s^2
+  double m_sigmaAngularAcceleration; //!< Standard deviation of the angular acceleration, in rad/s^2
+  double m_sigmaLinearVelocity; //!< Initial standard deviation of the velocity, in m/s
+  double m_sigmaAngularVelocity; //!< Initial standard deviation of the angular velocity, in rad/s
+  double m_maxPredictionTime; //!< Time without measurement after which the filter is not valid
+
+public:
+  vpPoseFilter();
+  virtual ~vpPoseFilter() {}
+
+  vpHomogeneousMatrix get_cMo() const { return m_cMo; }
+  vpMatrix getCovariance() const;
+  vpMatrix getStateCovariance() const { return m_P; }
+  double getTime() const { return m_time; }
+  vpColVector getVelocity() const { return m_v; }
+  bool isInitialized() const { return m_initialized; }
+  bool isValid(const double &t) const;
+
+  void predict(const double &t);
+  vpHomogeneousMatrix predictPose(const double &t) const;
+  void reset();
+
+  void setInitialVelocityUncertainty(const double &sigma_linear, const double &sigma_angular);
+  /*!
+    Time without measurement after which the filter is no longer valid, in milliseconds.
+    200 ms by default, a few frames at 30 Hz.
+    */
+  void setMaxPredictionTime(const double &time) { m_maxPredictionTime = time; }
+  void setProcessNoise(const double &sigma_linear, const double &sigma_angular);
+
+  void update(const vpHomogeneousMatrix &cMo, const vpMatrix &R, const double &t);
+};
+
+#endif
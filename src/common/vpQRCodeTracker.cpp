@@ -1,35 +1,48 @@
 
+#include <algorithm>
+
+#include <visp/vpHomography.h>
+#include <visp/vpMeterPixelConversion.h>
+#include <visp/vpTime.h>
+
 #include <vpQRCodeTracker.h>
 
 
 vpQRCodeTracker::vpQRCodeTracker(int barcode)
-  : m_detector(NULL), m_warp(), m_tracker(NULL), m_state(detection), m_target_found(false), m_P(4), m_force_detection(false), m_message("romeo_left_arm")
+  : m_detector(NULL), m_warp(), m_tracker(NULL), m_templates(), m_quality(), m_state(detection), m_target_found(false), m_P(4), m_force_detection(false), m_message("romeo_left_arm"),
+    m_poseSolver(), m_poseFilter(), m_filterPose(false), m_frameTime(-1),
+    m_verifier(NULL), m_verificationThread(NULL), m_verificationMutex(), m_verificationDone(false), m_verificationFrame(),
+    m_verificationMessage(), m_verificationCorners(), m_verificationTracked(), m_verificationFound(false),
+    m_verificationId(0), m_trackingId(0), m_verificationPeriod(0), m_framesSinceVerification(0),
+    m_verificationMisses(0), m_asyncVerification(true), m_verificationTolerance(5.), m_nbDecodes(0),
+    m_frame(), m_templateLevel(1)
 {
   if (barcode == 0)
   {
     m_detector = new vpDetectorQRCode;
+    m_verifier = new vpDetectorQRCode;
     std::cout << "vpDetectorQRCode"<< std::endl;
    }
 #ifdef VISP_HAVE_DMTX
-  else
+  else {
     m_detector = new vpDetectorDataMatrixCode;
+    m_verifier = new vpDetectorDataMatrixCode;
+  }
 #endif
 
-  m_tracker = new vpTemplateTrackerSSDInverseCompositional(&m_warp);
-  m_tracker->setSampling(2,2);
-  m_tracker->setLambda(0.001);
-  m_tracker->setIterationMax(5);
-  m_tracker->setPyramidal(2, 1);
-
   setQRCodeSize(0.045);
 }
 
 vpQRCodeTracker::~vpQRCodeTracker()
 {
+  if (m_verificationThread != NULL) {
+    m_verificationThread->join();
+    delete m_verificationThread;
+  }
+  if (m_verifier != NULL)
+    delete m_verifier;
   if (m_detector != NULL)
     delete m_detector;
-  if (m_tracker != NULL)
-    delete m_tracker;
 };
 
 
@@ -59,22 +72,214 @@ void vpQRCodeTracker::setQRCodeSize(double qrcode_size)
   m_P[3].setWorldCoordinates( qrcode_size/2., -qrcode_size/2., 0);
 }
 
+/*!
+  Move the tracked bar code by the motion of the camera and of the bar code predicted from the
+  joints of the robot, so that the next track() starts the template tracker from the expected
+  location. The warp is the homography from the reference corners to the projection of the
+  bar code with the predicted pose. Nothing is done when the bar code is not tracked.
+  \param predictor : Camera and target displacements since the last call to track().
+  */
+void vpQRCodeTracker::predictMotion(const vpMotionPredictor &predictor)
+{
+  if (m_state != tracking || m_force_detection || m_corners_ref.size() != m_P.size())
+    return;
+
+  // The template is tracked in the level m_templateLevel of the pyramid
+  const double scale = 1. / (1 << m_templateLevel);
+  vpHomogeneousMatrix cMo = predictor.predict(m_cMo);
+  std::vector<double> u_ref(m_P.size()), v_ref(m_P.size()), u_pred(m_P.size()), v_pred(m_P.size());
+  for (size_t i=0; i < m_P.size(); i++) {
+    vpPoint P = m_P[i];
+    P.track(cMo);
+    if (P.get_Z() <= 0)
+      return;
+    vpImagePoint ip;
+    vpMeterPixelConversion::convertPoint(m_cam, P.get_x(), P.get_y(), ip);
+    u_ref[i] = scale * m_corners_ref[i].get_u();
+    v_ref[i] = scale * m_corners_ref[i].get_v();
+    u_pred[i] = scale * ip.get_u();
+    v_pred[i] = scale * ip.get_v();
+  }
+
+  try {
+    vpHomography H;
+    vpHomography::DLT(u_ref, v_ref, u_pred, v_pred, H, true);
+    vpColVector p;
+    m_warp.getParam(H, p);
+    m_tracker->setp(p);
+    m_cMo = cMo;
+  }
+  catch(...) {
+    std::cout << "Exception motion prediction" << std::endl;
+  }
+}
+
+/*!
+  Track the bar code. It is decoded only to detect it, the template tracker following it at the
+  other frames, and every setVerificationPeriod() frames to check the template tracker.
+  \param I : Current frame.
+  \return true if the bar code is found.
+  */
 bool vpQRCodeTracker::track(const vpImage<unsigned char> &I)
 {
-  bool result = false;
-  bool status = m_detector->detect(I);
-  if (status)
-    result = track(I, m_detector);
+  m_frame.setFrame(I, m_frame.getFrameIndex() + 1);
+  return track(m_frame);
+}
+
+/*!
+  Same as track(const vpImage<unsigned char> &), the level of the pyramid where the template is
+  tracked being shared with the other trackers of the frame.
+  \param frame : Context of the current frame.
+  \return true if the bar code is found.
+  */
+bool vpQRCodeTracker::track(vpFrameContext &frame)
+{
+  const vpImage<unsigned char> &I = frame.getImage();
+  mergeVerification();
+
+  if (m_state == detection || m_force_detection) {
+    m_nbDecodes++;
+    if (! m_detector->detect(I))
+      return false;
+    selectCode(m_detector);
+    return trackTemplate(frame);
+  }
+
+  bool result = trackTemplate(frame);
+  if (result && m_verificationPeriod > 0 && ++m_framesSinceVerification >= m_verificationPeriod)
+    startVerification(I);
 
   return result;
 }
 
+/*!
+  Decode the frame \e I to verify the tracked bar code, in a background thread when the
+  asynchronous verification is enabled. Nothing is done while a previous verification runs.
+  */
+void vpQRCodeTracker::startVerification(const vpImage<unsigned char> &I)
+{
+  if (m_verifier == NULL || m_verificationThread != NULL)
+    return;
+
+  m_framesSinceVerification = 0;
+  m_verificationId = m_trackingId;
+  m_verificationTracked = m_corners_tracked;
+  m_verificationMessage = m_message;
+  m_nbDecodes++;
+
+  if (! m_asyncVerification) {
+    decodeVerification(I);
+    applyVerification();
+    return;
+  }
+
+  m_verificationFrame = I;
+  {
+    vpMutex::vpScopedLock lock(m_verificationMutex);
+    m_verificationDone = false;
+  }
+  m_verificationThread = new vpThread(verificationFunction, (vpThread::Args)this);
+}
+
+/*!
+  Body of the verification thread, that only uses the members of the verification.
+  */
+vpThread::Return vpQRCodeTracker::verificationFunction(vpThread::Args args)
+{
+  vpQRCodeTracker *tracker = (vpQRCodeTracker *)args;
+  tracker->decodeVerification(tracker->m_verificationFrame);
+
+  vpMutex::vpScopedLock lock(tracker->m_verificationMutex);
+  tracker->m_verificationDone = true;
+  return 0;
+}
+
+/*!
+  Decode \e I with the verifier and keep the corners of the tracked bar code.
+  */
+void vpQRCodeTracker::decodeVerification(const vpImage<unsigned char> &I)
+{
+  m_verificationFound = false;
+  if (! m_verifier->detect(I))
+    return;
+
+  for (size_t i=0; i < m_verifier->getNbObjects(); i++) {
+    if (m_verifier->getMessage(i) == m_verificationMessage) {
+      m_verificationCorners = m_verifier->getPolygon(i);
+      m_verificationFound = true;
+      return;
+    }
+  }
+}
+
+/*!
+  Use the result of the verification thread if it ended, without waiting for it.
+  */
+void vpQRCodeTracker::mergeVerification()
+{
+  if (m_verificationThread == NULL)
+    return;
+  {
+    vpMutex::vpScopedLock lock(m_verificationMutex);
+    if (! m_verificationDone)
+      return;
+  }
+  m_verificationThread->join();
+  delete m_verificationThread;
+  m_verificationThread = NULL;
+
+  applyVerification();
+}
+
+/*!
+  Go back to the detection if the decoded corners are far from the tracked ones of the verified
+  frame, or if the bar code was not decoded by the last verifications. The result is ignored when
+  the template tracker was initialized again since the verified frame.
+  */
+void vpQRCodeTracker::applyVerification()
+{
+  if (m_state != tracking || m_verificationId != m_trackingId)
+    return;
 
+  if (! m_verificationFound) {
+    if (++m_verificationMisses >= 3) {
+      m_state = detection;
+      m_target_found = false;
+    }
+    return;
+  }
+  m_verificationMisses = 0;
+
+  if (m_verificationTracked.empty())
+    return;
+  double distance = 0;
+  for (size_t i=0; i < m_verificationCorners.size(); i++) {
+    double distance_min = vpImagePoint::distance(m_verificationCorners[i], m_verificationTracked[0]);
+    for (size_t j=1; j < m_verificationTracked.size(); j++)
+      distance_min = std::min(distance_min, vpImagePoint::distance(m_verificationCorners[i], m_verificationTracked[j]));
+    distance += distance_min;
+  }
+  if (! m_verificationCorners.empty() && distance / m_verificationCorners.size() > m_verificationTolerance) {
+    // The template drifted, it is built again at the next detection
+    m_templates.invalidate(m_message);
+    m_state = detection;
+    m_target_found = false;
+  }
+}
 
 bool vpQRCodeTracker::track(const vpImage<unsigned char> &I, vpDetectorBase * &detector )
 {
-  vpColVector p; // Estimated parameters
+  m_frame.setFrame(I, m_frame.getFrameIndex() + 1);
+  selectCode(detector);
+  return trackTemplate(m_frame);
+}
 
+/*!
+  In the detection state, or when the detection is forced, take the corners of the code decoded
+  by \e detector with the message of the tracker, and initialize the tracking from them.
+  */
+void vpQRCodeTracker::selectCode(vpDetectorBase *detector)
+{
   if (m_state == detection || m_force_detection) {
     //bool status = detector->detect(I);
     if (detector->getNbObjects()>0) {
@@ -96,30 +301,105 @@ bool vpQRCodeTracker::track(const vpImage<unsigned char> &I, vpDetectorBase * &d
 
     }
   }
+}
+
+/*!
+  Start the tracker of the cached template of the bar code from the detected corners, instead of
+  building the template from the frame.
+  \param I : Level of the pyramid of the frame where the template is tracked, blurred by
+  vpFrameContext::getBlurredLevel().
+  \return true if the bar code is tracked from the cached template.
+  */
+bool vpQRCodeTracker::reuseTemplate(const vpImage<unsigned char> &I)
+{
+  vpTemplateCache::Reference *reference = m_templates.find(m_message);
+  vpColVector p;
+  if (reference == NULL || ! m_templates.initialWarp(*reference, m_corners_detected, m_templateLevel, m_warp, p))
+    return false;
+
+  std::vector<vpImagePoint> corners;
+  try {
+    reference->tracker->setp(p);
+    reference->tracker->track(I);
+    p = reference->tracker->getp();
+    m_warp.warpZone(reference->zone, p, zone_cur);
+    corners = orderPointsFromIndexes(reference->indexes, vpFrameContext::pyramidUp(getTemplateTrackerCorners(zone_cur), m_templateLevel));
+  }
+  catch(...) {
+    corners.clear();
+  }
+  if (! m_templates.accept(*reference, corners, m_corners_detected))
+    return false;
+
+  m_tracker = reference->tracker;
+  m_zone_ref = reference->zone;
+  m_corners_tracked = corners;
+  m_corners_tracked_index = reference->indexes;
+  m_corners_ref = reference->corners;
+  return true;
+}
+
+/*!
+  Initialize the template tracker from the detected corners in the init_tracking state, or track
+  the bar code with it in the tracking state, and compute the pose.
+  \return true if the bar code is found.
+  */
+bool vpQRCodeTracker::trackTemplate(vpFrameContext &frame)
+{
+  vpColVector p; // Estimated parameters
+  // Level of the pyramid where the template is tracked, the corners being kept at level 0
+  const vpImage<unsigned char> &I = frame.getLevel(m_templateLevel);
+
   if (m_state == init_tracking) {
     //vpDisplay::displayText(I, 40,10, "state: init tracking", vpColor::red);
     try {
-      m_tracker->resetTracker();
-      m_tracker->initFromPoints(I, m_corners_detected, true);
-      m_tracker->track(I);
-      //m_tracker->display(I, vpColor::green);
-      m_zone_ref = m_tracker->getZoneRef();
-      m_area_m_zone_ref = m_zone_ref.getArea();
-      p = m_tracker->getp();
-      m_warp.warpZone(m_zone_ref, p, zone_cur);
-      m_area_zone_prev = m_area_zone_cur = zone_cur.getArea();
-      m_corners_tracked = getTemplateTrackerCorners(zone_cur);
-      m_corners_tracked_index = computedTemplateTrackerCornersIndexes(m_corners_detected, m_corners_tracked);
-      m_corners_tracked = orderPointsFromIndexes(m_corners_tracked_index, m_corners_tracked);
+      // Same level blurred once for all the trackers of the frame, the trackers not blurring it
+      const vpImage<unsigned char> &B = frame.getBlurredLevel(m_templateLevel);
+      if (! reuseTemplate(B)) {
+        vpTemplateCache::Reference *reference = m_templates.find(m_message);
+        if (reference == NULL) {
+          vpTemplateTrackerResidual *tracker = new vpTemplateTrackerResidual(&m_warp);
+          tracker->setSampling(2,2);
+          tracker->setLambda(0.001);
+          tracker->setIterationMax(5);
+          tracker->setBlur(false);
+          reference = &m_templates.insert(m_message, tracker);
+        }
+        reference->initialized = false;
+        m_tracker = reference->tracker;
+        m_tracker->resetTracker();
+        m_tracker->initFromPoints(I, vpFrameContext::pyramidDown(m_corners_detected, m_templateLevel), true);
+        m_tracker->track(B);
+        //m_tracker->display(I, vpColor::green);
+        m_zone_ref = m_tracker->getZoneRef();
+        p = m_tracker->getp();
+        m_warp.warpZone(m_zone_ref, p, zone_cur);
+        m_corners_tracked = vpFrameContext::pyramidUp(getTemplateTrackerCorners(zone_cur), m_templateLevel);
+        m_corners_tracked_index = computedTemplateTrackerCornersIndexes(m_corners_detected, m_corners_tracked);
+        m_corners_tracked = orderPointsFromIndexes(m_corners_tracked_index, m_corners_tracked);
+        m_corners_ref = orderPointsFromIndexes(m_corners_tracked_index, vpFrameContext::pyramidUp(getTemplateTrackerCorners(m_zone_ref), m_templateLevel));
+        m_templates.store(*reference, m_zone_ref, m_corners_ref, m_corners_tracked_index);
+      }
+
+      if (! m_quality.update(*m_tracker, m_zone_ref, zone_cur)) {
+        m_templates.invalidate(m_message);
+        m_state = detection;
+        m_target_found = false;
+        return false;
+      }
 
       computePose(m_P, m_corners_tracked, m_cam, true, m_cMo);
       //       vpDisplay::displayFrame(I, m_cMo, m_cam, 0.04, vpColor::none, 3);
 
       m_state = tracking;
       m_target_found = true;
+      m_trackingId++;
+      m_framesSinceVerification = 0;
+      m_verificationMisses = 0;
     }
     catch(...) {
       std::cout << "Exception init tracking" << std::endl;
+      m_templates.invalidate(m_message);
       m_state = detection;
       m_target_found = false;
     }
@@ -127,19 +407,19 @@ bool vpQRCodeTracker::track(const vpImage<unsigned char> &I, vpDetectorBase * &d
   else if (m_state == tracking) {
     try {
       //vpDisplay::displayText(I, 40,10, "state: tracking", vpColor::red);
-      m_tracker->track(I);
+      const vpImage<unsigned char> &B = frame.getBlurredLevel(m_templateLevel);
+      m_tracker->track(B);
 
       //m_tracker->display(I, vpColor::blue);
 
       // Instantiate and get the reference zone
       p = m_tracker->getp();
       m_warp.warpZone(m_zone_ref, p, zone_cur);
-      m_area_zone_cur = zone_cur.getArea();
 
-      double size_percent = 0.95;
       double max_target_size = I.getSize()/4;
-      if (m_area_zone_cur/m_area_zone_prev < size_percent || m_area_zone_cur/m_area_zone_prev > (1+size_percent)) {
-        //          std::cout << "reinit caused by size" << std::endl;
+      if (! m_quality.update(*m_tracker, m_zone_ref, zone_cur)) {
+        //          std::cout << "reinit caused by the tracking quality" << std::endl;
+        m_templates.invalidate(m_message);
         m_state = detection;
         m_target_found = false;
       }
@@ -149,7 +429,7 @@ bool vpQRCodeTracker::track(const vpImage<unsigned char> &I, vpDetectorBase * &d
         m_target_found = false;
       }
       else {
-        m_corners_tracked = getTemplateTrackerCorners(zone_cur);
+        m_corners_tracked = vpFrameContext::pyramidUp(getTemplateTrackerCorners(zone_cur), m_templateLevel);
         m_corners_tracked = orderPointsFromIndexes(m_corners_tracked_index, m_corners_tracked);
 
         computePose(m_P, m_corners_tracked, m_cam, false, m_cMo);
@@ -165,11 +445,10 @@ bool vpQRCodeTracker::track(const vpImage<unsigned char> &I, vpDetectorBase * &d
         m_target_found = true;
       }
 
-      m_area_zone_prev = m_area_zone_cur;
-
     }
     catch(...) {
       std::cout << "Exception tracking" << std::endl;
+      m_templates.invalidate(m_message);
       m_state = detection;
       m_target_found = false;
     }
@@ -235,16 +514,19 @@ std::vector<vpImagePoint> vpQRCodeTracker::orderPointsFromIndexes(const std::vec
 void vpQRCodeTracker::computePose(std::vector<vpPoint> &point, const std::vector<vpImagePoint> &corners,
                                   const vpCameraParameters &cam, bool init, vpHomogeneousMatrix &cMo)
 {
-  vpPose pose;
   double x=0, y=0;
   for (unsigned int i=0; i < point.size(); i ++) {
     vpPixelMeterConversion::convertPoint(cam, corners[i], x, y);
     point[i].set_x(x);
     point[i].set_y(y);
-    pose.addPoint(point[i]);
   }
+  m_poseSolver.setPoints(point);
 
-  if (init) {
+  // Closed-form initial pose of the planar target, vpPose for the other models
+  if (init && !m_poseSolver.initPose(cMo)) {
+    vpPose pose;
+    for (unsigned int i=0; i < point.size(); i ++)
+      pose.addPoint(point[i]);
     vpHomogeneousMatrix cMo_dementhon, cMo_lagrange;
     pose.computePose(vpPose::DEMENTHON_VIRTUAL_VS, cMo_dementhon);
     double residual_dementhon = pose.computeResidual(cMo_dementhon);
@@ -256,5 +538,11 @@ void vpQRCodeTracker::computePose(std::vector<vpPoint> &point, const std::vector
       cMo = cMo_lagrange;
   }
 
-  pose.computePose(vpPose::VIRTUAL_VS, cMo) ;
+  // Same minimisation as vpPose::VIRTUAL_VS, without allocation
+  m_poseSolver.computePose(cMo);
+
+  // Time of the frame, the pose being computed after its processing
+  if (m_filterPose)
+    m_poseFilter.update(cMo, m_poseSolver.getCovariance(0.5 / cam.get_px()), m_frameTime >= 0 ? m_frameTime : vpTime::measureTimeMs());
+  m_frameTime = -1;
 }
@@ -5,9 +5,18 @@
 #include <visp/vpDetectorDataMatrixCode.h>
 #include <visp/vpDetectorQRCode.h>
 #include <visp/vpPose.h>
-#include <visp/vpTemplateTrackerSSDInverseCompositional.h>
 #include <visp/vpTemplateTrackerWarpHomography.h>
 #include <visp/vpPixelMeterConversion.h>
+#include <visp3/core/vpMutex.h>
+#include <visp3/core/vpThread.h>
+
+#include <vpFrameContext.h>
+#include <vpMotionPredictor.h>
+#include <vpPointPoseSolver.h>
+#include <vpPoseFilter.h>
+#include <vpTemplateCache.h>
+#include <vpTemplateTrackerResidual.h>
+#include <vpTrackingQuality.h>
 
 #ifndef VISP_HAVE_ZBAR
 #  error "Cannot build the project, libzbar is missing. Install libzbar using apt-get install libzbar-dev and rebuild ViSP."
@@ -15,6 +24,8 @@
 
 class vpQRCodeTracker
 {
+  friend class vpMultiQRCodeTracker;
+
 public:
   typedef enum {
     detection,
@@ -26,22 +37,50 @@ public:
 protected:
   vpDetectorBase *m_detector;
   vpTemplateTrackerWarpHomography m_warp;
-  vpTemplateTrackerSSDInverseCompositional *m_tracker;
+  vpTemplateTrackerResidual *m_tracker; // Tracker of the template of m_message, owned by m_templates
+  vpTemplateCache m_templates; // Templates of the messages already tracked
+  vpTrackingQuality m_quality; // Quality of the template tracking, that decides when the bar code is lost
   vpTemplateTrackerZone m_zone_ref, zone_cur;
-  double m_area_m_zone_ref, m_area_zone_cur, m_area_zone_prev;
 
   state_t m_state;
   std::vector<vpImagePoint> m_corners_detected;
   std::vector<vpImagePoint> m_corners_tracked;
   std::vector<int> m_corners_tracked_index;
+  std::vector<vpImagePoint> m_corners_ref; // Corners of the reference zone, in the order of m_P
   bool m_target_found;
   vpRect m_target_bbox; // BBox of the tracked qrcode
   std::vector<vpPoint> m_P; // Points of the qrcode model
   vpCameraParameters m_cam;
   vpHomogeneousMatrix m_cMo;
+  vpPointPoseSolver m_poseSolver; // Pose of the planar model, initialized in closed form
+  vpPoseFilter m_poseFilter; // Filtered pose, updated when m_filterPose is set
+  bool m_filterPose;
+  double m_frameTime; // Time given to setFrameTime(), negative when none
   bool m_force_detection;
   std::string m_message;
 
+  // Verification of the tracked bar code by decoding it again every m_verificationPeriod frames
+  vpDetectorBase *m_verifier; // Decoder of the verification, distinct from m_detector to run in its own thread
+  vpThread *m_verificationThread; // Running verification, NULL when none
+  vpMutex m_verificationMutex; // Protects m_verificationDone
+  bool m_verificationDone;
+  vpImage<unsigned char> m_verificationFrame; // Snapshot of the frame decoded by the verification thread
+  std::string m_verificationMessage;
+  std::vector<vpImagePoint> m_verificationCorners; // Tracked corners of the verified frame, then the decoded ones
+  std::vector<vpImagePoint> m_verificationTracked;
+  bool m_verificationFound;
+  unsigned long m_verificationId; // Value of m_trackingId for the verified frame
+  unsigned long m_trackingId; // Incremented at each initialization of the template tracker
+  unsigned int m_verificationPeriod;
+  unsigned int m_framesSinceVerification;
+  unsigned int m_verificationMisses; // Consecutive verifications that did not decode the bar code
+  bool m_asyncVerification;
+  double m_verificationTolerance;
+  unsigned long m_nbDecodes;
+
+  vpFrameContext m_frame; // Context of the frames given without one to track()
+  unsigned int m_templateLevel; // Level of the pyramid where the template is tracked
+
 public:
 
   /*!
@@ -54,6 +93,37 @@ public:
 
   vpHomogeneousMatrix get_cMo() const {return m_cMo;}
 
+  vpPoseFilter &getPoseFilter() { return m_poseFilter; }
+
+  /*!
+    Templates of the bar codes already tracked, reused when a bar code is detected again.
+    */
+  vpTemplateCache &getTemplateCache() { return m_templates; }
+
+  /*!
+    Quality of the tracking of the bar code in the last frame, with its thresholds and the
+    histogram of its scores.
+    */
+  vpTrackingQuality &getTrackingQuality() { return m_quality; }
+
+  /*!
+    Filter the pose with getPoseFilter() at each frame where the target is tracked, with the
+    covariance given by the pose solver. Disabled by default.
+    */
+  void setPoseFiltering(const bool &enable)
+  {
+    m_filterPose = enable;
+    if (!enable)
+      m_poseFilter.reset();
+  }
+
+  /*!
+    Capture time of the frame given to the next track(), in ms like vpTime::measureTimeMs(), used
+    to update getPoseFilter(). It is used for the next pose only. Without it, the filter is
+    updated with the time of the pose computation, which adds the latency of the processing.
+    */
+  void setFrameTime(const double &time) { m_frameTime = time; }
+
   /*!
     Return the center of gravity location of the tracked bar code.
     */
@@ -70,10 +140,54 @@ public:
     m_message = message;
   }
 
+  /*!
+    Number of frames where the bar code was decoded, by the detection or by the verification.
+    */
+  unsigned long getNbDecodes() const {return m_nbDecodes;}
+
+  /*!
+    Decode the tracked bar code every \e period frames to check that the template tracker did not
+    drift. The tracker goes back to the detection when the decoded corners are farther than
+    setVerificationTolerance() from the tracked ones, or after 3 verifications without the bar
+    code. 0, the default, disables the verification: the bar code is only decoded to detect it.
+    */
+  void setVerificationPeriod(const unsigned int &period) {
+    m_verificationPeriod = period;
+  }
+
+  /*!
+    Decode the verified frames in a background thread, the result being used by the first call to
+    track() after the end of the decoding. Otherwise the verification is done in track().
+    Enabled by default.
+    */
+  void setAsyncVerification(const bool &enable) {
+    m_asyncVerification = enable;
+  }
+
+  /*!
+    Largest mean distance in pixels between the decoded and the tracked corners, 5 by default.
+    */
+  void setVerificationTolerance(const double &tolerance) {
+    m_verificationTolerance = tolerance;
+  }
+
+  void predictMotion(const vpMotionPredictor &predictor);
+
   void setQRCodeSize(double qrcode_size);
 
   bool track(const vpImage<unsigned char> &I);
   bool track(const vpImage<unsigned char> &I, vpDetectorBase *&detector );
+  bool track(vpFrameContext &frame);
+
+protected:
+  void selectCode(vpDetectorBase *detector);
+  bool reuseTemplate(const vpImage<unsigned char> &I);
+  bool trackTemplate(vpFrameContext &frame);
+  void applyVerification();
+  void decodeVerification(const vpImage<unsigned char> &I);
+  void mergeVerification();
+  void startVerification(const vpImage<unsigned char> &I);
+  static vpThread::Return verificationFunction(vpThread::Args args);
 
 private:
   std::vector<vpImagePoint> getTemplateTrackerCorners(const vpTemplateTrackerZone &zone);
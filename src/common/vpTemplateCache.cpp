@@ -0,0 +1,182 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Reference templates kept between the initializations of the template trackers.
+ *
+ *****************************************************************************/
+
+#include <visp/vpException.h>
+#include <visp/vpHomography.h>
+
+#include <vpFrameContext.h>
+#include <vpTemplateCache.h>
+
+/*!
+  Default constructor, with an empty cache.
+ */
+vpTemplateCache::vpTemplateCache()
+  : m_references(), m_enabled(true), m_tolerance(3.), m_nbBuilds(0), m_nbReuses(0)
+{
+}
+
+/*!
+  Destructor, that deletes the trackers of the cache.
+ */
+vpTemplateCache::~vpTemplateCache()
+{
+  for (std::map<std::string, Reference>::iterator it = m_references.begin(); it != m_references.end(); ++it)
+    delete it->second.tracker;
+}
+
+/*!
+  Check the corners tracked from a cached template against the detected ones. The template is
+  invalidated when they are farther than setTolerance().
+  \param reference : Template, from find().
+  \param tracked : Tracked corners, in the order of the detected ones.
+  \param detected : Detected corners.
+  \return true if the template can be kept.
+ */
+bool vpTemplateCache::accept(Reference &reference, const std::vector<vpImagePoint> &tracked,
+                             const std::vector<vpImagePoint> &detected)
+{
+  if (tracked.size() != detected.size() || tracked.empty()) {
+    reference.initialized = false;
+    return false;
+  }
+
+  double distance = 0;
+  for (size_t i = 0; i < tracked.size(); i++)
+    distance += vpImagePoint::distance(tracked[i], detected[i]);
+  if (distance / tracked.size() > m_tolerance) {
+    reference.initialized = false;
+    return false;
+  }
+
+  m_nbReuses++;
+  return true;
+}
+
+/*!
+  Template of a target.
+  \param key : Bar code message or template name.
+  \return The template, NULL if none. Its tracker holds the template when Reference::initialized
+  is set and the cache is enabled.
+ */
+vpTemplateCache::Reference *vpTemplateCache::find(const std::string &key)
+{
+  std::map<std::string, Reference>::iterator it = m_references.find(key);
+  if (it == m_references.end())
+    return NULL;
+  if (!m_enabled)
+    it->second.initialized = false;
+  return &it->second;
+}
+
+/*!
+  Parameters of the homography from the reference corners of a cached template to detected
+  corners, to start its tracker.
+  \param reference : Initialized template.
+  \param detected : Detected corners in the frame, in the order of Reference::corners.
+  \param level : Level of the pyramid where the template is tracked.
+  \param warp : Warp of the tracker.
+  \param p : Parameters of the warp.
+  \return false if the homography cannot be computed.
+ */
+bool vpTemplateCache::initialWarp(const Reference &reference, const std::vector<vpImagePoint> &detected, unsigned int level,
+                                  vpTemplateTrackerWarpHomography &warp, vpColVector &p) const
+{
+  const size_t nb = reference.corners.size();
+  if (!reference.initialized || nb < 4 || detected.size() != nb)
+    return false;
+
+  std::vector<vpImagePoint> ref = vpFrameContext::pyramidDown(reference.corners, level);
+  std::vector<vpImagePoint> cur = vpFrameContext::pyramidDown(detected, level);
+  std::vector<double> u_ref(nb), v_ref(nb), u_cur(nb), v_cur(nb);
+  for (size_t i = 0; i < nb; i++) {
+    u_ref[i] = ref[i].get_u();
+    v_ref[i] = ref[i].get_v();
+    u_cur[i] = cur[i].get_u();
+    v_cur[i] = cur[i].get_v();
+  }
+
+  try {
+    vpHomography H;
+    vpHomography::DLT(u_ref, v_ref, u_cur, v_cur, H, true);
+    warp.getParam(H, p);
+  }
+  catch(...) {
+    return false;
+  }
+  return true;
+}
+
+/*!
+  Add the template of a target, not initialized.
+  \param key : Bar code message or template name, not in the cache.
+  \param tracker : Tracker of the template, deleted by the cache.
+ */
+vpTemplateCache::Reference &vpTemplateCache::insert(const std::string &key, vpTemplateTrackerResidual *tracker)
+{
+  if (m_references.find(key) != m_references.end())
+    throw vpException(vpException::badValue, "The template %s is already in the cache", key.c_str());
+
+  Reference &reference = m_references[key];
+  reference.tracker = tracker;
+  reference.initialized = false;
+  return reference;
+}
+
+/*!
+  Build the template of a target from the next frame where it is detected.
+ */
+void vpTemplateCache::invalidate(const std::string &key)
+{
+  std::map<std::string, Reference>::iterator it = m_references.find(key);
+  if (it != m_references.end())
+    it->second.initialized = false;
+}
+
+/*!
+  Keep the template of a target, once its tracker is initialized on a frame.
+  \param reference : Template, from find() or insert().
+  \param zone : Reference zone of the tracker.
+  \param corners : Corners of the reference zone in the frame, in the order of the detected corners.
+  \param indexes : Corners of the zone in the order of the detected corners.
+ */
+void vpTemplateCache::store(Reference &reference, const vpTemplateTrackerZone &zone, const std::vector<vpImagePoint> &corners,
+                            const std::vector<int> &indexes)
+{
+  reference.zone = zone;
+  reference.corners = corners;
+  reference.indexes = indexes;
+  reference.initialized = true;
+  m_nbBuilds++;
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Reference templates kept between the initializations of the template trackers.
+ *
+ *****************************************************************************/
+#ifndef __vpTemplateCache_h__
+#define __vpTemplateCache_h__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <visp/vpImagePoint.h>
+#include <visp/vpTemplateTrackerWarpHomography.h>
+#include <visp/vpTemplateTrackerZone.h>
+
+#include <vpTemplateTrackerResidual.h>
+
+/*!
+  Template trackers kept initialized on their reference template, one per bar code message or
+  template name.
+
+  Initializing a vpTemplateTrackerSSDInverseCompositional samples the reference template, computes
+  its gradients and the Hessian of the inverse compositional scheme. When vpQRCodeTracker or
+  vpTemplateLocatization detects again a target it already tracked, the tracker of the cache is
+  started instead from the homography between the reference corners and the detected ones, so
+  that only the initial warp is computed. The reference view of the first initialization is the
+  canonical view of the target.
+
+  The template is built again from the frame when the corners tracked from the cached template
+  are farther than setTolerance() from the detected ones, for example when the lighting changed.
+ */
+class vpTemplateCache
+{
+public:
+  /*!
+    Template of a target.
+   */
+  struct Reference {
+    vpTemplateTrackerResidual *tracker; //!< Tracker of the template, owned by the cache
+    bool initialized; //!< true when the tracker holds the template
+    vpTemplateTrackerZone zone; //!< Reference zone, in the level of the pyramid where the template is tracked
+    std::vector<vpImagePoint> corners; //!< Corners of the reference zone in the frame, in the order of the detected corners
+    std::vector<int> indexes; //!< Corners of the zone in the order of the detected corners
+  };
+
+protected:
+  std::map<std::string, Reference> m_references;
+  bool m_enabled;
+  double m_tolerance;
+  unsigned long m_nbBuilds; //!< Number of templates built from a frame
+  unsigned long m_nbReuses; //!< Number of initializations from a cached template
+
+public:
+  vpTemplateCache();
+  virtual ~vpTemplateCache();
+
+  bool accept(Reference &reference, const std::vector<vpImagePoint> &tracked, const std::vector<vpImagePoint> &detected);
+  Reference *find(const std::string &key);
+  unsigned long getNbBuilds() const { return m_nbBuilds; }
+  unsigned long getNbReuses() const { return m_nbReuses; }
+  bool initialWarp(const Reference &reference, const std::vector<vpImagePoint> &detected, unsigned int level,
+                   vpTemplateTrackerWarpHomography &warp, vpColVector &p) const;
+  Reference &insert(const std::string &key, vpTemplateTrackerResidual *tracker);
+  void invalidate(const std::string &key);
+  bool isEnabled() const { return m_enabled; }
+
+  /*!
+    Reuse the cached templates. Enabled by default. When disabled, the template is built from the
+    frame at each initialization.
+    */
+  void setEnabled(const bool &enable) { m_enabled = enable; }
+
+  /*!
+    Largest mean distance in pixels between the detected corners and the ones tracked from the
+    cached template, 3 by default.
+    */
+  void setTolerance(const double &tolerance) { m_tolerance = tolerance; }
+  void store(Reference &reference, const vpTemplateTrackerZone &zone, const std::vector<vpImagePoint> &corners,
+             const std::vector<int> &indexes);
+
+private:
+  vpTemplateCache(const vpTemplateCache &);
+  vpTemplateCache &operator=(const vpTemplateCache &);
+};
+
+#endif
@@ -1,11 +1,14 @@
 
+#include <visp/vpTime.h>
+
 #include <vpTemplateLocatization.h>
 
 
 vpTemplateLocatization::vpTemplateLocatization(const std::string &model, const std::string &configuration_file_folder, const vpCameraParameters &cam)
-  : m_warp(), m_tracker(NULL), m_state(detection), m_target_found(false), m_P(4), m_message("romeo_left_arm"), m_tracker_det(NULL),
+  : m_warp(), m_tracker(NULL), m_templates(), m_quality(), m_state(detection), m_target_found(false), m_P(4), m_message("romeo_left_arm"), m_tracker_det(NULL),
     m_keypoint_learning(NULL), m_keypoint_detection (NULL), m_init_detection (false),m_num_iteration_detection(6), m_counter_detection(0),
-    m_manual_detection (0), m_checkValiditycMo(NULL), m_only_detection(false), m_status_single_detection(false), verbose (true), m_corners_detected()
+    m_manual_detection (0), m_checkValiditycMo(NULL), m_only_detection(false), m_status_single_detection(false), verbose (true), m_corners_detected(),
+    m_poseSolver(), m_poseFilter(), m_filterPose(false), m_frameTime(-1), m_frame(), m_templateLevel(1)
 {
 
   //Detection *****************************************
@@ -51,13 +54,6 @@ vpTemplateLocatization::vpTemplateLocatization(const std::string &model, const s
   m_keypoint_detection = new vpKeyPoint;
   m_keypoint_detection->loadConfigFile(m_configuration_file);
 
-  // Template tracker *****************************************
-  m_tracker = new vpTemplateTrackerSSDInverseCompositional(&m_warp);
-  m_tracker->setSampling(2,2);
-  m_tracker->setLambda(0.001);
-  m_tracker->setIterationMax(5);
-  m_tracker->setPyramidal(2, 1);
-
   setTemplateSize(0.10,0.10);
 }
 
@@ -65,8 +61,6 @@ vpTemplateLocatization::~vpTemplateLocatization()
 {
   if (m_tracker_det != NULL)
     delete m_tracker_det;
-  if (m_tracker != NULL)
-    delete m_tracker;
   if (m_keypoint_learning != NULL)
     delete m_keypoint_learning;
   if (m_keypoint_detection != NULL)
@@ -111,6 +105,19 @@ void vpTemplateLocatization::setTemplateSize(double x,double y)
 
 bool vpTemplateLocatization::track(const vpImage<unsigned char> &I)//, vpDetectorBase * &detector )
 {
+  m_frame.setFrame(I, m_frame.getFrameIndex() + 1);
+  return track(m_frame);
+}
+
+/*!
+  Detect the template in the frame and track it on the level of the pyramid of the frame shared
+  with the other trackers.
+  \param frame : Context of the current frame.
+  \return true if the template is found.
+  */
+bool vpTemplateLocatization::track(vpFrameContext &frame)
+{
+  const vpImage<unsigned char> &I = frame.getImage();
   vpColVector p; // Estimated parameters
 
   if (m_state == detection) {
@@ -366,21 +373,45 @@ bool vpTemplateLocatization::track(const vpImage<unsigned char> &I)//, vpDetecto
   if (m_state == init_tracking) {
     //vpDisplay::displayText(I, 40,10, "state: init tracking", vpColor::red);
     try {
-      m_tracker->resetTracker();
-
-      m_tracker->initFromPoints(I, m_corners_detected, true);
-      // m_tracker->initClick(I,true);
-      m_tracker->track(I);
-      m_tracker->display(I, vpColor::green);
-      m_zone_ref = m_tracker->getZoneRef();
-      m_area_m_zone_ref = m_zone_ref.getArea();
-      p = m_tracker->getp();
-      m_warp.warpZone(m_zone_ref, p, zone_cur);
-      m_area_zone_prev = m_area_zone_cur = zone_cur.getArea();
-      m_corners_tracked = getTemplateTrackerCorners(zone_cur);
-      m_corners_tracked_index = computedTemplateTrackerCornersIndexes(m_corners_detected, m_corners_tracked);
-      //std::cout << "Size:" << m_corners_tracked.size() <<std::endl;
-      m_corners_tracked = orderPointsFromIndexes(m_corners_tracked_index, m_corners_tracked);
+      const vpImage<unsigned char> &J = frame.getLevel(m_templateLevel);
+      // Same level blurred once for all the trackers of the frame, the trackers not blurring it
+      const vpImage<unsigned char> &B = frame.getBlurredLevel(m_templateLevel);
+      if (! reuseTemplate(B)) {
+        vpTemplateCache::Reference *reference = m_templates.find(m_model);
+        if (reference == NULL) {
+          vpTemplateTrackerResidual *tracker = new vpTemplateTrackerResidual(&m_warp);
+          tracker->setSampling(2,2);
+          tracker->setLambda(0.001);
+          tracker->setIterationMax(5);
+          tracker->setBlur(false);
+          reference = &m_templates.insert(m_model, tracker);
+        }
+        reference->initialized = false;
+        m_tracker = reference->tracker;
+        m_tracker->resetTracker();
+
+        m_tracker->initFromPoints(J, vpFrameContext::pyramidDown(m_corners_detected, m_templateLevel), true);
+        // m_tracker->initClick(I,true);
+        m_tracker->track(B);
+        m_zone_ref = m_tracker->getZoneRef();
+        p = m_tracker->getp();
+        m_warp.warpZone(m_zone_ref, p, zone_cur);
+        m_corners_tracked = vpFrameContext::pyramidUp(getTemplateTrackerCorners(zone_cur), m_templateLevel);
+        m_corners_tracked_index = computedTemplateTrackerCornersIndexes(m_corners_detected, m_corners_tracked);
+        //std::cout << "Size:" << m_corners_tracked.size() <<std::endl;
+        m_corners_tracked = orderPointsFromIndexes(m_corners_tracked_index, m_corners_tracked);
+        m_templates.store(*reference, m_zone_ref,
+                          orderPointsFromIndexes(m_corners_tracked_index, vpFrameContext::pyramidUp(getTemplateTrackerCorners(m_zone_ref), m_templateLevel)),
+                          m_corners_tracked_index);
+      }
+
+      if (! m_quality.update(*m_tracker, m_zone_ref, zone_cur)) {
+        m_templates.invalidate(m_model);
+        m_state = detection;
+        m_target_found = false;
+        return false;
+      }
+      vpDisplay::displayPolygon(I, m_corners_tracked, vpColor::green);
 
       computePose(m_P, m_corners_tracked, m_cam, true, m_cMo);
       //vpDisplay::displayFrame(I, m_cMo, m_cam, 0.04, vpColor::none, 3);
@@ -390,6 +421,7 @@ bool vpTemplateLocatization::track(const vpImage<unsigned char> &I)//, vpDetecto
     }
     catch(...) {
       std::cout << "Exception init tracking" << std::endl;
+      m_templates.invalidate(m_model);
       m_state = detection;
       m_target_found = false;
     }
@@ -397,19 +429,19 @@ bool vpTemplateLocatization::track(const vpImage<unsigned char> &I)//, vpDetecto
   else if (m_state == tracking) {
     try {
       //vpDisplay::displayText(I, 40,10, "state: tracking", vpColor::red);
-      m_tracker->track(I);
+      const vpImage<unsigned char> &B = frame.getBlurredLevel(m_templateLevel);
+      m_tracker->track(B);
 
       //m_tracker->display(I, vpColor::blue);
 
       // Instantiate and get the reference zone
       p = m_tracker->getp();
       m_warp.warpZone(m_zone_ref, p, zone_cur);
-      m_area_zone_cur = zone_cur.getArea();
 
-      double size_percent = 0.95;
       double max_target_size = I.getSize()/4;
-      if (m_area_zone_cur/m_area_zone_prev < size_percent || m_area_zone_cur/m_area_zone_prev > (1+size_percent)) {
-        //          std::cout << "reinit caused by size" << std::endl;
+      if (! m_quality.update(*m_tracker, m_zone_ref, zone_cur)) {
+        //          std::cout << "reinit caused by the tracking quality" << std::endl;
+        m_templates.invalidate(m_model);
         m_state = detection;
         m_target_found = false;
       }
@@ -419,7 +451,7 @@ bool vpTemplateLocatization::track(const vpImage<unsigned char> &I)//, vpDetecto
       //        m_target_found = false;
       //      }
       else {
-        m_corners_tracked = getTemplateTrackerCorners(zone_cur);
+        m_corners_tracked = vpFrameContext::pyramidUp(getTemplateTrackerCorners(zone_cur), m_templateLevel);
         m_corners_tracked = orderPointsFromIndexes(m_corners_tracked_index, m_corners_tracked);
         computePose(m_P, m_corners_tracked, m_cam, false, m_cMo);
 
@@ -435,11 +467,10 @@ bool vpTemplateLocatization::track(const vpImage<unsigned char> &I)//, vpDetecto
         m_target_found = true;
       }
 
-      m_area_zone_prev = m_area_zone_cur;
-
     }
     catch(...) {
       std::cout << "Exception tracking" << std::endl;
+      m_templates.invalidate(m_model);
       m_state = detection;
       m_target_found = false;
     }
@@ -447,6 +478,41 @@ bool vpTemplateLocatization::track(const vpImage<unsigned char> &I)//, vpDetecto
   return m_target_found;
 }
 
+/*!
+  Start the tracker of the cached template of the model from the detected corners, instead of
+  building the template from the frame.
+  \param I : Level of the pyramid of the frame where the template is tracked, blurred by
+  vpFrameContext::getBlurredLevel().
+  \return true if the template is tracked from the cache.
+  */
+bool vpTemplateLocatization::reuseTemplate(const vpImage<unsigned char> &I)
+{
+  vpTemplateCache::Reference *reference = m_templates.find(m_model);
+  vpColVector p;
+  if (reference == NULL || ! m_templates.initialWarp(*reference, m_corners_detected, m_templateLevel, m_warp, p))
+    return false;
+
+  std::vector<vpImagePoint> corners;
+  try {
+    reference->tracker->setp(p);
+    reference->tracker->track(I);
+    p = reference->tracker->getp();
+    m_warp.warpZone(reference->zone, p, zone_cur);
+    corners = orderPointsFromIndexes(reference->indexes, vpFrameContext::pyramidUp(getTemplateTrackerCorners(zone_cur), m_templateLevel));
+  }
+  catch(...) {
+    corners.clear();
+  }
+  if (! m_templates.accept(*reference, corners, m_corners_detected))
+    return false;
+
+  m_tracker = reference->tracker;
+  m_zone_ref = reference->zone;
+  m_corners_tracked = corners;
+  m_corners_tracked_index = reference->indexes;
+  return true;
+}
+
 std::vector<vpImagePoint> vpTemplateLocatization::getTemplateTrackerCorners(const vpTemplateTrackerZone &zone)
 {
   std::vector<vpImagePoint> corners_tracked;
@@ -506,16 +572,19 @@ std::vector<vpImagePoint> vpTemplateLocatization::orderPointsFromIndexes(const s
 void vpTemplateLocatization::computePose(std::vector<vpPoint> &point, const std::vector<vpImagePoint> &corners,
                                          const vpCameraParameters &cam, bool init, vpHomogeneousMatrix &cMo)
 {
-  vpPose pose;
   double x=0, y=0;
   for (unsigned int i=0; i < point.size(); i ++) {
     vpPixelMeterConversion::convertPoint(cam, corners[i], x, y);
     point[i].set_x(x);
     point[i].set_y(y);
-    pose.addPoint(point[i]);
   }
+  m_poseSolver.setPoints(point);
 
-  if (init) {
+  // Closed-form initial pose of the planar target, vpPose for the other models
+  if (init && !m_poseSolver.initPose(cMo)) {
+    vpPose pose;
+    for (unsigned int i=0; i < point.size(); i ++)
+      pose.addPoint(point[i]);
     vpHomogeneousMatrix cMo_dementhon, cMo_lagrange;
     pose.computePose(vpPose::DEMENTHON_VIRTUAL_VS, cMo_dementhon);
     double residual_dementhon = pose.computeResidual(cMo_dementhon);
@@ -527,7 +596,13 @@ void vpTemplateLocatization::computePose(std::vector<vpPoint> &point, const std:
       cMo = cMo_lagrange;
   }
 
-  pose.computePose(vpPose::VIRTUAL_VS, cMo) ;
+  // Same minimisation as vpPose::VIRTUAL_VS, without allocation
+  m_poseSolver.computePose(cMo);
+
+  // Time of the frame, the pose being computed after its processing
+  if (m_filterPose)
+    m_poseFilter.update(cMo, m_poseSolver.getCovariance(0.5 / cam.get_px()), m_frameTime >= 0 ? m_frameTime : vpTime::measureTimeMs());
+  m_frameTime = -1;
 }
 
 
@@ -8,10 +8,16 @@
 #include <visp/vpDetectorDataMatrixCode.h>
 #include <visp/vpDetectorQRCode.h>
 #include <visp/vpPose.h>
-#include <visp/vpTemplateTrackerSSDInverseCompositional.h>
 #include <visp/vpTemplateTrackerWarpHomography.h>
 #include <visp/vpPixelMeterConversion.h>
 
+#include <vpFrameContext.h>
+#include <vpPointPoseSolver.h>
+#include <vpPoseFilter.h>
+#include <vpTemplateCache.h>
+#include <vpTemplateTrackerResidual.h>
+#include <vpTrackingQuality.h>
+
 
 class vpTemplateLocatization
 {
@@ -28,9 +34,10 @@ protected:
 
   //template tracker
   vpTemplateTrackerWarpHomography m_warp;
-  vpTemplateTrackerSSDInverseCompositional *m_tracker;
+  vpTemplateTrackerResidual *m_tracker; // Tracker of the template of m_model, owned by m_templates
+  vpTemplateCache m_templates; // Template of the model, kept between the detections
+  vpTrackingQuality m_quality; // Quality of the template tracking, that decides when the template is lost
   vpTemplateTrackerZone m_zone_ref, zone_cur;
-  double m_area_m_zone_ref, m_area_zone_cur, m_area_zone_prev;
 
   state_t m_state;
   std::vector<vpImagePoint> m_corners_detected;
@@ -41,6 +48,10 @@ protected:
   std::vector<vpPoint> m_P; // Points of the qrcode model
   vpCameraParameters m_cam;
   vpHomogeneousMatrix m_cMo;
+  vpPointPoseSolver m_poseSolver; // Pose of the planar model, initialized in closed form
+  vpPoseFilter m_poseFilter; // Filtered pose, updated when m_filterPose is set
+  bool m_filterPose;
+  double m_frameTime; // Time given to setFrameTime(), negative when none
   //bool m_force_detection;
   std::string m_message;
 
@@ -61,6 +72,9 @@ protected:
   bool (*m_checkValiditycMo)(vpHomogeneousMatrix);
   bool verbose;
 
+  vpFrameContext m_frame; // Context of the frames given without one to track()
+  unsigned int m_templateLevel; // Level of the pyramid where the template is tracked
+
 public:
 
   /*!
@@ -73,6 +87,37 @@ public:
 
   vpHomogeneousMatrix get_cMo() const {return m_cMo;}
 
+  vpPoseFilter &getPoseFilter() { return m_poseFilter; }
+
+  /*!
+    Template of the model, reused when it is detected again.
+    */
+  vpTemplateCache &getTemplateCache() { return m_templates; }
+
+  /*!
+    Quality of the tracking of the template in the last frame, with its thresholds and the
+    histogram of its scores.
+    */
+  vpTrackingQuality &getTrackingQuality() { return m_quality; }
+
+  /*!
+    Filter the pose with getPoseFilter() at each frame where the target is tracked, with the
+    covariance given by the pose solver. Disabled by default.
+    */
+  void setPoseFiltering(const bool &enable)
+  {
+    m_filterPose = enable;
+    if (!enable)
+      m_poseFilter.reset();
+  }
+
+  /*!
+    Capture time of the frame given to the next track(), in ms like vpTime::measureTimeMs(), used
+    to update getPoseFilter(). It is used for the next pose only. Without it, the filter is
+    updated with the time of the pose computation, which adds the latency of the processing.
+    */
+  void setFrameTime(const double &time) { m_frameTime = time; }
+
   /*!
     Return the center of gravity location of the tracked bar code.
     */
@@ -99,6 +144,7 @@ public:
 
   bool track(const vpImage<unsigned char> &I);
   bool track(const vpImage<unsigned char> &I, vpDetectorBase *&detector );
+  bool track(vpFrameContext &frame);
 
   bool isIdentity (const vpHomogeneousMatrix &A) const;
 
@@ -111,6 +157,7 @@ public:
 
 
 private:
+  bool reuseTemplate(const vpImage<unsigned char> &I);
   std::vector<vpImagePoint> getTemplateTrackerCorners(const vpTemplateTrackerZone &zone);
 
   std::vector<int> computedTemplateTrackerCornersIndexes(const std::vector<vpImagePoint> &corners_detected,
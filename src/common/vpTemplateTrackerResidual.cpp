@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Template tracker giving the residual of its last iteration.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+
+#include <visp/vpImageFilter.h>
+#include <visp/vpTrackingException.h>
+
+#include <vpTemplateTrackerResidual.h>
+
+/*!
+  Constructor.
+  \param warp : Warp of the tracker, not owned.
+ */
+vpTemplateTrackerResidual::vpTemplateTrackerResidual(vpTemplateTrackerWarp *warp)
+  : vpTemplateTrackerSSDInverseCompositional(warp), m_residual(0), m_validRatio(0)
+{
+}
+
+/*!
+  Iterations of vpTemplateTrackerSSDInverseCompositional::trackNoPyr(), the squared differences
+  of the last one being kept.
+ */
+void vpTemplateTrackerResidual::trackNoPyr(const vpImage<unsigned char> &I)
+{
+  if (useBrent) {
+    vpTemplateTrackerSSDInverseCompositional::trackNoPyr(I);
+    const double ssd = getSSD(I, p);
+    m_validRatio = getRatioPixelIn();
+    m_residual = std::sqrt(ssd);
+    return;
+  }
+
+  if (blur)
+    vpImageFilter::filter(I, BI, fgG, taillef);
+
+  vpColVector dpinv(nbParam);
+  unsigned int iteration = 0;
+  double evolRMS_init = 0, evolRMS_prec = 0, evolRMS_delta = 0;
+  initPosEvalRMS(p);
+  do {
+    unsigned int nb_points = 0, nb_in = 0;
+    double sum = 0;
+    dp = 0;
+    Warp->computeCoeff(p);
+    for (unsigned int point = 0; point < templateSize; point++) {
+      if (useTemplateSelect && ! ptTemplateSelect[point])
+        continue;
+      nb_points++;
+      vpTemplateTrackerPoint *pt = &ptTemplate[point];
+      X1[0] = pt->x;
+      X1[1] = pt->y;
+      Warp->computeDenom(X1, p);
+      Warp->warpX(X1, X2, p);
+      const double j2 = X2[0], i2 = X2[1];
+      if (i2 >= 0 && j2 >= 0 && i2 < I.getHeight() - 1 && j2 < I.getWidth() - 1) {
+        const double IW = blur ? BI.getValue(i2, j2) : I.getValue(i2, j2);
+        const double er = pt->val - IW;
+        nb_in++;
+        sum += er * er;
+        for (unsigned int it = 0; it < nbParam; it++)
+          dp[it] += er * pt->HiG[it];
+      }
+    }
+    if (nb_in == 0)
+      throw vpTrackingException(vpTrackingException::notEnoughPointError, "No points in the template");
+
+    m_residual = std::sqrt(sum / nb_in);
+    m_validRatio = (double)nb_in / nb_points;
+
+    dp = gain * dp;
+    Warp->getParamInverse(dp, dpinv);
+    Warp->pRondp(p, dpinv, p);
+    iteration++;
+
+    // Same stop criterion as ViSP, on the displacement of the corners of the zone
+    computeEvalRMS(p);
+    if (iteration == 1)
+      evolRMS_init = evolRMS;
+    evolRMS_delta = std::fabs(evolRMS - evolRMS_prec);
+    evolRMS_prec = evolRMS;
+  } while (iteration < iterationMax && evolRMS_delta > std::fabs(evolRMS_init) * evolRMS_eps);
+
+  nbIteration = iteration;
+}
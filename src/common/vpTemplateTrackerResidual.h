@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Template tracker giving the residual of its last iteration.
+ *
+ *****************************************************************************/
+#ifndef __vpTemplateTrackerResidual_h__
+#define __vpTemplateTrackerResidual_h__
+
+#include <visp/vpImage.h>
+#include <visp/vpTemplateTrackerSSDInverseCompositional.h>
+#include <visp/vpTemplateTrackerWarp.h>
+
+/*!
+  vpTemplateTrackerSSDInverseCompositional that keeps the residual of its last iteration, used by
+  vpTrackingQuality instead of warping the template once more with getSSD().
+
+  Each iteration of the inverse compositional scheme already computes the difference between the
+  template and the warped frame on every point of the template. trackNoPyr() does the same
+  iterations as the tracker of ViSP, with the same stop criterion, and also sums the squared
+  differences and counts the points warped inside the frame. The residual is the one of the
+  parameters at the start of the last iteration: it differs from the one of the final parameters
+  by the last increment, which is small once the tracker has converged.
+
+  When the Brent gain is enabled with setUseBrent(), the iterations of the tracker of ViSP are run
+  and the residual is computed with getSSD().
+ */
+class vpTemplateTrackerResidual : public vpTemplateTrackerSSDInverseCompositional
+{
+protected:
+  double m_residual; //!< RMS of the differences of the last iteration, in gray levels
+  double m_validRatio; //!< Ratio of the points of the template warped inside the frame at the last iteration
+
+  void trackNoPyr(const vpImage<unsigned char> &I);
+
+public:
+  explicit vpTemplateTrackerResidual(vpTemplateTrackerWarp *warp);
+  virtual ~vpTemplateTrackerResidual() {}
+
+  /*!
+    RMS of the differences between the template and the frame at the last iteration of track(),
+    in gray levels.
+    */
+  double getResidual() const { return m_residual; }
+
+  /*!
+    Ratio of the points of the template warped inside the frame at the last iteration of track().
+    */
+  double getValidRatio() const { return m_validRatio; }
+};
+
+#endif
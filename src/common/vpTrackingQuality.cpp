@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Quality of the tracking of a template, from the residual and the warp of the tracker.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+#include <visp/vpTemplateTrackerTriangle.h>
+#include <visp/vpTime.h>
+
+#include <vpTrackingQuality.h>
+
+const unsigned int vpTrackingQuality::nbBins;
+
+/*!
+  Default constructor, with an empty histogram.
+ */
+vpTrackingQuality::vpTrackingQuality()
+  : m_residual(0), m_validRatio(0), m_conditioning(1), m_score(0), m_residualScale(0.25),
+    m_minScore(0.3), m_minValidRatio(0.5), m_maxConditioning(4.), m_histogram(nbBins, 0), m_nbLosses(0),
+    m_time(0)
+{
+}
+
+/*!
+  Conditioning of a warp, the largest ratio of the singular values of the affine transformation
+  from a triangle of the reference zone to the same triangle of the warped zone.
+  \param zone_ref : Reference zone of the tracker.
+  \param zone_cur : Reference zone warped with the current parameters.
+  \return The conditioning, infinite if a triangle degenerates.
+ */
+double vpTrackingQuality::computeConditioning(const vpTemplateTrackerZone &zone_ref, const vpTemplateTrackerZone &zone_cur)
+{
+  double conditioning = 1.;
+  for (int i = 0; i < zone_ref.getNbTriangle() && i < zone_cur.getNbTriangle(); i++) {
+    vpTemplateTrackerTriangle triangle_ref, triangle_cur;
+    zone_ref.getTriangle(i, triangle_ref);
+    zone_cur.getTriangle(i, triangle_cur);
+    std::vector<vpImagePoint> a, b;
+    triangle_ref.getCorners(a);
+    triangle_cur.getCorners(b);
+
+    // M such that [b1-b0, b2-b0] = M [a1-a0, a2-a0]
+    const double a11 = a[1].get_u() - a[0].get_u(), a12 = a[2].get_u() - a[0].get_u();
+    const double a21 = a[1].get_v() - a[0].get_v(), a22 = a[2].get_v() - a[0].get_v();
+    const double b11 = b[1].get_u() - b[0].get_u(), b12 = b[2].get_u() - b[0].get_u();
+    const double b21 = b[1].get_v() - b[0].get_v(), b22 = b[2].get_v() - b[0].get_v();
+    const double det_a = a11 * a22 - a12 * a21;
+    if (std::fabs(det_a) < std::numeric_limits<double>::epsilon())
+      continue;
+    const double m11 = ( b11 * a22 - b12 * a21) / det_a, m12 = (-b11 * a12 + b12 * a11) / det_a;
+    const double m21 = ( b21 * a22 - b22 * a21) / det_a, m22 = (-b21 * a12 + b22 * a11) / det_a;
+
+    // Singular values of the 2x2 matrix
+    const double s = m11 * m11 + m12 * m12 + m21 * m21 + m22 * m22;
+    const double det = std::fabs(m11 * m22 - m12 * m21);
+    const double delta = std::sqrt(std::max(0., s * s - 4 * det * det));
+    const double sigma_min2 = (s - delta) / 2;
+    if (sigma_min2 <= 0)
+      return std::numeric_limits<double>::infinity();
+    conditioning = std::max(conditioning, std::sqrt((s + delta) / 2 / sigma_min2));
+  }
+  return conditioning;
+}
+
+/*!
+  Number of frames in the histogram.
+ */
+unsigned long vpTrackingQuality::getNbFrames() const
+{
+  unsigned long nb = 0;
+  for (size_t i = 0; i < m_histogram.size(); i++)
+    nb += m_histogram[i];
+  return nb;
+}
+
+/*!
+  Print the histogram of the scores, one line per bin with its number and ratio of frames, and
+  the number of losses.
+ */
+void vpTrackingQuality::printHistogram(std::ostream &os) const
+{
+  const unsigned long nb = getNbFrames();
+  const std::streamsize precision = os.precision();
+  for (unsigned int i = 0; i < nbBins; i++) {
+    os << "[" << std::fixed << std::setprecision(1) << (double)i / nbBins << ", " << (double)(i + 1) / nbBins << "): "
+       << m_histogram[i];
+    if (nb > 0)
+      os << " (" << std::setprecision(1) << 100. * m_histogram[i] / nb << "%)";
+    os << std::endl;
+  }
+  os.unsetf(std::ios_base::floatfield);
+  os.precision(precision);
+  os << "Lost on " << m_nbLosses << "/" << nb << " frames" << std::endl;
+}
+
+/*!
+  Empty the histogram of the scores and reset the time of getTime().
+ */
+void vpTrackingQuality::resetHistogram()
+{
+  m_histogram.assign(nbBins, 0);
+  m_nbLosses = 0;
+  m_time = 0;
+}
+
+/*!
+  Compute the quality of the last tracking of a template, and add its score to the histogram.
+  \param tracker : Tracker, after its tracking.
+  \param zone_ref : Reference zone of the tracker.
+  \param zone_cur : Reference zone warped with the parameters of the tracker.
+  \return false if the target is lost.
+ */
+bool vpTrackingQuality::update(const vpTemplateTrackerResidual &tracker, const vpTemplateTrackerZone &zone_ref,
+                               const vpTemplateTrackerZone &zone_cur)
+{
+  const double t = vpTime::measureTimeMs();
+
+  // Differences of the last iteration of the tracker, on the pixels warped inside the frame
+  m_validRatio = tracker.getValidRatio();
+  m_residual = m_validRatio > 0 ? tracker.getResidual() / 255. : 1.;
+  m_conditioning = computeConditioning(zone_ref, zone_cur);
+  m_score = m_validRatio * std::max(0., 1. - m_residual / m_residualScale) / m_conditioning;
+
+  const unsigned int bin = std::min(nbBins - 1, (unsigned int)(m_score * nbBins));
+  m_histogram[bin]++;
+
+  const bool found = m_score >= m_minScore && m_validRatio >= m_minValidRatio && m_conditioning <= m_maxConditioning;
+  if (!found)
+    m_nbLosses++;
+  m_time += vpTime::measureTimeMs() - t;
+  return found;
+}
@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Quality of the tracking of a template, from the residual and the warp of the tracker.
+ *
+ *****************************************************************************/
+#ifndef __vpTrackingQuality_h__
+#define __vpTrackingQuality_h__
+
+#include <iostream>
+#include <vector>
+
+#include <visp/vpTemplateTrackerZone.h>
+
+#include <vpTemplateTrackerResidual.h>
+
+/*!
+  Per-frame quality of a template tracker, used by vpQRCodeTracker, vpFaceTracker and
+  vpTemplateLocatization to decide when the target is lost.
+
+  The quality is computed after the tracking:
+  - the residual, the RMS of the difference between the template and the warped frame at the
+    last iteration of vpTemplateTrackerResidual, divided by 255;
+  - the ratio of the pixels of the template that are warped inside the frame at this iteration;
+  - the conditioning of the warp, the ratio of the largest to the smallest singular value of the
+    affine transformation of the triangles of the reference zone. It is 1 for a similarity and
+    grows when the warp degenerates.
+
+  The score is in [0, 1]:
+  \f[ s = \frac{\rho \, \max(0, 1 - r / r_{max})}{c} \f]
+  with \f$ \rho \f$ the ratio of valid pixels, \f$ r \f$ the residual, \f$ r_{max} \f$ the value
+  of setResidualScale() and \f$ c \f$ the conditioning. The target is lost when the score is
+  under setMinScore(), when the ratio of valid pixels is under setMinValidRatio() or when the
+  conditioning is over setMaxConditioning().
+
+  The residual and the ratio are kept by the tracker during its iterations, so that the template
+  is not warped once more. getTime() gives the time spent in update(), printed by the
+  qrcode_tracking test next to the tracking time.
+
+  The scores of all the frames are accumulated in a histogram of nbBins bins, printed by
+  printHistogram(), to tune the thresholds.
+ */
+class vpTrackingQuality
+{
+public:
+  static const unsigned int nbBins = 10; //!< Number of bins of the histogram of the scores
+
+protected:
+  double m_residual;
+  double m_validRatio;
+  double m_conditioning;
+  double m_score;
+  double m_residualScale;
+  double m_minScore;
+  double m_minValidRatio;
+  double m_maxConditioning;
+  std::vector<unsigned long> m_histogram; //!< Number of frames in each bin of the scores
+  unsigned long m_nbLosses; //!< Number of frames where the target was lost
+  double m_time; //!< Time spent in update() since the last resetHistogram(), in ms
+
+public:
+  vpTrackingQuality();
+  virtual ~vpTrackingQuality() {}
+
+  static double computeConditioning(const vpTemplateTrackerZone &zone_ref, const vpTemplateTrackerZone &zone_cur);
+
+  double getConditioning() const { return m_conditioning; }
+  const std::vector<unsigned long> &getHistogram() const { return m_histogram; }
+  unsigned long getNbFrames() const;
+  unsigned long getNbLosses() const { return m_nbLosses; }
+  double getResidual() const { return m_residual; }
+  double getScore() const { return m_score; }
+  /*!
+    Time spent in update() since the last resetHistogram(), in ms.
+    */
+  double getTime() const { return m_time; }
+  double getValidRatio() const { return m_validRatio; }
+
+  void printHistogram(std::ostream &os) const;
+  void resetHistogram();
+
+  /*!
+    Largest conditioning of the warp, 4 by default.
+    */
+  void setMaxConditioning(const double &conditioning) { m_maxConditioning = conditioning; }
+
+  /*!
+    Smallest score, 0.3 by default.
+    */
+  void setMinScore(const double &score) { m_minScore = score; }
+
+  /*!
+    Smallest ratio of the pixels of the template warped inside the frame, 0.5 by default.
+    */
+  void setMinValidRatio(const double &ratio) { m_minValidRatio = ratio; }
+
+  /*!
+    Residual, relative to 255, for which the score is 0. 0.25 by default.
+    */
+  void setResidualScale(const double &scale) { m_residualScale = scale; }
+
+  bool update(const vpTemplateTrackerResidual &tracker, const vpTemplateTrackerZone &zone_ref,
+              const vpTemplateTrackerZone &zone_cur);
+};
+
+#endif
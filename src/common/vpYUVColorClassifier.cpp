@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * HSV range classifier working directly on YUV422 (YUYV) camera buffers.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include <vpYUVColorClassifier.h>
+#include <vpColorThreshold.h>
+
+namespace {
+
+// Fixed-point ITU-R BT.601 coefficients of the YUV to RGB conversion in OpenCV
+const int yuv_cy  = 1220542;
+const int yuv_cub = 2116026;
+const int yuv_cug = -409993;
+const int yuv_cvg = -852492;
+const int yuv_cvr = 1673527;
+const int yuv_shift = 20;
+
+inline unsigned char saturateU8(int value)
+{
+  return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+}
+
+/*!
+  Default constructor. Until setValuesHSV() is called, no pixel is accepted.
+ */
+vpYUVColorClassifier::vpYUVColorClassifier()
+  : m_init(false), m_y_min(), m_y_max(), m_mixed(), m_nb_rows(0)
+{
+  for (int c = 0; c < 3; c++) {
+    m_hsv_min[c] = 0;
+    m_hsv_max[c] = -1;
+  }
+}
+
+/*!
+  Convert one YUV triplet to BGR like cv::cvtColor(..., cv::COLOR_YUV2BGR_YUYV).
+ */
+void vpYUVColorClassifier::convertToBGR(int y, int u, int v, unsigned char *bgr)
+{
+  u -= 128;
+  v -= 128;
+  int ruv = (1 << (yuv_shift-1)) + yuv_cvr * v;
+  int guv = (1 << (yuv_shift-1)) + yuv_cvg * v + yuv_cug * u;
+  int buv = (1 << (yuv_shift-1)) + yuv_cub * u;
+  int yy = std::max(0, y - 16) * yuv_cy;
+  bgr[0] = saturateU8((yy + buv) >> yuv_shift);
+  bgr[1] = saturateU8((yy + guv) >> yuv_shift);
+  bgr[2] = saturateU8((yy + ruv) >> yuv_shift);
+}
+
+/*!
+  Copy the luma plane of a YUV422 buffer.
+  \param yuyv : Buffer of width*height*2 bytes, Y0 U Y1 V ordering.
+  \param width, height : Size of the image.
+  \param luma : Buffer of width*height bytes, typically the bitmap of a vpImage<unsigned char>.
+ */
+void vpYUVColorClassifier::extractLuma(const unsigned char *yuyv, int width, int height, unsigned char *luma)
+{
+  const int size = width * height;
+  for (int i = 0; i < size; i++)
+    luma[i] = yuyv[2*i];
+}
+
+/*!
+  Exact test of one YUV triplet.
+ */
+bool vpYUVColorClassifier::isInRange(int y, int u, int v) const
+{
+  unsigned char bgr[3];
+  convertToBGR(y, u, v, bgr);
+  return vpColorThreshold::isInRangeHSV(bgr, m_hsv_min, m_hsv_max);
+}
+
+/*!
+  Set the HSV range. Nothing is done if the range did not change.
+
+  The YUV tables are not built here but by the following calls to buildTable(). In the
+  meantime, threshold() tests the pixels exactly.
+  \param hsv_min : Lower bounds H, S, V (inclusive).
+  \param hsv_max : Upper bounds H, S, V (inclusive).
+ */
+void vpYUVColorClassifier::setValuesHSV(const int hsv_min[3], const int hsv_max[3])
+{
+  if (m_init && std::equal(hsv_min, hsv_min+3, m_hsv_min) && std::equal(hsv_max, hsv_max+3, m_hsv_max))
+    return;
+
+  std::copy(hsv_min, hsv_min+3, m_hsv_min);
+  std::copy(hsv_max, hsv_max+3, m_hsv_max);
+
+  m_y_min.resize(256*256);
+  m_y_max.resize(256*256);
+  m_mixed.resize(256*256);
+  m_nb_rows = 0;
+  m_init = true;
+}
+
+/*!
+  Build the YUV tables of the next \e nb_rows U values. Each U value costs 256*256*256/256
+  exact tests, about 0.6 ms on a desktop CPU. Nothing is done once the tables are complete,
+  see isTableBuilt().
+  \param nb_rows : Number of U values to build, 256 to build the whole table at once.
+ */
+void vpYUVColorClassifier::buildTable(unsigned int nb_rows)
+{
+  if (!m_init)
+    return;
+
+  const unsigned int last_row = std::min(256u, m_nb_rows + nb_rows);
+  for (int u = (int)m_nb_rows; u < (int)last_row; u++) {
+    for (int v = 0; v < 256; v++) {
+      int first = -1, last = -1, count = 0;
+      for (int y = 0; y < 256; y++) {
+        if (isInRange(y, u, v)) {
+          if (first < 0)
+            first = y;
+          last = y;
+          count++;
+        }
+      }
+      unsigned int index = (u << 8) | v;
+      if (first < 0) {
+        // Empty interval
+        m_y_min[index] = 255;
+        m_y_max[index] = 0;
+        m_mixed[index] = 0;
+      }
+      else {
+        m_y_min[index] = (unsigned char)first;
+        m_y_max[index] = (unsigned char)last;
+        m_mixed[index] = (count != last - first + 1);
+      }
+    }
+  }
+  m_nb_rows = last_row;
+}
+
+/*!
+  Test of one YUV triplet with the tables when they are built for \e u, exactly otherwise.
+ */
+inline bool vpYUVColorClassifier::accept(int y, int u, int v) const
+{
+  if (!m_init)
+    return false;
+  if ((unsigned int)u >= m_nb_rows)
+    return isInRange(y, u, v);
+
+  const unsigned int index = (u << 8) | v;
+  if (m_mixed[index])
+    return isInRange(y, u, v);
+  return y >= m_y_min[index] && y <= m_y_max[index];
+}
+
+/*!
+  Compute the binary mask of a YUV422 buffer.
+
+  \param yuyv : Buffer of width*height*2 bytes, Y0 U Y1 V ordering. The width has to be even.
+  \param width, height : Size of the image.
+  \param mask : Output mask of type CV_8UC1, 255 where the pixel is in the range, 0 otherwise.
+  \param luma : If not NULL, a buffer of width*height bytes where the luma plane is copied,
+  typically the bitmap of a vpImage<unsigned char>.
+ */
+void vpYUVColorClassifier::threshold(const unsigned char *yuyv, int width, int height, cv::Mat &mask,
+                                     unsigned char *luma) const
+{
+  threshold(yuyv, width, height, cv::Rect(0, 0, width, height), mask, luma);
+}
+
+/*!
+  Same as threshold(const unsigned char *, int, int, cv::Mat &, unsigned char *) but only
+  the area \e roi of the image is processed.
+
+  \param yuyv : Buffer of width*height*2 bytes, Y0 U Y1 V ordering. The width has to be even.
+  \param width, height : Size of the image.
+  \param roi : Area to process, inside the image. Its position does not need to be even.
+  \param mask : Output mask of type CV_8UC1 with the size of \e roi.
+  \param luma : If not NULL, a buffer of width*height bytes where the luma of \e roi is copied.
+  The pixels outside \e roi are left unchanged.
+ */
+void vpYUVColorClassifier::threshold(const unsigned char *yuyv, int width, int height, const cv::Rect &roi,
+                                     cv::Mat &mask, unsigned char *luma) const
+{
+  CV_Assert(width % 2 == 0);
+  CV_Assert((roi & cv::Rect(0, 0, width, height)) == roi);
+  mask.create(roi.height, roi.width, CV_8UC1);
+
+  for (int i = 0; i < roi.height; i++) {
+    const unsigned char *src = yuyv + 2*(roi.y+i)*width;
+    unsigned char *dst = mask.ptr<unsigned char>(i);
+    unsigned char *lum = luma ? luma + (roi.y+i)*width : NULL;
+    for (int j = 0; j < roi.width; j++) {
+      const int x = roi.x + j;
+      // U and V are shared by the pixels 2k and 2k+1
+      const unsigned char *pair = src + 4*(x/2);
+      const int y = src[2*x];
+      dst[j] = accept(y, pair[1], pair[3]) ? 255 : 0;
+      if (lum)
+        lum[x] = (unsigned char)y;
+    }
+  }
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * HSV range classifier working directly on YUV422 (YUYV) camera buffers.
+ *
+ *****************************************************************************/
+#ifndef __vpYUVColorClassifier_h__
+#define __vpYUVColorClassifier_h__
+
+#include <vector>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+/*!
+  Classify the pixels of a YUV422 buffer (Y0 U Y1 V, the kYUV422ColorSpace of the
+  Romeo cameras) against an HSV range, without converting the buffer to BGR.
+
+  A pixel is accepted if the BGR color obtained with the ITU-R BT.601 conversion of
+  OpenCV (cv::COLOR_YUV2BGR_YUYV) is in the HSV range, exactly as vpColorThreshold
+  would accept it.
+
+  The HSV range is translated into a table giving for each (U,V) chroma pair the
+  interval of luma values that pass. For a few chroma pairs close to saturation the
+  accepted luma values are not an interval: they are flagged and tested exactly.
+
+  Building the whole table tests the 256^3 YUV triplets (about 150 ms on a desktop
+  CPU), which would stall the loop each time the range is tuned with the trackbars.
+  setValuesHSV() only records the range, and buildTable() builds the table a few U
+  values at a time, so that it can be called once per frame. Until the table is
+  complete, the pixels whose U value is not built yet are tested exactly.
+
+  threshold() can copy the luma plane in the same pass. Note that luma uses the
+  [16,235] video range while the BGR to gray conversion of vpImageConvert uses [0,255],
+  so gray level thresholds tuned on converted images may need to be adjusted.
+ */
+class vpYUVColorClassifier
+{
+protected:
+  int m_hsv_min[3];
+  int m_hsv_max[3];
+  bool m_init;
+  std::vector<unsigned char> m_y_min; //!< Minimum luma accepted for each (U,V)
+  std::vector<unsigned char> m_y_max; //!< Maximum luma accepted for each (U,V)
+  std::vector<unsigned char> m_mixed; //!< Non zero when the accepted luma values are not an interval
+  unsigned int m_nb_rows; //!< Number of U values, starting from 0, for which the tables are built
+
+  bool accept(int y, int u, int v) const;
+
+public:
+  vpYUVColorClassifier();
+  virtual ~vpYUVColorClassifier() {}
+
+  void buildTable(unsigned int nb_rows = 256);
+  static void convertToBGR(int y, int u, int v, unsigned char *bgr);
+  static void extractLuma(const unsigned char *yuyv, int width, int height, unsigned char *luma);
+  bool isInRange(int y, int u, int v) const;
+  bool isTableBuilt() const {return m_nb_rows == 256;}
+  void setValuesHSV(const int hsv_min[3], const int hsv_max[3]);
+  void threshold(const unsigned char *yuyv, int width, int height, cv::Mat &mask,
+                 unsigned char *luma = NULL) const;
+  void threshold(const unsigned char *yuyv, int width, int height, const cv::Rect &roi, cv::Mat &mask,
+                 unsigned char *luma = NULL) const;
+};
+
+#endif
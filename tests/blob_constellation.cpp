@@ -0,0 +1,225 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Detection of the blob targets with vpBlobConstellation.
+ *
+ *****************************************************************************/
+
+
+/*! \example blob_constellation.cpp */
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+//Visp
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpMeterPixelConversion.h>
+#include <visp/vpPoint.h>
+
+//RomeoTk
+#include <vpBlobConstellation.h>
+
+#include "blob_test_utils.h"
+
+/*!
+
+   Check vpBlobConstellation on synthetic images. No robot is needed.
+
+   ./blob_constellation [--iter <n>]
+
+   The square target of the hands, with blobs of 1 cm, is drawn with a random pose, together with
+   dark blobs that do not belong to the target. From the blob of the first point, the other blobs
+   are searched in the area given by the constellation, then matched with the model: each blob has
+   to be the projection of its point. A target without symmetry seen from behind is then searched,
+   that has to be rejected unless the constellation is two-sided. Last, two targets are found from their anchors.
+ */
+
+/*!
+  Draw the target with the pose cMo and return the projection of its points.
+ */
+std::vector<vpImagePoint> drawTarget(vpImage<unsigned char> &I, const vpCameraParameters &cam,
+                                     std::vector<vpPoint> points, const vpHomogeneousMatrix &cMo,
+                                     double diameter)
+{
+  std::vector<vpImagePoint> ip(points.size());
+  for (size_t k=0; k < points.size(); k++) {
+    points[k].track(cMo);
+    vpMeterPixelConversion::convertPoint(cam, points[k].get_x(), points[k].get_y(), ip[k]);
+    double radius = 0.5 * diameter * cam.get_px() / points[k].get_Z();
+    drawDisk(I, ip[k].get_u(), ip[k].get_v(), radius, 30);
+  }
+  return ip;
+}
+
+vpDot2 createAnchor(const vpImage<unsigned char> &I, const vpImagePoint &ip)
+{
+  vpDot2 anchor;
+  anchor.setGraphics(false);
+  anchor.setEllipsoidShapePrecision(0.9);
+  anchor.initTracking(I, ip);
+  return anchor;
+}
+
+std::list<vpDot2> searchBlobs(const vpImage<unsigned char> &I, const vpBlobConstellation &constellation,
+                              const vpDot2 &anchor)
+{
+  vpDot2 black_blob = anchor;
+  black_blob.setGrayLevelMin(0);
+  black_blob.setGrayLevelMax(50);
+  vpRect area = constellation.getSearchArea(anchor, I);
+  std::list<vpDot2> candidates;
+  black_blob.searchDotsInArea(I, (int)area.getLeft(), (int)area.getTop(),
+                              (unsigned int)area.getWidth(), (unsigned int)area.getHeight(), candidates);
+  return candidates;
+}
+
+bool checkBlobs(const std::vector<vpDot2> &blobs, const std::vector<vpImagePoint> &ip)
+{
+  if (blobs.size() != ip.size())
+    return false;
+  for (size_t k=0; k < ip.size(); k++)
+    if (vpImagePoint::distance(blobs[k].getCog(), ip[k]) > 1.0)
+      return false;
+  return true;
+}
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 100;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  // Square target of 2.5 cm with blobs of 1 cm, like the hand targets
+  const double L = 0.025/2;
+  const double diameter = 0.01;
+  std::vector<vpPoint> points(4);
+  points[2].setWorldCoordinates(-L,-L, 0);
+  points[1].setWorldCoordinates(-L, L, 0);
+  points[0].setWorldCoordinates( L, L, 0);
+  points[3].setWorldCoordinates( L,-L, 0);
+  vpCameraParameters cam(600, 600, 320, 240);
+
+  vpBlobConstellation constellation;
+  constellation.setModel(points, 0);
+  constellation.setBlobDiameter(diameter);
+
+  int status = 0;
+  srand(0);
+
+  // Random poses, with blobs around the target
+  unsigned int nb_found = 0;
+  for (unsigned int n=0; n < opt_iter; n++) {
+    vpHomogeneousMatrix cMo(randomValue(-0.05, 0.05), randomValue(-0.05, 0.05), randomValue(0.25, 0.6),
+                            vpMath::rad(randomValue(-35, 35)), vpMath::rad(randomValue(-35, 35)), vpMath::rad(randomValue(-180, 180)));
+    vpImage<unsigned char> I(480, 640, 220);
+    std::vector<vpImagePoint> ip = drawTarget(I, cam, points, cMo, diameter);
+    double radius = 0.5 * diameter * cam.get_px() / cMo[2][3];
+    vpImagePoint center = (ip[0] + ip[2]) / 2;
+    for (unsigned int k=0; k < 3; k++) {
+      double angle = randomValue(-M_PI, M_PI);
+      double distance = randomValue(7.5, 9) * radius;
+      drawDisk(I, center.get_u() + distance * cos(angle), center.get_v() + distance * sin(angle), radius, 30);
+    }
+
+    try {
+      vpDot2 anchor = createAnchor(I, ip[0]);
+      std::list<vpDot2> candidates = searchBlobs(I, constellation, anchor);
+      std::vector<vpDot2> blobs;
+      if (constellation.match(anchor, candidates, blobs) && checkBlobs(blobs, ip))
+        nb_found++;
+    }
+    catch(vpException &e) {
+      std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    }
+  }
+  std::cout << "Targets found: " << nb_found << "/" << opt_iter << std::endl;
+  if (nb_found != opt_iter)
+    status = 1;
+
+  // A target without symmetry seen from behind, drawn with its points mirrored
+  std::vector<vpPoint> asymmetric(4);
+  asymmetric[0].setWorldCoordinates(0, 0, 0);
+  asymmetric[1].setWorldCoordinates(0.03, 0, 0);
+  asymmetric[2].setWorldCoordinates(0.02, 0.025, 0);
+  asymmetric[3].setWorldCoordinates(0, 0.015, 0);
+  std::vector<vpPoint> mirrored = asymmetric;
+  for (size_t k=0; k < mirrored.size(); k++)
+    mirrored[k].setWorldCoordinates(mirrored[k].get_oX(), -mirrored[k].get_oY(), 0);
+  vpBlobConstellation asymmetric_constellation;
+  asymmetric_constellation.setModel(asymmetric, 0);
+  asymmetric_constellation.setBlobDiameter(diameter);
+
+  vpImage<unsigned char> I(480, 640, 220);
+  std::vector<vpImagePoint> ip = drawTarget(I, cam, mirrored, vpHomogeneousMatrix(0, 0, 0.4, 0, 0, vpMath::rad(20)), diameter);
+  vpDot2 anchor = createAnchor(I, ip[0]);
+  std::list<vpDot2> candidates = searchBlobs(I, asymmetric_constellation, anchor);
+  std::vector<vpDot2> blobs;
+  bool front = asymmetric_constellation.match(anchor, candidates, blobs);
+  asymmetric_constellation.setTwoSided(true);
+  bool two_sided = asymmetric_constellation.match(anchor, candidates, blobs) && checkBlobs(blobs, ip);
+  std::cout << "Target seen from behind: " << (front ? "matched" : "rejected")
+            << ", two-sided: " << (two_sided ? "matched" : "rejected") << std::endl;
+  if (front || !two_sided)
+    status = 1;
+
+  // Two targets found from their anchors, without sharing blobs
+  I = 220;
+  std::vector<std::vector<vpImagePoint> > ip_targets;
+  ip_targets.push_back(drawTarget(I, cam, points, vpHomogeneousMatrix(-0.03, 0, 0.4, 0, 0, vpMath::rad(10)), diameter));
+  ip_targets.push_back(drawTarget(I, cam, points, vpHomogeneousMatrix( 0.03, 0, 0.4, 0, 0, vpMath::rad(-15)), diameter));
+  std::vector<vpDot2> anchors;
+  candidates.clear();
+  for (size_t t=0; t < ip_targets.size(); t++) {
+    anchors.push_back(createAnchor(I, ip_targets[t][0]));
+    std::list<vpDot2> found = searchBlobs(I, constellation, anchors[t]);
+    candidates.insert(candidates.end(), found.begin(), found.end());
+  }
+  std::vector<std::vector<vpDot2> > instances;
+  unsigned int nb_instances = constellation.match(anchors, candidates, instances);
+  bool instances_ok = (nb_instances == 2);
+  for (size_t t=0; t < ip_targets.size() && instances_ok; t++)
+    instances_ok = checkBlobs(instances[t], ip_targets[t]);
+  std::cout << "Two targets: " << nb_instances << " found" << (instances_ok ? "" : ", wrong blobs") << std::endl;
+  if (!instances_ok)
+    status = 1;
+
+  return status;
+}
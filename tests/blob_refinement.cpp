@@ -0,0 +1,205 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Accuracy and cost of the sub-pixel centers of vpBlobRefiner.
+ *
+ *****************************************************************************/
+
+
+/*! \example blob_refinement.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Visp
+#include <visp/vpDot2.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpBlobRefiner.h>
+
+#include "blob_test_utils.h"
+
+/*!
+
+   Compare the centers of the blobs given by vpBlobRefiner with the ones of vpDot2 on synthetic
+   frames. No robot is needed.
+
+   ./blob_refinement [--iter <n>] [--radius <pixels>]
+
+   At each iteration a dark disk, anti-aliased, is drawn at a random sub-pixel position on a
+   bright background with a gaussian noise of 2 gray levels, then tracked with vpDot2 and refined.
+   The refined center has to be closer to the true one than the center of vpDot2, the variance
+   given by the refiner has to be consistent with the errors and the ellipse has to match the disk.
+
+   Then a target of four such disks is tracked with vpBlobsTargetTracker::track(), the sub-pixel
+   refinement being enabled, and the time of the refinement of the four blobs is printed with its
+   ratio to the time of the whole track(), vpDot2::track() and pose included. This ratio should
+   stay under 5%, but it depends on the machine and on its load, so it is printed, not checked.
+ */
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 200;
+  double opt_radius = 7.;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--radius")
+      opt_radius = atof(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>] [--radius <pixels>]" << std::endl;
+      return 0;
+    }
+  }
+
+  const double sigma = 2.;
+  vpImage<unsigned char> I(80, 80);
+  vpBlobRefiner refiner;
+  refiner.setGrayLevelNoise(sigma);
+
+  int status = 0;
+  try {
+    srand(0);
+    double err_dot = 0, err_refined = 0, nees = 0, t_track = 0, t_refine = 0;
+    double max_axis_error = 0;
+    unsigned int nb = 0;
+    for (unsigned int n=0; n < opt_iter; n++) {
+      vpImagePoint cog(40. + rand() / (double)RAND_MAX - 0.5, 40. + rand() / (double)RAND_MAX - 0.5);
+      drawAntiAliasedDisk(I, cog.get_u(), cog.get_v(), opt_radius, 220., 30., sigma);
+
+      vpDot2 dot;
+      dot.setGraphics(false);
+      dot.setGrayLevelMin(0);
+      dot.setGrayLevelMax(125);
+      double t = vpTime::measureTimeMs();
+      dot.initTracking(I, vpImagePoint(40, 40));
+      dot.track(I);
+      t_track += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      bool refined = refiner.refine(I, dot);
+      t_refine += vpTime::measureTimeMs() - t;
+      if (!refined) {
+        std::cout << "Blob " << n << " not refined" << std::endl;
+        status = 1;
+        continue;
+      }
+
+      err_dot += vpImagePoint::sqrDistance(dot.getCog(), cog);
+      err_refined += vpImagePoint::sqrDistance(refiner.getCog(), cog);
+      vpMatrix covariance = refiner.getCovariance();
+      nees += vpMath::sqr(refiner.getCog().get_u() - cog.get_u()) / covariance[0][0]
+          + vpMath::sqr(refiner.getCog().get_v() - cog.get_v()) / covariance[1][1];
+
+      double a, b, angle;
+      refiner.getEllipse(a, b, angle);
+      max_axis_error = std::max(max_axis_error, std::max(std::fabs(a - opt_radius), std::fabs(b - opt_radius)));
+      nb++;
+    }
+
+    if (nb == 0)
+      return 1;
+    err_dot = std::sqrt(err_dot / nb);
+    err_refined = std::sqrt(err_refined / nb);
+    nees /= 2 * nb;
+    std::cout << "vpDot2: rms error " << err_dot << " pixel, " << t_track / opt_iter << " ms" << std::endl;
+    std::cout << "vpBlobRefiner: rms error " << err_refined << " pixel, " << t_refine / opt_iter
+              << " ms, normalized squared error " << nees << ", largest error of the axes " << max_axis_error
+              << " pixel" << std::endl;
+    // The variance only accounts for the noise, not for the quantization of the gray levels
+    if (err_refined > 0.5 * err_dot || nees > 3. || nees < 0.3 || max_axis_error > 0.5)
+      status = 1;
+
+    // Square target of 2.5 cm seen at about 40 cm, like the hand targets
+    const double L = 0.025/2;
+    std::vector<vpPoint> points(4);
+    points[2].setWorldCoordinates(-L,-L, 0);
+    points[1].setWorldCoordinates(-L, L, 0);
+    points[0].setWorldCoordinates( L, L, 0);
+    points[3].setWorldCoordinates( L,-L, 0);
+    vpCameraParameters cam(600, 600, 160, 120);
+
+    std::vector<vpImagePoint> cogs_ref;
+    cogs_ref.push_back(vpImagePoint(105, 181));
+    cogs_ref.push_back(vpImagePoint(142, 177));
+    cogs_ref.push_back(vpImagePoint(138, 137));
+    cogs_ref.push_back(vpImagePoint(101, 142));
+    vpImage<unsigned char> J(240, 320);
+    drawAntiAliasedDisks(J, cogs_ref, opt_radius, 220., 30., sigma);
+
+    vpBlobsTargetTrackerTest target;
+    target.setCameraParameters(cam);
+    target.setPoints(points);
+    target.setSubPixelRefinement(true);
+    target.getBlobRefiner().setGrayLevelNoise(sigma);
+    target.initBlobs(J, cogs_ref);
+    target.track(cv::Mat(), J); // Initial pose
+
+    double t_target = 0, t_refine_target = 0;
+    unsigned int nb_tracked = 0;
+    for (unsigned int n=0; n < opt_iter; n++) {
+      vpImagePoint shift(rand() / (double)RAND_MAX - 0.5, rand() / (double)RAND_MAX - 0.5);
+      std::vector<vpImagePoint> cogs(cogs_ref);
+      for (size_t k=0; k < cogs.size(); k++)
+        cogs[k] += shift;
+      drawAntiAliasedDisks(J, cogs, opt_radius, 220., 30., sigma);
+
+      double t = vpTime::measureTimeMs();
+      if (target.track(cv::Mat(), J))
+        nb_tracked++;
+      t_target += vpTime::measureTimeMs() - t;
+
+      // Same refinement as the one done in track(), on the blobs it has just tracked
+      t = vpTime::measureTimeMs();
+      for (unsigned int k=0; k < cogs.size(); k++)
+        refiner.refine(J, target.getBlob(k));
+      t_refine_target += vpTime::measureTimeMs() - t;
+    }
+
+    const double ratio = t_refine_target / t_target;
+    std::cout << "vpBlobsTargetTracker::track(): " << t_target / opt_iter << " ms, refinement of the "
+              << cogs_ref.size() << " blobs " << t_refine_target / opt_iter << " ms (" << 100. * ratio
+              << "%), " << nb_tracked << "/" << opt_iter << " tracked" << std::endl;
+    if (nb_tracked != opt_iter)
+      status = 1;
+  }
+  catch(vpException &e) {
+    std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    status = 1;
+  }
+
+  return status;
+}
@@ -0,0 +1,160 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Synthetic blobs shared by the blob tests.
+ *
+ *****************************************************************************/
+
+#ifndef __blob_test_utils_h__
+#define __blob_test_utils_h__
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//OpenCV
+#include <opencv2/core/core.hpp>
+
+//Visp
+#include <visp/vpDot2.h>
+#include <visp/vpImage.h>
+#include <visp/vpImagePoint.h>
+#include <visp/vpMath.h>
+
+//RomeoTk
+#include <vpBlobsTargetTracker.h>
+
+#include "simulation_test_utils.h"
+
+/*!
+  Fill the disk of center (\e u, \e v) and radius \e radius with \e value, in an image of
+  \e width x \e height pixels stored row by row in \e bitmap. The disk is clipped to the image.
+ */
+template <class Type>
+inline void drawDisk(Type *bitmap, int width, int height, double u, double v, double radius, const Type &value)
+{
+  for (int i = std::max(0, (int)(v - radius - 1)); i <= std::min(height - 1, (int)(v + radius + 1)); i++)
+    for (int j = std::max(0, (int)(u - radius - 1)); j <= std::min(width - 1, (int)(u + radius + 1)); j++)
+      if ((i - v) * (i - v) + (j - u) * (j - u) <= radius * radius)
+        bitmap[i * width + j] = value;
+}
+
+/*!
+  Draw a disk of gray level \e value in \e I.
+ */
+inline void drawDisk(vpImage<unsigned char> &I, double u, double v, double radius, unsigned char value)
+{
+  drawDisk(I.bitmap, (int)I.getWidth(), (int)I.getHeight(), u, v, radius, value);
+}
+
+/*!
+  Draw a disk of color \e color in the BGR image \e I, that has to be continuous.
+ */
+inline void drawDisk(cv::Mat &I, double u, double v, double radius, const cv::Vec3b &color)
+{
+  CV_Assert(I.type() == CV_8UC3 && I.isContinuous());
+  drawDisk(I.ptr<cv::Vec3b>(), I.cols, I.rows, u, v, radius, color);
+}
+
+/*!
+  Draw disks on the whole image \e I, each pixel being weighted by the part it covers, estimated
+  on 16x16 sub-pixels, with a gaussian noise of standard deviation \e sigma on all the pixels.
+  The disks must not overlap.
+ */
+inline void drawAntiAliasedDisks(vpImage<unsigned char> &I, const std::vector<vpImagePoint> &centers, double radius,
+                                 double background, double foreground, double sigma)
+{
+  for (unsigned int i = 0; i < I.getHeight(); i++)
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      double coverage = 0;
+      for (size_t k = 0; k < centers.size(); k++) {
+        const double u = centers[k].get_u(), v = centers[k].get_v();
+        if (std::fabs(i - v) >= radius + 1 || std::fabs(j - u) >= radius + 1)
+          continue;
+        for (unsigned int si = 0; si < 16; si++)
+          for (unsigned int sj = 0; sj < 16; sj++) {
+            double dv = i - 0.5 + (si + 0.5) / 16. - v;
+            double du = j - 0.5 + (sj + 0.5) / 16. - u;
+            if (du * du + dv * dv <= radius * radius)
+              coverage += 1. / 256.;
+          }
+      }
+      double level = background + coverage * (foreground - background) + randomGaussian(sigma);
+      I[i][j] = (unsigned char)std::min(std::max(vpMath::round(level), 0), 255);
+    }
+}
+
+/*!
+  Same as drawAntiAliasedDisks() with a single disk of center (\e u, \e v).
+ */
+inline void drawAntiAliasedDisk(vpImage<unsigned char> &I, double u, double v, double radius, double background,
+                                double foreground, double sigma)
+{
+  drawAntiAliasedDisks(I, std::vector<vpImagePoint>(1, vpImagePoint(v, u)), radius, background, foreground, sigma);
+}
+
+/*!
+  Start the tracking of vpBlobsTargetTracker from known centers of the blobs, without the color
+  detection, and give access to the tracked blobs and to the HSV range of the colored blob.
+ */
+class vpBlobsTargetTrackerTest : public vpBlobsTargetTracker
+{
+public:
+  /*!
+    Track the blobs of centers \e cogs, cogs[k] being the blob of the point k of the target (the
+    colored one first), with the gray levels of the blobs detected by the tracker.
+   */
+  void initBlobs(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &cogs)
+  {
+    m_nbBlobs = 0;
+    for (size_t i=0; i < cogs.size(); i++) {
+      m_blobPoint[m_nbBlobs] = (unsigned int)i;
+      vpDot2 &dot = m_blobs[m_nbBlobs++];
+      dot = vpDot2();
+      dot.initTracking(I, cogs[i], m_grayLevelMinBlob, m_grayLevelMaxBlob);
+    }
+    m_numBlobs = cogs.size();
+    m_state = tracking;
+    m_initPose = true;
+  }
+
+  const vpDot2 &getBlob(unsigned int i) const { return m_blobs[i]; }
+
+  /*!
+    Set the HSV range of the colored blob.
+   */
+  void setValuesHSV(const int hsv_min[3], const int hsv_max[3])
+  {
+    m_colBlob.setValuesHSV(hsv_min[0], hsv_min[1], hsv_min[2], hsv_max[0], hsv_max[1], hsv_max[2]);
+  }
+};
+
+#endif
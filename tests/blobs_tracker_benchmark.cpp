@@ -0,0 +1,333 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Latency and heap allocations of the tracking stage of vpBlobsTargetTracker.
+ *
+ *****************************************************************************/
+
+/*! \example blobs_tracker_benchmark.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+
+//Visp
+#include <visp/vpDisplay.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpRomeoTkConfig.h>
+#include <vpBlobsTargetTracker.h>
+
+#include "blob_test_utils.h"
+
+/*!
+
+   Compare the per frame cost of vpBlobsTargetTracker in the tracking state with the previous
+   implementation, which ordered the blobs with a std::map, built the vertices with push_back(),
+   formatted the labels with std::ostringstream and created a vpPose at each frame.
+   No robot is needed.
+
+   ./blobs_tracker_benchmark [--iter <n>]
+
+   The target is made of four dark blobs drawn in a synthetic image. The ordering and pose stage
+   is timed alone, then the whole track() that also includes vpDot2::track(). The stage has to
+   run without any heap allocation and to give the same pose as the previous implementation.
+
+   Finally two targets are tracked one after the other, then together with
+   vpBlobsTargetTracker::trackTargets() that tracks their eight blobs in parallel. The poses
+   have to be the same.
+
+   The local recovery is checked last: a blob that jumps on another one has to be found again
+   around its projection, while a hidden blob leads to a new detection of the target.
+ */
+
+#if __cplusplus >= 201103L
+#  define VP_NEW_THROW
+#  define VP_DELETE_THROW noexcept
+#else
+#  define VP_NEW_THROW throw(std::bad_alloc)
+#  define VP_DELETE_THROW throw()
+#endif
+
+static unsigned long s_nb_allocations = 0;
+
+void *operator new(std::size_t size) VP_NEW_THROW
+{
+  s_nb_allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (ptr == NULL)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](std::size_t size) VP_NEW_THROW
+{
+  s_nb_allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (ptr == NULL)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) VP_DELETE_THROW
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr) VP_DELETE_THROW
+{
+  free(ptr);
+}
+
+/*!
+  Give access to the tracking stage, and keep the previous implementation as a reference.
+ */
+class vpBlobsTargetTrackerBenchmark : public vpBlobsTargetTrackerTest
+{
+public:
+  bool update(const vpImage<unsigned char> &I) { return updateTarget(I); }
+
+  void collapseBlob(unsigned int i, unsigned int j) { m_blobs[i] = m_blobs[j]; }
+
+  bool updateReference(const vpImage<unsigned char> &I)
+  {
+    m_cog.set_uv(0.0,0.0);
+    for (unsigned int i=0; i < m_nbBlobs; i++)
+      m_cog += m_blobs[i].getCog();
+    m_cog /= m_nbBlobs;
+
+    std::map<double, vpImagePoint> poly_verteces;
+    for (unsigned int i=0; i < m_nbBlobs; i++) {
+      vpImagePoint cog = m_blobs[i].getCog();
+      double theta = atan2(cog.get_v() - m_cog.get_v(), cog.get_u() - m_cog.get_u());
+      poly_verteces.insert(std::pair<double,vpImagePoint>(theta, cog));
+    }
+
+    std::vector<vpImagePoint> poly_vert;
+    int index_first = 0;
+    unsigned int count = 0;
+    for (std::map<double,vpImagePoint>::iterator it = poly_verteces.begin(); it != poly_verteces.end(); ++it) {
+      poly_vert.push_back(it->second);
+      if (m_blobs[0].getCog() == it->second)
+        index_first = count;
+      count++;
+    }
+    std::rotate(poly_vert.begin(), poly_vert.begin() + index_first, poly_vert.end());
+    for (unsigned int j=0; j < poly_vert.size(); j++) {
+      std::ostringstream s;
+      s << j;
+      vpDisplay::displayText(I, poly_vert[j], s.str(), vpColor::green);
+    }
+
+    vpPose pose;
+    double x=0, y=0;
+    for (unsigned int i=0; i < m_P.size(); i++) {
+      vpPixelMeterConversion::convertPoint(m_cam, poly_vert[i], x, y);
+      m_P[i].set_x(x);
+      m_P[i].set_y(y);
+      pose.addPoint(m_P[i]);
+    }
+    pose.computePose(vpPose::VIRTUAL_VS, m_cMo);
+
+    return poly_vert.size() == m_numBlobs;
+  }
+};
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 10000;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  // Square target of 2.5 cm seen at about 40 cm, like the hand targets
+  const double L = 0.025/2;
+  std::vector<vpPoint> points(4);
+  points[2].setWorldCoordinates(-L,-L, 0);
+  points[1].setWorldCoordinates(-L, L, 0);
+  points[0].setWorldCoordinates( L, L, 0);
+  points[3].setWorldCoordinates( L,-L, 0);
+  vpCameraParameters cam(600, 600, 320, 240);
+
+  vpImage<unsigned char> I(480, 640, 220);
+  std::vector<vpImagePoint> cogs;
+  cogs.push_back(vpImagePoint(225, 341));
+  cogs.push_back(vpImagePoint(262, 337));
+  cogs.push_back(vpImagePoint(258, 297));
+  cogs.push_back(vpImagePoint(221, 302));
+  for (size_t i=0; i < cogs.size(); i++)
+    drawDisk(I, cogs[i].get_u(), cogs[i].get_v(), 7, 30);
+
+  vpBlobsTargetTrackerBenchmark tracker;
+  tracker.setCameraParameters(cam);
+  tracker.setPoints(points);
+  tracker.initBlobs(I, cogs);
+  tracker.track(cv::Mat(), I); // Initial pose
+
+  int status = 0;
+
+  // Ordering and pose stage
+  tracker.updateReference(I);
+  vpHomogeneousMatrix cMo_ref = tracker.get_cMo();
+  unsigned long nb_allocations = s_nb_allocations;
+  double t = vpTime::measureTimeMs();
+  for (unsigned int n=0; n < opt_iter; n++)
+    tracker.updateReference(I);
+  double t_ref = (vpTime::measureTimeMs() - t) / opt_iter;
+  double alloc_ref = (double)(s_nb_allocations - nb_allocations) / opt_iter;
+
+  tracker.update(I);
+  vpHomogeneousMatrix cMo = tracker.get_cMo();
+  nb_allocations = s_nb_allocations;
+  t = vpTime::measureTimeMs();
+  for (unsigned int n=0; n < opt_iter; n++)
+    tracker.update(I);
+  double t_new = (vpTime::measureTimeMs() - t) / opt_iter;
+  double alloc_new = (double)(s_nb_allocations - nb_allocations) / opt_iter;
+
+  double pose_error = 0;
+  for (unsigned int i=0; i < 3; i++)
+    for (unsigned int j=0; j < 4; j++)
+      pose_error = std::max(pose_error, std::fabs(cMo[i][j] - cMo_ref[i][j]));
+
+  std::cout << "Ordering and pose, previous: " << 1000. * t_ref << " us " << alloc_ref << " allocations per call" << std::endl;
+  std::cout << "Ordering and pose, current: " << 1000. * t_new << " us " << alloc_new << " allocations per call"
+            << " speedup: " << t_ref / t_new << " pose difference: " << pose_error << std::endl;
+  if (alloc_new > 0 || pose_error > 1e-6)
+    status = 1;
+
+  // Whole tracking step, vpDot2::track() included
+  nb_allocations = s_nb_allocations;
+  t = vpTime::measureTimeMs();
+  unsigned int nb_tracked = 0;
+  for (unsigned int n=0; n < opt_iter; n++) {
+    if (tracker.track(cv::Mat(), I))
+      nb_tracked++;
+  }
+  double t_track = (vpTime::measureTimeMs() - t) / opt_iter;
+  double alloc_track = (double)(s_nb_allocations - nb_allocations) / opt_iter;
+  std::cout << "track(): " << 1000. * t_track << " us " << alloc_track << " allocations per call (vpDot2::track() included), "
+            << nb_tracked << "/" << opt_iter << " tracked" << std::endl;
+  if (nb_tracked != opt_iter)
+    status = 1;
+
+  // Two targets, tracked one after the other then in parallel
+  std::vector<vpImagePoint> cogs2;
+  for (size_t i=0; i < cogs.size(); i++) {
+    cogs2.push_back(cogs[i] + vpImagePoint(20, 150));
+    drawDisk(I, cogs2[i].get_u(), cogs2[i].get_v(), 7, 30);
+  }
+
+  vpBlobsTargetTrackerBenchmark serial[2], parallel[2];
+  std::vector<vpBlobsTargetTracker*> targets;
+  for (unsigned int k=0; k < 2; k++) {
+    serial[k].setCameraParameters(cam);
+    serial[k].setPoints(points);
+    serial[k].initBlobs(I, k ? cogs2 : cogs);
+    parallel[k].setCameraParameters(cam);
+    parallel[k].setPoints(points);
+    parallel[k].initBlobs(I, k ? cogs2 : cogs);
+    targets.push_back(&parallel[k]);
+  }
+
+  unsigned int opt_iter_targets = std::max(1u, opt_iter / 10);
+  nb_tracked = 0;
+  t = vpTime::measureTimeMs();
+  for (unsigned int n=0; n < opt_iter_targets; n++) {
+    bool tracked_l = serial[0].track(cv::Mat(), I);
+    bool tracked_r = serial[1].track(cv::Mat(), I);
+    if (tracked_l && tracked_r)
+      nb_tracked++;
+  }
+  double t_serial = (vpTime::measureTimeMs() - t) / opt_iter_targets;
+
+  std::vector<bool> status_targets;
+  unsigned int nb_tracked_parallel = 0;
+  t = vpTime::measureTimeMs();
+  for (unsigned int n=0; n < opt_iter_targets; n++) {
+    vpBlobsTargetTracker::trackTargets(targets, cv::Mat(), I, status_targets);
+    if (status_targets[0] && status_targets[1])
+      nb_tracked_parallel++;
+  }
+  double t_parallel = (vpTime::measureTimeMs() - t) / opt_iter_targets;
+
+  pose_error = 0;
+  for (unsigned int k=0; k < 2; k++) {
+    vpHomogeneousMatrix cMo_serial = serial[k].get_cMo();
+    vpHomogeneousMatrix cMo_parallel = parallel[k].get_cMo();
+    for (unsigned int i=0; i < 3; i++)
+      for (unsigned int j=0; j < 4; j++)
+        pose_error = std::max(pose_error, std::fabs(cMo_serial[i][j] - cMo_parallel[i][j]));
+  }
+
+  std::cout << "Two targets, one after the other: " << 1000. * t_serial << " us, "
+            << nb_tracked << "/" << opt_iter_targets << " tracked" << std::endl;
+  std::cout << "Two targets, " << 2 * cogs.size() << " blobs in parallel: " << 1000. * t_parallel << " us, "
+            << nb_tracked_parallel << "/" << opt_iter_targets << " tracked"
+            << " speedup: " << t_serial / t_parallel << " pose difference: " << pose_error << std::endl;
+  if (nb_tracked != opt_iter_targets || nb_tracked_parallel != opt_iter_targets || pose_error > 0)
+    status = 1;
+
+  // Local recovery of a blob, then full recovery when a blob is hidden
+  vpBlobsTargetTrackerBenchmark &target = serial[0];
+  vpHomogeneousMatrix cMo_before = target.get_cMo();
+  target.collapseBlob(2, 0);
+  bool recovered = target.track(cv::Mat(), I);
+  vpHomogeneousMatrix cMo_after = target.get_cMo();
+  pose_error = 0;
+  for (unsigned int i=0; i < 3; i++)
+    for (unsigned int j=0; j < 4; j++)
+      pose_error = std::max(pose_error, std::fabs(cMo_after[i][j] - cMo_before[i][j]));
+
+  vpImage<unsigned char> I_hidden = I;
+  drawDisk(I_hidden, cogs[3].get_u(), cogs[3].get_v(), 9, 220);
+  bool hidden = target.track(cv::Mat(), I_hidden);
+
+  std::cout << "Collapsed blob " << (recovered ? "recovered" : "lost") << " pose difference: " << pose_error
+            << ", hidden blob " << (hidden ? "tracked" : "lost")
+            << ", local recoveries: " << target.getNbLocalRecoveries()
+            << " full recoveries: " << target.getNbFullRecoveries() << std::endl;
+  if (!recovered || pose_error > 1e-6 || hidden || target.getNbLocalRecoveries() != 1 || target.getNbFullRecoveries() != 1)
+    status = 1;
+
+  return status;
+}
@@ -0,0 +1,163 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Count the heap allocations of vpColorDetection in steady state.
+ *
+ *****************************************************************************/
+
+/*! \example color_detection_allocations.cpp */
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+//OpenCV
+#include <opencv2/imgproc/imgproc.hpp>
+
+//RomeoTk
+#include <vpRomeoTkConfig.h>
+#include <vpColorDetection.h>
+
+/*!
+
+   Check that vpColorDetection::detect() does not allocate memory once its work buffers
+   are allocated for the image size. No robot is needed.
+
+   ./color_detection_allocations [--hsv <file>] [--iter <n>]
+
+   The global operator new is replaced to count the allocations. The shape recognition,
+   which calls cv::findContours() on the objects, is not enabled.
+ */
+
+#if __cplusplus >= 201103L
+#  define VP_NEW_THROW
+#  define VP_DELETE_THROW noexcept
+#else
+#  define VP_NEW_THROW throw(std::bad_alloc)
+#  define VP_DELETE_THROW throw()
+#endif
+
+static unsigned long s_nb_allocations = 0;
+
+void *operator new(std::size_t size) VP_NEW_THROW
+{
+  s_nb_allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (ptr == NULL)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](std::size_t size) VP_NEW_THROW
+{
+  s_nb_allocations++;
+  void *ptr = malloc(size ? size : 1);
+  if (ptr == NULL)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) VP_DELETE_THROW
+{
+  free(ptr);
+}
+
+void operator delete[](void *ptr) VP_DELETE_THROW
+{
+  free(ptr);
+}
+
+cv::Mat createFrame(int offset)
+{
+  cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(60, 90, 40));
+  cv::circle(frame, cv::Point(200 + offset, 150), 30, cv::Scalar(0, 0, 255), -1);
+  cv::circle(frame, cv::Point(420, 300 + offset), 20, cv::Scalar(10, 10, 230), -1);
+  cv::rectangle(frame, cv::Point(300, 100), cv::Point(360, 140), cv::Scalar(255, 120, 0), -1);
+  return frame;
+}
+
+unsigned long countAllocations(vpColorDetection &detector, const std::vector<cv::Mat> &frames,
+                               unsigned int iter, unsigned int &nb_detections)
+{
+  // Warm up: the work buffers are allocated for the image size
+  for (size_t i=0; i < frames.size(); i++)
+    detector.detect(frames[i]);
+
+  nb_detections = 0;
+  unsigned long nb_allocations = s_nb_allocations;
+  for (unsigned int n=0; n < iter; n++) {
+    if (detector.detect(frames[n % frames.size()]))
+      nb_detections++;
+  }
+  return s_nb_allocations - nb_allocations;
+}
+
+int main(int argc, const char* argv[])
+{
+  std::string opt_hsv = std::string(ROMEOTK_DATA_FOLDER) + "/target/LArm/color.txt";
+  unsigned int opt_iter = 100;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--hsv")
+      opt_hsv = argv[i+1];
+    else if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--hsv <file>] [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  vpColorDetection detector;
+  if (!detector.loadHSV(opt_hsv))
+    return 0;
+  detector.setName("larm");
+
+  // The objects move between the frames so that the search window changes
+  std::vector<cv::Mat> frames;
+  for (int offset=0; offset < 40; offset += 8)
+    frames.push_back(createFrame(offset));
+
+  int status = 0;
+  for (int search_window=0; search_window < 2; search_window++) {
+    detector.setSearchWindow(search_window != 0);
+    unsigned int nb_detections;
+    unsigned long nb_allocations = countAllocations(detector, frames, opt_iter, nb_detections);
+
+    std::cout << (search_window ? "search window" : "full frame")
+              << ": " << nb_detections << "/" << opt_iter << " detections, "
+              << nb_allocations << " allocations" << std::endl;
+    if (nb_allocations || nb_detections != opt_iter)
+      status = 1;
+  }
+
+  return status;
+}
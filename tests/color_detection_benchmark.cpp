@@ -0,0 +1,294 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Offline benchmark of the color segmentation used by vpColorDetection.
+ *
+ *****************************************************************************/
+
+/*! \example color_detection_benchmark.cpp */
+#include <iostream>
+#include <string>
+
+//OpenCV
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+//Visp
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpRomeoTkConfig.h>
+#include <vpColorDetection.h>
+#include <vpColorThreshold.h>
+#include <vpMultiColorClassifier.h>
+
+#include "color_test_utils.h"
+
+/*!
+
+   Compare the reference HSV thresholding (cv::cvtColor() + cv::inRange()) with
+   the fused kernel of vpColorThreshold on recorded frames, at 320x240 and 640x480.
+   No robot is needed.
+
+   ./color_detection_benchmark --input frame1.png --input frame2.png [--hsv <file>] [--iter <n>]
+
+   Without --input, a synthetic frame with a few colored blobs is used.
+
+   The profiles of the arms, the box and the plate are then used together to compare
+   one thresholding per profile with a single pass of vpMultiColorClassifier.
+
+   Then vpColorDetection::detect() is timed with 1 to N threads (--threads, by default the
+   number of CPUs), and the objects are checked to be the same as with one thread.
+
+   Finally the coarse-to-fine detection is timed for the pyramid levels 1 and 2. Objects too
+   small to be seen in the decimated image are lost, so the differences with the full resolution
+   detection are only reported. The objects of the first frame are then found again with a salt
+   noise of the color of the first object on 1% of the pixels: the noise is removed by the
+   erosion at full resolution, and the levels 1 and 2 have to find the same objects as the level 0.
+ */
+
+int main(int argc, const char* argv[])
+{
+  std::vector<std::string> opt_inputs;
+  std::string opt_hsv = std::string(ROMEOTK_DATA_FOLDER) + "/target/LArm/color.txt";
+  unsigned int opt_iter = 200;
+  unsigned int opt_threads = cv::getNumberOfCPUs();
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--input")
+      opt_inputs.push_back(argv[i+1]);
+    else if (std::string(argv[i]) == "--hsv")
+      opt_hsv = argv[i+1];
+    else if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--threads")
+      opt_threads = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--input <image>] [--hsv <file>] [--iter <n>] [--threads <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  vpColorDetection detector;
+  if (!detector.loadHSV(opt_hsv))
+    return 0;
+  std::vector<int> values = detector.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+  const int hsv_min[3] = {values[0], values[2], values[4]};
+  const int hsv_max[3] = {values[1], values[3], values[5]};
+
+  std::vector<cv::Mat> frames = loadFrames(opt_inputs);
+
+  std::vector<cv::Size> sizes;
+  sizes.push_back(cv::Size(320, 240));
+  sizes.push_back(cv::Size(640, 480));
+
+  int status = 0;
+  for (size_t s=0; s < sizes.size(); s++) {
+    std::vector<cv::Mat> resized(frames.size());
+    for (size_t i=0; i < frames.size(); i++)
+      cv::resize(frames[i], resized[i], sizes[s]);
+
+    cv::Mat mask_ref, mask_fused;
+    unsigned int mismatch = 0;
+    for (size_t i=0; i < resized.size(); i++) {
+      vpColorThreshold::thresholdHSVReference(resized[i], mask_ref, hsv_min, hsv_max);
+      vpColorThreshold::thresholdHSV(resized[i], mask_fused, hsv_min, hsv_max);
+      mismatch += cv::countNonZero(mask_ref != mask_fused);
+    }
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++)
+      vpColorThreshold::thresholdHSVReference(resized[n % resized.size()], mask_ref, hsv_min, hsv_max);
+    double t_ref = (vpTime::measureTimeMs() - t) / opt_iter;
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++)
+      vpColorThreshold::thresholdHSV(resized[n % resized.size()], mask_fused, hsv_min, hsv_max);
+    double t_fused = (vpTime::measureTimeMs() - t) / opt_iter;
+
+    std::cout << sizes[s].width << "x" << sizes[s].height
+              << " cvtColor+inRange: " << t_ref << " ms"
+              << " fused: " << t_fused << " ms"
+              << " speedup: " << t_ref / t_fused
+              << " mismatching pixels: " << mismatch << std::endl;
+    if (mismatch)
+      status = 1;
+  }
+
+  // Several profiles classified in one pass
+  vpMultiColorClassifier classifier;
+  classifier.addProfile(detector);
+  const char *profile_files[] = {"/target/RArm/color.txt", "/target/box_blob/color.txt", "/target/plate_blob/color.txt"};
+  for (unsigned int i=0; i < sizeof(profile_files)/sizeof(profile_files[0]); i++)
+    classifier.loadProfiles(std::string(ROMEOTK_DATA_FOLDER) + profile_files[i]);
+
+  const unsigned int nb_profiles = classifier.getNbProfiles();
+  std::vector<cv::Mat> resized(frames.size());
+  for (size_t i=0; i < frames.size(); i++)
+    cv::resize(frames[i], resized[i], cv::Size(640, 480));
+
+  std::vector<int> profile_min(3*nb_profiles), profile_max(3*nb_profiles);
+  for (unsigned int p=0; p < nb_profiles; p++)
+    classifier.getValuesHSV(p, &profile_min[3*p], &profile_max[3*p]);
+
+  cv::Mat labels, mask_ref, mask_multi;
+  classifier.classify(resized[0], labels); // Builds the lookup table
+  unsigned int mismatch = 0;
+  for (size_t i=0; i < resized.size(); i++) {
+    classifier.classify(resized[i], labels);
+    for (unsigned int p=0; p < nb_profiles; p++) {
+      vpColorThreshold::thresholdHSV(resized[i], mask_ref, &profile_min[3*p], &profile_max[3*p]);
+      vpMultiColorClassifier::extractMask(labels, p, mask_multi);
+      mismatch += cv::countNonZero(mask_ref != mask_multi);
+    }
+  }
+
+  double t = vpTime::measureTimeMs();
+  for (unsigned int n=0; n < opt_iter; n++) {
+    for (unsigned int p=0; p < nb_profiles; p++)
+      vpColorThreshold::thresholdHSV(resized[n % resized.size()], mask_ref, &profile_min[3*p], &profile_max[3*p]);
+  }
+  double t_single = (vpTime::measureTimeMs() - t) / opt_iter;
+
+  t = vpTime::measureTimeMs();
+  for (unsigned int n=0; n < opt_iter; n++)
+    classifier.classify(resized[n % resized.size()], labels);
+  double t_multi = (vpTime::measureTimeMs() - t) / opt_iter;
+
+  std::cout << "640x480 " << nb_profiles << " profiles"
+            << " fused per profile: " << t_single << " ms"
+            << " lookup table: " << t_multi << " ms"
+            << " speedup: " << t_single / t_multi
+            << " mismatching pixels: " << mismatch << std::endl;
+  if (mismatch)
+    status = 1;
+
+  // Parallel segmentation by horizontal bands
+  std::vector<vpRect> ref_bboxes;
+  double t_serial = 0;
+  for (unsigned int nb_threads=1; nb_threads <= opt_threads; nb_threads++) {
+    cv::setNumThreads(nb_threads);
+    detector.setNbThreads(nb_threads);
+
+    std::vector<vpRect> bboxes;
+    for (size_t i=0; i < resized.size(); i++) {
+      detector.detect(resized[i]);
+      for (size_t k=0; k < detector.getNbObjects(); k++)
+        bboxes.push_back(detector.getBBox(k));
+    }
+    if (nb_threads == 1)
+      ref_bboxes = bboxes;
+    bool same = (bboxes.size() == ref_bboxes.size());
+    for (size_t k=0; same && k < bboxes.size(); k++) {
+      same = bboxes[k].getLeft() == ref_bboxes[k].getLeft() && bboxes[k].getTop() == ref_bboxes[k].getTop()
+          && bboxes[k].getWidth() == ref_bboxes[k].getWidth() && bboxes[k].getHeight() == ref_bboxes[k].getHeight();
+    }
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++)
+      detector.detect(resized[n % resized.size()]);
+    double t_detect = (vpTime::measureTimeMs() - t) / opt_iter;
+    if (nb_threads == 1)
+      t_serial = t_detect;
+
+    std::cout << "640x480 detect() with " << nb_threads << " thread(s): " << t_detect << " ms"
+              << " speedup: " << t_serial / t_detect
+              << (same ? "" : " objects different from 1 thread") << std::endl;
+    if (!same)
+      status = 1;
+  }
+
+  // Coarse-to-fine detection
+  cv::setNumThreads(1);
+  detector.setNbThreads(1);
+  for (unsigned int level=1; level <= 2; level++) {
+    detector.setPyramidLevel(level);
+
+    std::vector<vpRect> bboxes;
+    for (size_t i=0; i < resized.size(); i++) {
+      detector.detect(resized[i]);
+      for (size_t k=0; k < detector.getNbObjects(); k++)
+        bboxes.push_back(detector.getBBox(k));
+    }
+    bool same = (bboxes.size() == ref_bboxes.size());
+    for (size_t k=0; same && k < bboxes.size(); k++) {
+      same = bboxes[k].getLeft() == ref_bboxes[k].getLeft() && bboxes[k].getTop() == ref_bboxes[k].getTop()
+          && bboxes[k].getWidth() == ref_bboxes[k].getWidth() && bboxes[k].getHeight() == ref_bboxes[k].getHeight();
+    }
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++)
+      detector.detect(resized[n % resized.size()]);
+    double t_detect = (vpTime::measureTimeMs() - t) / opt_iter;
+
+    std::cout << "640x480 detect() with pyramid level " << level << ": " << t_detect << " ms"
+              << " speedup: " << t_serial / t_detect
+              << (same ? "" : " objects different from full resolution") << std::endl;
+  }
+  detector.setPyramidLevel(0);
+
+  // Salt noise of the color of the first object, isolated pixels that the reduced erosion keeps
+  detector.detect(resized[0]);
+  if (detector.getNbObjects() > 0) {
+    vpRect bbox = detector.getBBox(0);
+    cv::Vec3b color = resized[0].at<cv::Vec3b>((int)(bbox.getTop() + bbox.getHeight() / 2), (int)(bbox.getLeft() + bbox.getWidth() / 2));
+    cv::Mat noisy = resized[0].clone();
+    cv::RNG rng(0);
+    for (int n=0; n < noisy.rows * noisy.cols / 100; n++)
+      noisy.at<cv::Vec3b>(rng.uniform(0, noisy.rows), rng.uniform(0, noisy.cols)) = color;
+
+    std::vector<vpRect> noisy_bboxes;
+    for (unsigned int level=0; level <= 2; level++) {
+      detector.setPyramidLevel(level);
+      detector.detect(noisy);
+      bool same = true;
+      if (level == 0) {
+        for (size_t k=0; k < detector.getNbObjects(); k++)
+          noisy_bboxes.push_back(detector.getBBox(k));
+      }
+      else {
+        same = (detector.getNbObjects() == noisy_bboxes.size());
+        for (size_t k=0; same && k < noisy_bboxes.size(); k++) {
+          vpRect b = detector.getBBox(k);
+          same = b.getLeft() == noisy_bboxes[k].getLeft() && b.getTop() == noisy_bboxes[k].getTop()
+              && b.getWidth() == noisy_bboxes[k].getWidth() && b.getHeight() == noisy_bboxes[k].getHeight();
+        }
+      }
+      std::cout << "640x480 salt noise, pyramid level " << level << ": " << detector.getNbObjects() << " objects"
+                << (same ? "" : " different from full resolution") << std::endl;
+      if (!same || detector.getNbObjects() == 0)
+        status = 1;
+    }
+    detector.setPyramidLevel(0);
+  }
+
+  return status;
+}
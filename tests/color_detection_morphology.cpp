@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Comparison of the morphology engines of vpColorDetection.
+ *
+ *****************************************************************************/
+
+/*! \example color_detection_morphology.cpp */
+#include <iostream>
+#include <string>
+
+//OpenCV
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+//Visp
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpRomeoTkConfig.h>
+#include <vpBinaryMorphology.h>
+#include <vpColorDetection.h>
+#include <vpColorThreshold.h>
+
+#include "color_test_utils.h"
+
+/*!
+
+   Check that the morphology engines of vpColorDetection give the same result as
+   cv::erode() and cv::dilate(), and compare their timings. No robot is needed.
+
+   ./color_detection_morphology [--input <image>] [--hsv <file>] [--iter <n>]
+
+   The masks are obtained by thresholding the input images (or a synthetic frame)
+   and completed by random masks with several densities and odd sizes.
+ */
+
+// Same sequence as vpColorDetection::morphOps() with MORPH_OPENCV
+void morphOpsOpenCV(cv::Mat &T, bool level)
+{
+  cv::Mat erodeElement = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3,3));
+  cv::Mat dilateElement = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(8,8));
+  if (level)
+    cv::erode(T, T, erodeElement);
+  cv::erode(T, T, erodeElement);
+  if (level)
+    cv::dilate(T, T, dilateElement);
+  cv::dilate(T, T, dilateElement);
+}
+
+int main(int argc, const char* argv[])
+{
+  std::vector<std::string> opt_inputs;
+  std::string opt_hsv = std::string(ROMEOTK_DATA_FOLDER) + "/target/LArm/color.txt";
+  unsigned int opt_iter = 200;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--input")
+      opt_inputs.push_back(argv[i+1]);
+    else if (std::string(argv[i]) == "--hsv")
+      opt_hsv = argv[i+1];
+    else if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--input <image>] [--hsv <file>] [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  vpColorDetection detector;
+  if (!detector.loadHSV(opt_hsv))
+    return 0;
+  std::vector<int> values = detector.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+  const int hsv_min[3] = {values[0], values[2], values[4]};
+  const int hsv_max[3] = {values[1], values[3], values[5]};
+
+  std::vector<cv::Mat> frames = loadFrames(opt_inputs);
+
+  // Masks of the frames and random masks
+  std::vector<cv::Mat> masks;
+  for (size_t i=0; i < frames.size(); i++) {
+    cv::Mat mask;
+    vpColorThreshold::thresholdHSV(frames[i], mask, hsv_min, hsv_max);
+    masks.push_back(mask);
+  }
+  cv::RNG rng(12345);
+  const cv::Size sizes[] = {cv::Size(320, 240), cv::Size(640, 480), cv::Size(333, 251), cv::Size(65, 7)};
+  for (unsigned int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+    for (int density=10; density < 100; density += 20) {
+      cv::Mat noise(sizes[s], CV_8UC1), mask;
+      rng.fill(noise, cv::RNG::UNIFORM, 0, 100);
+      cv::threshold(noise, mask, 100 - density, 255, cv::THRESH_BINARY);
+      masks.push_back(mask);
+    }
+  }
+
+  int status = 0;
+  vpBinaryMorphology morphology;
+  for (int level=0; level < 2; level++) {
+    const unsigned int iter = level ? 2 : 1;
+    unsigned int mismatch = 0;
+    for (size_t i=0; i < masks.size(); i++) {
+      cv::Mat ref = masks[i].clone(), bits = masks[i].clone();
+      morphOpsOpenCV(ref, level != 0);
+      morphology.erodeDilate(bits, cv::Size(3,3), iter, cv::Size(8,8), iter);
+      mismatch += cv::countNonZero(ref != bits);
+    }
+
+    cv::Mat T;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++) {
+      masks[0].copyTo(T);
+      morphOpsOpenCV(T, level != 0);
+    }
+    double t_opencv = (vpTime::measureTimeMs() - t) / opt_iter;
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++) {
+      masks[0].copyTo(T);
+      morphology.erodeDilate(T, cv::Size(3,3), iter, cv::Size(8,8), iter);
+    }
+    double t_bits = (vpTime::measureTimeMs() - t) / opt_iter;
+
+    std::cout << "Level " << level << " " << masks[0].cols << "x" << masks[0].rows
+              << " OpenCV: " << t_opencv << " ms"
+              << " bit packed: " << t_bits << " ms"
+              << " speedup: " << t_opencv / t_bits
+              << " mismatching pixels on " << masks.size() << " masks: " << mismatch << std::endl;
+    if (mismatch)
+      status = 1;
+  }
+
+  // The detected objects do not depend on the engine
+  const vpColorDetection::MorphologyEngine engines[] = {vpColorDetection::MORPH_OPENCV,
+                                                        vpColorDetection::MORPH_SEPARABLE,
+                                                        vpColorDetection::MORPH_BITPACKED};
+  const char *names[] = {"OpenCV", "separable", "bit packed"};
+  std::vector<vpRect> ref_bboxes;
+  for (unsigned int e=0; e < 3; e++) {
+    detector.setMorphologyEngine(engines[e]);
+    double t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++)
+      detector.detect(frames[n % frames.size()]);
+    double t_detect = (vpTime::measureTimeMs() - t) / opt_iter;
+
+    std::vector<vpRect> bboxes;
+    for (size_t i=0; i < frames.size(); i++) {
+      detector.detect(frames[i]);
+      for (size_t k=0; k < detector.getNbObjects(); k++)
+        bboxes.push_back(detector.getBBox(k));
+    }
+    if (e == 0)
+      ref_bboxes = bboxes;
+
+    bool same = (bboxes.size() == ref_bboxes.size());
+    for (size_t k=0; same && k < bboxes.size(); k++) {
+      same = bboxes[k].getLeft() == ref_bboxes[k].getLeft() && bboxes[k].getTop() == ref_bboxes[k].getTop()
+          && bboxes[k].getWidth() == ref_bboxes[k].getWidth() && bboxes[k].getHeight() == ref_bboxes[k].getHeight();
+    }
+    std::cout << "detect() with the " << names[e] << " morphology: " << t_detect << " ms, "
+              << bboxes.size() << " objects" << (same ? "" : ", different from OpenCV") << std::endl;
+    if (!same)
+      status = 1;
+  }
+
+  return status;
+}
@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Follow a lighting drift with the adaptive color model of vpColorDetection.
+ *
+ *****************************************************************************/
+
+/*! \example color_model_adaptation.cpp */
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//OpenCV
+#include <opencv2/imgproc/imgproc.hpp>
+
+//Visp
+#include <visp/vpIoTools.h>
+
+//RomeoTk
+#include <vpRomeoTkConfig.h>
+#include <vpAdaptiveColorModel.h>
+#include <vpColorDetection.h>
+
+/*!
+
+   Simulate a slow change of lighting on a colored blob and count the frames where the blob
+   is lost, with the static HSV range and with vpAdaptiveColorModel updated from the blob
+   found in the previous frame. No robot is needed.
+
+   ./color_model_adaptation [--hsv <file>] [--frames <n>] [--drift <degrees>]
+
+   The blob takes the middle of the HSV range of the file, then its hue drifts by --drift
+   (in the 0-180 hue of OpenCV) over the sequence while its brightness decreases. The adapted
+   model is saved, loaded back and checked to give the same mask.
+ */
+
+cv::Mat createFrame(const int hsv[3])
+{
+  cv::Mat pixel(1, 1, CV_8UC3, cv::Scalar(hsv[0], hsv[1], hsv[2])), bgr;
+  cv::cvtColor(pixel, bgr, cv::COLOR_HSV2BGR);
+  const cv::Vec3b color = bgr.at<cv::Vec3b>(0, 0);
+
+  cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(60, 60, 60));
+  cv::rectangle(frame, cv::Point(0, 300), cv::Point(639, 479), cv::Scalar(40, 90, 150), -1);
+  cv::circle(frame, cv::Point(320, 200), 25, cv::Scalar(color[0], color[1], color[2]), -1);
+  return frame;
+}
+
+int main(int argc, const char* argv[])
+{
+  std::string opt_hsv = std::string(ROMEOTK_DATA_FOLDER) + "/target/LArm/color.txt";
+  unsigned int opt_frames = 300;
+  int opt_drift = 20;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--hsv")
+      opt_hsv = argv[i+1];
+    else if (std::string(argv[i]) == "--frames")
+      opt_frames = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--drift")
+      opt_drift = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--hsv <file>] [--frames <n>] [--drift <degrees>]" << std::endl;
+      return 0;
+    }
+  }
+
+  vpColorDetection detector_static, detector_adaptive;
+  if (!detector_static.loadHSV(opt_hsv) || !detector_adaptive.loadHSV(opt_hsv))
+    return 0;
+
+  std::vector<int> values = detector_static.getValueHSV(); // H_min H_max S_min S_max V_min V_max
+  const int hsv_min[3] = {values[0], values[2], values[4]};
+  const int hsv_max[3] = {values[1], values[3], values[5]};
+
+  vpAdaptiveColorModel model;
+  model.initFromRange(hsv_min, hsv_max);
+  detector_adaptive.setColorModel(&model);
+
+  unsigned int lost_static = 0, lost_adaptive = 0;
+  cv::Mat frame;
+  for (unsigned int n=0; n < opt_frames; n++) {
+    const double t = (double)n / opt_frames;
+    int hsv[3];
+    hsv[0] = (hsv_min[0] + hsv_max[0]) / 2 + (int)(t * opt_drift);
+    hsv[1] = (hsv_min[1] + hsv_max[1]) / 2;
+    hsv[2] = (int)(((hsv_min[2] + hsv_max[2]) / 2) * (1. - 0.5 * t));
+    frame = createFrame(hsv);
+
+    if (!detector_static.detect(frame))
+      lost_static++;
+    if (detector_adaptive.detect(frame)) {
+      vpRect bbox = detector_adaptive.getBBox(0);
+      model.update(frame, cv::Rect((int)bbox.getLeft(), (int)bbox.getTop(), (int)bbox.getWidth(), (int)bbox.getHeight()));
+    }
+    else
+      lost_adaptive++;
+  }
+
+  std::cout << "Frames lost over " << opt_frames << ": static HSV range " << lost_static
+            << ", adaptive model " << lost_adaptive << " (" << model.getNbUpdates() << " updates)" << std::endl;
+
+  // A restart begins from the adapted model
+  std::string username;
+  vpIoTools::getUserName(username);
+#if defined(_WIN32)
+  std::string folder = "C:/temp/" + username;
+#else
+  std::string folder = "/tmp/" + username;
+#endif
+  if (!vpIoTools::checkDirectory(folder))
+    vpIoTools::makeDirectory(folder);
+  std::string filename = folder + "/color_model_adaptation.bin";
+  vpAdaptiveColorModel reloaded;
+  if (!model.save(filename) || !reloaded.load(filename))
+    return 1;
+  cv::Mat mask, mask_reloaded;
+  model.threshold(frame, mask);
+  reloaded.threshold(frame, mask_reloaded);
+  const int mismatch = cv::countNonZero(mask != mask_reloaded);
+  std::cout << "Mismatching pixels after reloading the model: " << mismatch << std::endl;
+
+  return (mismatch || lost_adaptive > lost_static) ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Input frames shared by the color detection tests.
+ *
+ *****************************************************************************/
+
+#ifndef __color_test_utils_h__
+#define __color_test_utils_h__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//OpenCV
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+/*!
+  Synthetic frame of 640x480 pixels with two red disks and a blue rectangle on a blurred noise.
+ */
+inline cv::Mat createSyntheticFrame()
+{
+  cv::Mat frame(480, 640, CV_8UC3);
+  cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::GaussianBlur(frame, frame, cv::Size(9, 9), 3);
+  cv::circle(frame, cv::Point(200, 150), 30, cv::Scalar(0, 0, 255), -1);
+  cv::circle(frame, cv::Point(420, 300), 20, cv::Scalar(10, 10, 230), -1);
+  cv::rectangle(frame, cv::Point(300, 100), cv::Point(360, 140), cv::Scalar(255, 120, 0), -1);
+  return frame;
+}
+
+/*!
+  Read the color images given with --input, the synthetic frame of createSyntheticFrame() being
+  used when none can be read.
+ */
+inline std::vector<cv::Mat> loadFrames(const std::vector<std::string> &inputs)
+{
+  std::vector<cv::Mat> frames;
+  for (size_t i=0; i < inputs.size(); i++) {
+    cv::Mat frame = cv::imread(inputs[i], 1);
+    if (frame.empty())
+      std::cout << "Cannot read " << inputs[i] << std::endl;
+    else
+      frames.push_back(frame);
+  }
+  if (frames.empty())
+    frames.push_back(createSyntheticFrame());
+  return frames;
+}
+
+#endif
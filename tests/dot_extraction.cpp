@@ -0,0 +1,191 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Comparison of vpDotExtractor with vpDot2::searchDotsInArea().
+ *
+ *****************************************************************************/
+
+
+/*! \example dot_extraction.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+//Visp
+#include <visp/vpDot2.h>
+#include <visp/vpImageIo.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpDotExtractor.h>
+
+#include "blob_test_utils.h"
+
+/*!
+
+   Compare the dots found by vpDotExtractor with the ones of vpDot2::searchDotsInArea(), and
+   their latency. No robot is needed.
+
+   ./dot_extraction --input frame.pgm --seed <u> <v> [--gray-level <min> <max>] [--iter <n>]
+
+   The wanted dot is tracked from the seed, which is usually the colored blob of a hand target,
+   then the dots are searched in the whole frame with its gray level range (0 to 50 by default,
+   like the black blobs of vpBlobsTargetTracker). Without --input, a synthetic frame with the four
+   blobs of a hand target and clutter is used.
+
+   Both methods have to find the same dots. The worst case is then timed on a frame made of
+   random dark and bright pixels, where the region growing of vpDot2 starts from each seed.
+ */
+
+void createSyntheticFrame(vpImage<unsigned char> &I, vpImagePoint &seed)
+{
+  I.resize(480, 640);
+  I = 220;
+  // Hand target
+  drawDisk(I, 341, 225, 7, 30);
+  drawDisk(I, 302, 221, 7, 30);
+  drawDisk(I, 297, 258, 7, 30);
+  drawDisk(I, 337, 262, 7, 30);
+  // Other dots, too small, too large or not elliptic
+  drawDisk(I, 100, 100, 7, 20);
+  drawDisk(I, 500, 120, 8, 40);
+  drawDisk(I, 150, 400, 2, 30);
+  drawDisk(I, 450, 380, 30, 30);
+  for (unsigned int j = 50; j < 150; j++)
+    I[300][j] = 10;
+  for (unsigned int i = 350; i < 380; i++)
+    for (unsigned int j = 550; j < 600; j++)
+      I[i][j] = (i + j) % 7 ? 15 : 200;
+  seed.set_uv(341, 225);
+}
+
+/*!
+  Number of dots of \e dots that have no dot of \e reference at less than one pixel.
+ */
+unsigned int countMissing(const std::list<vpDot2> &dots, const std::list<vpDot2> &reference)
+{
+  unsigned int nb_missing = 0;
+  for (std::list<vpDot2>::const_iterator it = dots.begin(); it != dots.end(); ++it) {
+    bool found = false;
+    for (std::list<vpDot2>::const_iterator ref = reference.begin(); ref != reference.end() && !found; ++ref)
+      found = vpImagePoint::distance(it->getCog(), ref->getCog()) < 1.0;
+    if (!found)
+      nb_missing++;
+  }
+  return nb_missing;
+}
+
+int main(int argc, const char* argv[])
+{
+  std::string opt_input;
+  vpImagePoint opt_seed;
+  unsigned int opt_gray_min = 0, opt_gray_max = 50;
+  unsigned int opt_iter = 100;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--input")
+      opt_input = std::string(argv[i+1]);
+    else if (std::string(argv[i]) == "--seed")
+      opt_seed.set_uv(atof(argv[i+1]), atof(argv[i+2]));
+    else if (std::string(argv[i]) == "--gray-level") {
+      opt_gray_min = atoi(argv[i+1]);
+      opt_gray_max = atoi(argv[i+2]);
+    }
+    else if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--input <image> --seed <u> <v>] [--gray-level <min> <max>] [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  vpImage<unsigned char> I;
+  if (opt_input.empty())
+    createSyntheticFrame(I, opt_seed);
+  else
+    vpImageIo::read(I, opt_input);
+
+  int status = 0;
+  try {
+    vpDot2 wanted;
+    wanted.setGraphics(false);
+    wanted.initTracking(I, opt_seed);
+    wanted.setGrayLevelMin(opt_gray_min);
+    wanted.setGrayLevelMax(opt_gray_max);
+
+    vpDotExtractor extractor;
+    std::list<vpDot2> dots_ref, dots;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++)
+      wanted.searchDotsInArea(I, 0, 0, I.getWidth(), I.getHeight(), dots_ref);
+    double t_ref = (vpTime::measureTimeMs() - t) / opt_iter;
+    t = vpTime::measureTimeMs();
+    for (unsigned int n=0; n < opt_iter; n++)
+      extractor.searchDotsInArea(I, wanted, 0, 0, I.getWidth(), I.getHeight(), dots);
+    double t_new = (vpTime::measureTimeMs() - t) / opt_iter;
+
+    unsigned int nb_missing = countMissing(dots_ref, dots);
+    unsigned int nb_extra = countMissing(dots, dots_ref);
+    std::cout << "vpDot2::searchDotsInArea(): " << dots_ref.size() << " dots, " << t_ref << " ms" << std::endl;
+    std::cout << "vpDotExtractor: " << dots.size() << " dots, " << t_new << " ms, speedup: " << t_ref / t_new
+              << ", missing: " << nb_missing << " extra: " << nb_extra << std::endl;
+    if (nb_missing || nb_extra)
+      status = 1;
+
+    // Worst case: dark and bright pixels everywhere
+    vpImage<unsigned char> I_clutter(I.getHeight(), I.getWidth());
+    srand(0);
+    for (unsigned int i=0; i < I_clutter.getHeight(); i++)
+      for (unsigned int j=0; j < I_clutter.getWidth(); j++)
+        I_clutter[i][j] = rand() % 2 ? 20 : 220;
+    double t_ref_max = 0, t_new_max = 0;
+    for (unsigned int n=0; n < std::max(opt_iter / 10, 1u); n++) {
+      t = vpTime::measureTimeMs();
+      wanted.searchDotsInArea(I_clutter, 0, 0, I.getWidth(), I.getHeight(), dots_ref);
+      t_ref_max = std::max(t_ref_max, vpTime::measureTimeMs() - t);
+      t = vpTime::measureTimeMs();
+      extractor.searchDotsInArea(I_clutter, wanted, 0, 0, I.getWidth(), I.getHeight(), dots);
+      t_new_max = std::max(t_new_max, vpTime::measureTimeMs() - t);
+    }
+    std::cout << "Cluttered frame, worst time: vpDot2::searchDotsInArea() " << t_ref_max
+              << " ms, vpDotExtractor " << t_new_max << " ms" << std::endl;
+  }
+  catch(vpException &e) {
+    std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    status = 1;
+  }
+
+  return status;
+}
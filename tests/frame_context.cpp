@@ -0,0 +1,177 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Reuse of the pyramid of a frame by vpFrameContext.
+ *
+ *****************************************************************************/
+
+
+/*! \example frame_context.cpp */
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+//Visp
+#include <visp/vpImageFilter.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpFrameContext.h>
+
+/*!
+
+   Check that vpFrameContext builds and blurs each level of the pyramid once per frame, whatever
+   the number of trackers asking for it, and compare the cost with one pyramid and one blur per
+   tracker. No robot is needed.
+
+   ./frame_context [--iter <n>] [--trackers <n>]
+
+ */
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 100;
+  unsigned int opt_trackers = 3;
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--trackers")
+      opt_trackers = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>] [--trackers <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  vpImage<unsigned char> I(480, 640);
+  int status = 0;
+  try {
+    srand(0);
+    vpFrameContext frame;
+    vpImage<unsigned char> level;
+    double t_shared = 0, t_own = 0;
+    for (unsigned int n=0; n < opt_iter; n++) {
+      for (unsigned int k = 0; k < I.getSize(); k++)
+        I.bitmap[k] = (unsigned char)(rand() % 256);
+
+      // Trackers sharing the context of the frame, as in the loops of the demos
+      double t = vpTime::measureTimeMs();
+      frame.setFrame(I, n);
+      for (unsigned int k = 0; k < opt_trackers; k++)
+        frame.getLevel(1);
+      t_shared += vpTime::measureTimeMs() - t;
+
+      // Trackers building their own level, as with vpTemplateTracker::setPyramidal()
+      t = vpTime::measureTimeMs();
+      for (unsigned int k = 0; k < opt_trackers; k++)
+        vpImageFilter::getGaussPyramidal(I, level);
+      t_own += vpTime::measureTimeMs() - t;
+
+      const vpImage<unsigned char> &J = frame.getLevel(1);
+      if (J.getHeight() != level.getHeight() || J.getWidth() != level.getWidth()
+          || memcmp(J.bitmap, level.bitmap, J.getSize()) != 0) {
+        std::cout << "Level 1 of the frame " << n << " differs from vpImageFilter::getGaussPyramidal()" << std::endl;
+        status = 1;
+      }
+    }
+    std::cout << "Levels built: " << frame.getNbLevelBuilds() << " for " << opt_iter << " frames and "
+              << opt_trackers << " trackers" << std::endl;
+    std::cout << "Shared pyramid: " << t_shared / opt_iter << " ms, one pyramid per tracker: "
+              << t_own / opt_iter << " ms" << std::endl;
+    if (frame.getNbLevelBuilds() != opt_iter)
+      status = 1;
+
+    // The same index keeps the levels, the upper ones being built from the lower ones
+    frame.setFrame(I, opt_iter - 1);
+    frame.getLevel(2);
+    if (frame.getNbLevelBuilds() != opt_iter + 1)
+      status = 1;
+
+    // Trackers sharing the blurred level, instead of vpTemplateTrackerSSDInverseCompositional
+    // blurring its image at each track()
+    double kernel[vpFrameContext::blurSize];
+    vpImageFilter::getGaussianKernel(kernel, vpFrameContext::blurSize);
+    vpImage<double> blurred;
+    double t_blur_shared = 0, t_blur_own = 0;
+    const unsigned long nb_blurs = frame.getNbBlurs();
+    for (unsigned int n=0; n < opt_iter; n++) {
+      for (unsigned int k = 0; k < I.getSize(); k++)
+        I.bitmap[k] = (unsigned char)(rand() % 256);
+      frame.setFrame(I, opt_iter + n);
+      const vpImage<unsigned char> &J = frame.getLevel(1);
+
+      double t = vpTime::measureTimeMs();
+      for (unsigned int k = 0; k < opt_trackers; k++)
+        frame.getBlurredLevel(1);
+      t_blur_shared += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      for (unsigned int k = 0; k < opt_trackers; k++)
+        vpImageFilter::filter(J, blurred, kernel, vpFrameContext::blurSize);
+      t_blur_own += vpTime::measureTimeMs() - t;
+
+      // The shared level is the blurred image of the tracker, rounded
+      const vpImage<unsigned char> &B = frame.getBlurredLevel(1);
+      for (unsigned int k = 0; k < B.getSize(); k++) {
+        if (std::fabs(B.bitmap[k] - blurred.bitmap[k]) > 0.5 + 1e-9) {
+          std::cout << "Blurred level 1 of the frame " << opt_iter + n << " differs from vpImageFilter::filter()" << std::endl;
+          status = 1;
+          break;
+        }
+      }
+    }
+    std::cout << "Levels blurred: " << frame.getNbBlurs() - nb_blurs << " for " << opt_iter << " frames and "
+              << opt_trackers << " trackers" << std::endl;
+    std::cout << "Shared blur: " << t_blur_shared / opt_iter << " ms, one blur per tracker: "
+              << t_blur_own / opt_iter << " ms" << std::endl;
+    if (frame.getNbBlurs() - nb_blurs != opt_iter)
+      status = 1;
+
+    // The coordinates in a level and in the frame
+    std::vector<vpImagePoint> points(1, vpImagePoint(101.5, 37.25));
+    std::vector<vpImagePoint> up = vpFrameContext::pyramidUp(vpFrameContext::pyramidDown(points, 2), 2);
+    if (vpImagePoint::distance(up[0], points[0]) > 1e-12 || vpFrameContext::pyramidDown(points, 1)[0].get_v() != 50.75)
+      status = 1;
+
+    try {
+      frame.getLevel(vpFrameContext::maxLevels + 1);
+      status = 1;
+    }
+    catch(vpException &) {
+    }
+  }
+  catch(vpException &e) {
+    std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    status = 1;
+  }
+  return status;
+}
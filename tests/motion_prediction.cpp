@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Check of the motion prediction from the joints of the robot.
+ *
+ *****************************************************************************/
+
+
+/*! \example motion_prediction.cpp */
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+//Visp
+#include <visp/vpExponentialMap.h>
+#include <visp/vpMeterPixelConversion.h>
+#include <visp/vpPoint.h>
+
+//RomeoTk
+#include <vpMotionPredictor.h>
+
+/*!
+
+   Check vpMotionPredictor on a simulated robot. No robot is needed.
+
+   ./motion_prediction
+
+   The head and the arm are moved with a constant velocity of their end-effectors during the
+   frame, so that their new poses are known exactly. The pose of the hand target predicted from
+   the joint displacements has to be the one computed from the new poses of the head and the arm,
+   and the location of a point that does not move, predicted from its depth, has to be its projection.
+ */
+
+double maxDifference(const vpHomogeneousMatrix &A, const vpHomogeneousMatrix &B)
+{
+  double diff = 0;
+  for (unsigned int i=0; i < 3; i++)
+    for (unsigned int j=0; j < 4; j++)
+      diff = std::max(diff, std::fabs(A[i][j] - B[i][j]));
+  return diff;
+}
+
+vpMatrix createJacobian(unsigned int nb_joints, double scale)
+{
+  vpMatrix eJe(6, nb_joints);
+  for (unsigned int i=0; i < 6; i++)
+    for (unsigned int j=0; j < nb_joints; j++)
+      eJe[i][j] = scale * std::cos(1.0 + 3.0 * i + 7.0 * j);
+  return eJe;
+}
+
+int main()
+{
+  int status = 0;
+
+  // Robot in the torso frame
+  vpHomogeneousMatrix fMe_head(0.05, 0.0, 0.40, 0.1, -0.2, 0.05);
+  vpHomogeneousMatrix eMc(0.07, 0.03, 0.02, -1.57, 0.0, -1.57);
+  vpHomogeneousMatrix fMe_arm(0.35, 0.20, 0.10, 0.4, 0.3, -0.6);
+  vpHomogeneousMatrix oMe(0.0, 0.03, -0.05, 0.0, 1.2, 0.3); // Hand target
+  vpHomogeneousMatrix cMo = (fMe_head * eMc).inverse() * fMe_arm * oMe.inverse();
+
+  // Joint displacements of a fast saccade of the head while the arm moves
+  vpMatrix eJe_head = createJacobian(5, 0.3);
+  vpMatrix eJe_arm = createJacobian(7, 0.4);
+  vpColVector dq_head(5), dq_arm(7);
+  for (unsigned int j=0; j < 5; j++)
+    dq_head[j] = 0.08 * std::sin(2.0 + j);
+  for (unsigned int j=0; j < 7; j++)
+    dq_arm[j] = 0.05 * std::sin(5.0 + 3.0 * j);
+
+  vpHomogeneousMatrix fMe_head_new = fMe_head * vpExponentialMap::direct(eJe_head * dq_head);
+  vpHomogeneousMatrix fMe_arm_new = fMe_arm * vpExponentialMap::direct(eJe_arm * dq_arm);
+  vpHomogeneousMatrix cMo_new = (fMe_head_new * eMc).inverse() * fMe_arm_new * oMe.inverse();
+
+  vpMotionPredictor predictor;
+  double error_none = maxDifference(predictor.predict(cMo), cMo);
+
+  predictor.setCameraMotion(eMc, eJe_head, dq_head);
+  predictor.setTargetMotion(oMe, eJe_arm, dq_arm);
+  vpHomogeneousMatrix cMo_pred = predictor.predict(cMo);
+  double error_target = maxDifference(cMo_pred, cMo_new);
+  double error_static = maxDifference(cMo_pred, (fMe_head_new * eMc).inverse() * fMe_arm * oMe.inverse());
+
+  std::cout << "Pose without motion, difference: " << error_none << std::endl;
+  std::cout << "Pose of the hand target, difference with the new pose: " << error_target
+            << " (" << error_static << " when the arm motion is not predicted)" << std::endl;
+  if (error_none > 1e-12 || error_target > 1e-9)
+    status = 1;
+
+  // Point of the scene seen by the camera
+  vpCameraParameters cam(600, 600, 320, 240);
+  vpPoint P;
+  P.setWorldCoordinates(0.1, -0.05, 0.8);
+  vpHomogeneousMatrix cMf = (fMe_head * eMc).inverse();
+  vpHomogeneousMatrix cMf_new = (fMe_head_new * eMc).inverse();
+  P.track(cMf);
+  vpImagePoint ip, ip_new;
+  vpMeterPixelConversion::convertPoint(cam, P.get_x(), P.get_y(), ip);
+  double Z = P.get_Z();
+  P.track(cMf_new);
+  vpMeterPixelConversion::convertPoint(cam, P.get_x(), P.get_y(), ip_new);
+
+  vpImagePoint ip_pred = predictor.predict(cam, ip, Z);
+  double error_point = vpImagePoint::distance(ip_pred, ip_new);
+  std::cout << "Point moved by " << vpImagePoint::distance(ip, ip_new) << " pixels, predicted within "
+            << error_point << " pixels" << std::endl;
+  if (error_point > 1e-6)
+    status = 1;
+
+  return status;
+}
@@ -0,0 +1,189 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Detection of several blob targets with a single segmentation of the image.
+ *
+ *****************************************************************************/
+
+
+/*! \example multi_blobs_tracking.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//Visp
+#include <visp/vpImageConvert.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpBlobsTargetTracker.h>
+#include <vpMultiBlobsTargetTracker.h>
+
+#include "blob_test_utils.h"
+
+/*!
+
+   Compare the detection of several targets with vpMultiBlobsTargetTracker, that segments the
+   image once, to the detection of each target with its own segmentation.
+   No robot is needed.
+
+   ./multi_blobs_tracking [--iter <n>]
+
+   From one to four targets are drawn in a synthetic image, each one with a colored blob of
+   its own color and three dark blobs. The targets are detected at each frame, first with
+   vpBlobsTargetTracker::trackTargets(), then with vpMultiBlobsTargetTracker with and without
+   the shared labeling. All the targets have to be found with the same poses, and the time per
+   frame is given for each number of targets.
+ */
+
+double poseDifference(const vpHomogeneousMatrix &M1, const vpHomogeneousMatrix &M2)
+{
+  double difference = 0;
+  for (unsigned int i=0; i < 3; i++)
+    for (unsigned int j=0; j < 4; j++)
+      difference = std::max(difference, std::fabs(M1[i][j] - M2[i][j]));
+  return difference;
+}
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 100;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  // Square target of 2.5 cm seen at about 40 cm, like the hand targets
+  const double L = 0.025/2;
+  std::vector<vpPoint> points(4);
+  points[2].setWorldCoordinates(-L,-L, 0);
+  points[1].setWorldCoordinates(-L, L, 0);
+  points[0].setWorldCoordinates( L, L, 0);
+  points[3].setWorldCoordinates( L,-L, 0);
+  vpCameraParameters cam(600, 600, 320, 240);
+
+  // Blobs around the center of each target, the colored one first
+  const double blob_u[4] = {21.5, -17.5, -22.5, 17.5};
+  const double blob_v[4] = {-16.5, -20.5, 16.5, 20.5};
+  const double center_u[4] = {320, 160, 480, 320};
+  const double center_v[4] = {240, 120, 120, 380};
+
+  // Red, green, blue and magenta blobs, with their HSV range
+  const cv::Vec3b colors[4] = {cv::Vec3b(40, 40, 220), cv::Vec3b(40, 200, 40), cv::Vec3b(220, 60, 40), cv::Vec3b(200, 40, 200)};
+  const int hue[4] = {5, 60, 117, 150};
+  const std::string names[4] = {"red", "green", "blue", "magenta"};
+
+  cv::Mat cvI(480, 640, CV_8UC3, cv::Scalar(220, 220, 220));
+  vpImage<unsigned char> I;
+  int status = 0;
+  double t_first_separate = 0, t_first_shared = 0;
+
+  for (unsigned int nb = 1; nb <= 4; nb++) {
+    const unsigned int t = nb - 1;
+    drawDisk(cvI, center_u[t] + blob_u[0], center_v[t] + blob_v[0], 7, colors[t]);
+    for (unsigned int i = 1; i < 4; i++)
+      drawDisk(cvI, center_u[t] + blob_u[i], center_v[t] + blob_v[i], 7, cv::Vec3b(30, 30, 30));
+    vpImageConvert::convert(cvI, I);
+
+    vpBlobsTargetTrackerTest separate[4], shared[4], unshared[4];
+    std::vector<vpBlobsTargetTracker*> targets;
+    vpMultiBlobsTargetTracker multi, multi_unshared;
+    multi_unshared.setSharedLabeling(false);
+    for (unsigned int k = 0; k < nb; k++) {
+      const int hsv_min[3] = {std::max(0, hue[k] - 10), 150, 150};
+      const int hsv_max[3] = {hue[k] + 10, 255, 255};
+      vpBlobsTargetTrackerTest *trackers[3] = {&separate[k], &shared[k], &unshared[k]};
+      for (unsigned int n = 0; n < 3; n++) {
+        trackers[n]->setName(names[k]);
+        trackers[n]->setCameraParameters(cam);
+        trackers[n]->setPoints(points);
+        trackers[n]->setValuesHSV(hsv_min, hsv_max);
+      }
+      targets.push_back(&separate[k]);
+      multi.addTarget(shared[k]);
+      multi_unshared.addTarget(unshared[k]);
+    }
+
+    // Detection at each frame, each target with its own segmentation
+    std::vector<bool> status_targets;
+    unsigned int nb_separate = 0;
+    double t_start = vpTime::measureTimeMs();
+    for (unsigned int n = 0; n < opt_iter; n++) {
+      for (unsigned int k = 0; k < nb; k++)
+        separate[k].setForceDetection(true);
+      vpBlobsTargetTracker::trackTargets(targets, cvI, I, status_targets);
+      if (std::count(status_targets.begin(), status_targets.end(), true) == (int)nb)
+        nb_separate++;
+    }
+    double t_separate = (vpTime::measureTimeMs() - t_start) / opt_iter;
+
+    // Detection at each frame with a single segmentation
+    unsigned int nb_shared = 0;
+    t_start = vpTime::measureTimeMs();
+    for (unsigned int n = 0; n < opt_iter; n++) {
+      for (unsigned int k = 0; k < nb; k++)
+        shared[k].setForceDetection(true);
+      if (multi.track(cvI, I))
+        nb_shared++;
+    }
+    double t_shared = (vpTime::measureTimeMs() - t_start) / opt_iter;
+
+    for (unsigned int k = 0; k < nb; k++)
+      unshared[k].setForceDetection(true);
+    bool tracked_unshared = multi_unshared.track(cvI, I);
+
+    double pose_difference = 0;
+    for (unsigned int k = 0; k < nb; k++) {
+      pose_difference = std::max(pose_difference, poseDifference(separate[k].get_cMo(), shared[k].get_cMo()));
+      pose_difference = std::max(pose_difference, poseDifference(separate[k].get_cMo(), unshared[k].get_cMo()));
+    }
+
+    if (nb == 1) {
+      t_first_separate = t_separate;
+      t_first_shared = t_shared;
+    }
+    std::cout << nb << " target(s), separate segmentations: " << t_separate << " ms ("
+              << t_separate / t_first_separate << "x), single segmentation: " << t_shared << " ms ("
+              << t_shared / t_first_shared << "x), " << nb_separate << "/" << nb_shared << "/" << opt_iter
+              << " frames with all the targets found, pose difference: " << pose_difference << std::endl;
+    if (nb_separate != opt_iter || nb_shared != opt_iter || !tracked_unshared || pose_difference > 0)
+      status = 1;
+  }
+
+  return status;
+}
@@ -0,0 +1,172 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tracking of two qrcodes with vpMultiQRCodeTracker.
+ *
+ *****************************************************************************/
+
+
+/*! \example multi_qrcode_tracking.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//Visp
+#include <visp/vpImageIo.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpMultiQRCodeTracker.h>
+
+#include "qrcode_test_utils.h"
+
+/*!
+
+   Track two qrcodes moving on synthetic frames, with a vpQRCodeTracker per code and with
+   vpMultiQRCodeTracker, without and with the verification of the tracked codes. No robot is
+   needed.
+
+   ./multi_qrcode_tracking [--iter <n>]
+
+   The qrcodes of the left arm and of the reference pose of the left arm are drawn on a gray
+   background, the second one being hidden during 20 frames. Both methods have to track the codes
+   on all the frames where they are visible. vpMultiQRCodeTracker has to decode at most once per
+   frame, less often than the separate trackers, and to search the hidden code around its last
+   location only. With a verification every 5 frames, both codes have to be verified by a single
+   decoding at most every 5 frames, without being detected again more often.
+ */
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 150;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  int status = 0;
+  try {
+    vpImage<unsigned char> code[2];
+    vpImageIo::read(code[0], std::string(ROMEOTK_DATA_FOLDER) + "/doc/QR-Code/qrcode_romeo_left_arm.png");
+    vpImageIo::read(code[1], std::string(ROMEOTK_DATA_FOLDER) + "/doc/QR-Code/LArm_ref_pose.png");
+    const std::string messages[2] = {"romeo_left_arm", "LArm_ref_pose"};
+    const unsigned int hidden_begin = opt_iter / 3, hidden_end = hidden_begin + 20;
+
+    vpCameraParameters cam(600, 600, 320, 240);
+    vpImage<unsigned char> I(480, 640);
+    const unsigned int verification_period = 5;
+    unsigned long nb_decodes[3];
+    unsigned int nb_searches[3];
+    double times[3];
+    for (unsigned int mode=0; mode < 3; mode++) {
+      vpQRCodeTracker trackers[2];
+      vpMultiQRCodeTracker multi;
+      for (unsigned int c=0; c < 2; c++) {
+        trackers[c].setCameraParameters(cam);
+        trackers[c].setQRCodeSize(0.045);
+        trackers[c].setMessage(messages[c]);
+        if (mode == 2)
+          trackers[c].setVerificationPeriod(verification_period);
+        if (mode > 0)
+          multi.addTarget(trackers[c]);
+      }
+
+      unsigned int nb_missed = 0, nb_multiple_decodes = 0, nb_local_searches = 0;
+      nb_searches[mode] = 0;
+      double t_total = 0;
+      unsigned long decodes_prev = 0;
+      for (unsigned int n=0; n < opt_iter; n++) {
+        bool hidden = (n >= hidden_begin && n < hidden_end);
+        I = 100;
+        drawCode(code[0], I, 170 + 30 * sin(n / 20.), 240 + 30 * cos(n / 25.), 0.25);
+        if (! hidden)
+          drawCode(code[1], I, 470 + 30 * cos(n / 30.), 240 + 30 * sin(n / 20.), 0.25);
+
+        bool found[2];
+        double t = vpTime::measureTimeMs();
+        if (mode == 0) {
+          for (unsigned int c=0; c < 2; c++)
+            found[c] = trackers[c].track(I);
+        }
+        else {
+          multi.track(I);
+          for (unsigned int c=0; c < 2; c++)
+            found[c] = multi.getStatus(c);
+        }
+        t_total += vpTime::measureTimeMs() - t;
+
+        // The hidden code may be followed on the first hidden frame, and needs a frame to be detected again
+        if (! found[0] || (! found[1] && ! hidden && n != hidden_end))
+          nb_missed++;
+        if (mode > 0) {
+          if (multi.getNbDecodes() > decodes_prev + 1)
+            nb_multiple_decodes++;
+          decodes_prev = multi.getNbDecodes();
+          if (multi.getSearchArea().getWidth() > 0 && multi.getSearchArea().getWidth() < I.getWidth())
+            nb_local_searches++;
+          if (multi.getSearchArea().getWidth() > 0)
+            nb_searches[mode]++;
+        }
+      }
+
+      nb_decodes[mode] = mode == 0 ? trackers[0].getNbDecodes() + trackers[1].getNbDecodes() : multi.getNbDecodes();
+      times[mode] = t_total / opt_iter;
+      std::cout << (mode == 0 ? "Separate trackers: " : (mode == 1 ? "vpMultiQRCodeTracker: " : "vpMultiQRCodeTracker with verification: "))
+                << nb_missed << " frames missed, " << nb_decodes[mode] << " decodings, " << times[mode] << " ms per frame";
+      if (mode > 0)
+        std::cout << ", " << nb_local_searches << " local searches";
+      if (mode == 2)
+        std::cout << ", " << multi.getNbVerifications() << " verifications";
+      std::cout << std::endl;
+      if (nb_missed || nb_multiple_decodes || (mode > 0 && nb_local_searches == 0))
+        status = 1;
+      // One decoding verifies both codes, and the verified codes are not detected again
+      if (mode == 2 && (multi.getNbVerifications() == 0 || multi.getNbVerifications() > opt_iter / verification_period
+                        || nb_searches[2] != nb_searches[1]))
+        status = 1;
+    }
+    if (nb_decodes[1] > nb_decodes[0])
+      status = 1;
+  }
+  catch(vpException &e) {
+    std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    status = 1;
+  }
+
+  return status;
+}
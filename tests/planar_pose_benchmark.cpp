@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Accuracy and latency of the planar pose of vpPointPoseSolver compared with vpPose.
+ *
+ *****************************************************************************/
+
+
+/*! \example planar_pose_benchmark.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Visp
+#include <visp/vpPose.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpPointPoseSolver.h>
+
+#include "simulation_test_utils.h"
+
+/*!
+
+   Compare the initial pose of the planar targets given by vpPointPoseSolver::initPose() with the
+   previous path, that ran vpPose::DEMENTHON_VIRTUAL_VS and vpPose::LAGRANGE_VIRTUAL_VS, kept the
+   pose with the smallest residual and refined it with vpPose::VIRTUAL_VS. No robot is needed.
+
+   ./planar_pose_benchmark [--iter <n>] [--noise <pixel>]
+
+   The four corners of a QR code of 6 cm are projected with random poses, and a gaussian noise
+   is added to their location (0.3 pixel by default). The errors in translation and rotation
+   with respect to the true pose are reported for both methods, with their latency. Without
+   noise, both poses have to be the true one. The closed-form solutions of computePlanarPose()
+   are also checked alone.
+ */
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 1000;
+  double opt_noise = 0.3;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--noise")
+      opt_noise = atof(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>] [--noise <pixel>]" << std::endl;
+      return 0;
+    }
+  }
+
+  const double px = 600; // Focal length in pixel, to convert the noise
+  const double L = 0.06/2;
+  std::vector<vpPoint> points(4);
+  points[0].setWorldCoordinates(-L, -L, 0);
+  points[1].setWorldCoordinates(-L,  L, 0);
+  points[2].setWorldCoordinates( L,  L, 0);
+  points[3].setWorldCoordinates( L, -L, 0);
+
+  int status = 0;
+  srand(0);
+
+  for (unsigned int test=0; test < 2; test++) {
+    const double noise = (test == 0) ? 0. : opt_noise;
+    double t_ref = 0, t_new = 0, t_ippe = 0;
+    double t_err_ref = 0, r_err_ref = 0, t_err_new = 0, r_err_new = 0, t_err_ippe = 0, r_err_ippe = 0;
+    double t_err_ref_max = 0, r_err_ref_max = 0, t_err_new_max = 0, r_err_new_max = 0;
+    unsigned int nb_failures = 0;
+    vpPointPoseSolver solver;
+
+    for (unsigned int n=0; n < opt_iter; n++) {
+      vpHomogeneousMatrix cMo_true(randomValue(-0.15, 0.15), randomValue(-0.1, 0.1), randomValue(0.3, 1.0),
+                                   vpMath::rad(randomValue(-50, 50)), vpMath::rad(randomValue(-50, 50)),
+                                   vpMath::rad(randomValue(-180, 180)));
+      for (unsigned int i=0; i < points.size(); i++) {
+        points[i].track(cMo_true);
+        points[i].set_x(points[i].get_x() + randomGaussian(noise) / px);
+        points[i].set_y(points[i].get_y() + randomGaussian(noise) / px);
+      }
+
+      // Previous path
+      double t = vpTime::measureTimeMs();
+      vpPose pose;
+      for (unsigned int i=0; i < points.size(); i++)
+        pose.addPoint(points[i]);
+      vpHomogeneousMatrix cMo_ref, cMo_dementhon, cMo_lagrange;
+      pose.computePose(vpPose::DEMENTHON_VIRTUAL_VS, cMo_dementhon);
+      double residual_dementhon = pose.computeResidual(cMo_dementhon);
+      pose.computePose(vpPose::LAGRANGE_VIRTUAL_VS, cMo_lagrange);
+      double residual_lagrange = pose.computeResidual(cMo_lagrange);
+      cMo_ref = (residual_dementhon < residual_lagrange) ? cMo_dementhon : cMo_lagrange;
+      pose.computePose(vpPose::VIRTUAL_VS, cMo_ref);
+      t_ref += vpTime::measureTimeMs() - t;
+
+      // Closed form, then refinement of both solutions
+      t = vpTime::measureTimeMs();
+      solver.setPoints(points);
+      vpHomogeneousMatrix cMo;
+      bool found = solver.initPose(cMo);
+      t_new += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      vpHomogeneousMatrix cMo1, cMo2;
+      found = solver.computePlanarPose(cMo1, cMo2) && found;
+      t_ippe += vpTime::measureTimeMs() - t;
+      if (!found) {
+        nb_failures++;
+        continue;
+      }
+
+      double t_error, r_error;
+      poseError(cMo_ref, cMo_true, t_error, r_error);
+      t_err_ref += t_error;  r_err_ref += r_error;
+      t_err_ref_max = std::max(t_err_ref_max, t_error);  r_err_ref_max = std::max(r_err_ref_max, r_error);
+      poseError(cMo, cMo_true, t_error, r_error);
+      t_err_new += t_error;  r_err_new += r_error;
+      t_err_new_max = std::max(t_err_new_max, t_error);  r_err_new_max = std::max(r_err_new_max, r_error);
+      poseError(cMo1, cMo_true, t_error, r_error);
+      t_err_ippe += t_error;  r_err_ippe += r_error;
+    }
+
+    std::cout << "Noise " << noise << " pixel:" << std::endl;
+    std::cout << "  vpPose: " << 1000. * t_ref / opt_iter << " us, mean error " << 1000. * t_err_ref / opt_iter << " mm "
+              << r_err_ref / opt_iter << " deg, max error " << 1000. * t_err_ref_max << " mm " << r_err_ref_max << " deg" << std::endl;
+    std::cout << "  vpPointPoseSolver::initPose(): " << 1000. * t_new / opt_iter << " us, mean error "
+              << 1000. * t_err_new / opt_iter << " mm " << r_err_new / opt_iter << " deg, max error "
+              << 1000. * t_err_new_max << " mm " << r_err_new_max << " deg, speedup " << t_ref / t_new << std::endl;
+    std::cout << "  vpPointPoseSolver::computePlanarPose(): " << 1000. * t_ippe / opt_iter << " us, mean error "
+              << 1000. * t_err_ippe / opt_iter << " mm " << r_err_ippe / opt_iter << " deg" << std::endl;
+    if (nb_failures) {
+      std::cout << "  " << nb_failures << " failures" << std::endl;
+      status = 1;
+    }
+    if (noise == 0. && (t_err_new_max > 1e-6 || r_err_new_max > 1e-4))
+      status = 1;
+    // With noise, the closed form and its refinement have to be as accurate as vpPose
+    if (noise > 0. && (t_err_new > 1.1 * t_err_ref || r_err_new > 1.1 * r_err_ref))
+      status = 1;
+  }
+
+  return status;
+}
@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Filtering of a noisy pose with vpPoseFilter.
+ *
+ *****************************************************************************/
+
+
+/*! \example pose_filter.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+//Visp
+#include <visp/vpExponentialMap.h>
+
+//RomeoTk
+#include <vpPoseFilter.h>
+
+#include "simulation_test_utils.h"
+
+/*!
+
+   Check vpPoseFilter on a simulated target. No robot is needed.
+
+   ./pose_filter [--iter <n>]
+
+   The target moves with a constant velocity in front of the camera and its pose is measured at
+   30 Hz with a noise of 2 mm and 1 degree, one frame out of ten being dropped. The filtered pose
+   has to be closer to the true pose than the measured one, and the pose predicted for the dropped
+   frames has to be closer to the true pose than a measurement. After a long loss, the filter has
+   to be invalid and to start again from the next measurement.
+ */
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 300;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  const double sigma_t = 0.002, sigma_r = vpMath::rad(1.);
+  vpMatrix R(6, 6);
+  for (unsigned int i=0; i < 6; i++)
+    R[i][i] = vpMath::sqr(i < 3 ? sigma_t : sigma_r);
+
+  // Velocity of the target in the camera frame, per second
+  vpColVector v(6);
+  v[0] = 0.05; v[1] = -0.03; v[2] = 0.02; v[3] = 0.1; v[4] = -0.2; v[5] = 0.3;
+  const vpHomogeneousMatrix cMo_init(0.05, 0.02, 0.5, 0.2, -0.3, 0.5);
+  const double period = 33.; // ms
+
+  // The simulated target does not accelerate, the filter can smooth more than with the default noise
+  vpPoseFilter filter;
+  filter.setProcessNoise(0.05, 0.2);
+  srand(0);
+  double t_err_raw = 0, r_err_raw = 0, t_err_filter = 0, r_err_filter = 0, t_err_predict = 0, r_err_predict = 0;
+  unsigned int nb_measures = 0, nb_dropped = 0;
+  bool valid = true;
+
+  for (unsigned int n=0; n < opt_iter; n++) {
+    const double t = n * period;
+    vpHomogeneousMatrix cMo_true = vpExponentialMap::direct(v, t / 1000.) * cMo_init;
+    if (n % 10 == 9) {
+      // Dropped frame, the pose is predicted
+      valid = valid && filter.isValid(t);
+      double t_error, r_error;
+      poseError(filter.predictPose(t), cMo_true, t_error, r_error);
+      t_err_predict += t_error;  r_err_predict += r_error;
+      nb_dropped++;
+      continue;
+    }
+
+    vpColVector noise(6);
+    for (unsigned int i=0; i < 6; i++)
+      noise[i] = randomGaussian(i < 3 ? sigma_t : sigma_r);
+    vpHomogeneousMatrix cMo_measured = vpExponentialMap::direct(noise) * cMo_true;
+    filter.update(cMo_measured, R, t);
+
+    // The first frames are needed to estimate the velocity
+    if (n < 30)
+      continue;
+    double t_error, r_error;
+    poseError(cMo_measured, cMo_true, t_error, r_error);
+    t_err_raw += t_error;  r_err_raw += r_error;
+    poseError(filter.get_cMo(), cMo_true, t_error, r_error);
+    t_err_filter += t_error;  r_err_filter += r_error;
+    nb_measures++;
+  }
+
+  int status = 0;
+  std::cout << "Measured pose: mean error " << 1000. * t_err_raw / nb_measures << " mm "
+            << r_err_raw / nb_measures << " deg" << std::endl;
+  std::cout << "Filtered pose: mean error " << 1000. * t_err_filter / nb_measures << " mm "
+            << r_err_filter / nb_measures << " deg" << std::endl;
+  std::cout << "Predicted pose of the dropped frames: mean error " << 1000. * t_err_predict / nb_dropped << " mm "
+            << r_err_predict / nb_dropped << " deg" << std::endl;
+  if (!valid || t_err_filter > 0.8 * t_err_raw || r_err_filter > 0.8 * r_err_raw
+      || t_err_predict / nb_dropped > t_err_raw / nb_measures || r_err_predict / nb_dropped > r_err_raw / nb_measures)
+    status = 1;
+
+  // Long loss of the target
+  double t_lost = opt_iter * period + 1000.;
+  bool valid_after_loss = filter.isValid(t_lost);
+  filter.update(cMo_init, R, t_lost);
+  double t_error, r_error;
+  poseError(filter.get_cMo(), cMo_init, t_error, r_error);
+  std::cout << "After a loss of one second: " << (valid_after_loss ? "valid" : "invalid")
+            << ", pose error after the next measurement " << 1000. * t_error << " mm " << r_error << " deg" << std::endl;
+  if (valid_after_loss || t_error > 1e-9 || r_error > 1e-4)
+    status = 1;
+
+  return status;
+}
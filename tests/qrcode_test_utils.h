@@ -0,0 +1,135 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Synthetic qrcode frames shared by the qrcode tests.
+ *
+ *****************************************************************************/
+
+#ifndef __qrcode_test_utils_h__
+#define __qrcode_test_utils_h__
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//Visp
+#include <visp/vpDetectorQRCode.h>
+#include <visp/vpImage.h>
+#include <visp/vpImagePoint.h>
+
+/*!
+  Draw \e code in \e I with the similarity of scale \e s and angle \e theta, the center of the
+  code being at (\e u, \e v), with a white margin of a tenth of the code around it. The pixels
+  outside the margin are left unchanged, so that several codes can be drawn on the same background.
+  \return The similarity, 2x3 row major, from the code to the frame.
+ */
+inline std::vector<double> drawCode(const vpImage<unsigned char> &code, vpImage<unsigned char> &I,
+                                    double u, double v, double s, double theta = 0.)
+{
+  std::vector<double> A(6);
+  A[0] = s * cos(theta);  A[1] = -s * sin(theta);
+  A[3] = s * sin(theta);  A[4] = s * cos(theta);
+  A[2] = u - A[0] * code.getWidth() / 2. - A[1] * code.getHeight() / 2.;
+  A[5] = v - A[3] * code.getWidth() / 2. - A[4] * code.getHeight() / 2.;
+
+  // Bounding box of the code and its margin in the frame
+  const double margin = 0.1 * code.getWidth();
+  const double half = s * (0.5 * std::max(code.getWidth(), code.getHeight()) + margin) * std::sqrt(2.);
+  const int i_min = std::max(0, (int)(v - half)), i_max = std::min((int)I.getHeight() - 1, (int)(v + half) + 1);
+  const int j_min = std::max(0, (int)(u - half)), j_max = std::min((int)I.getWidth() - 1, (int)(u + half) + 1);
+  for (int i = i_min; i <= i_max; i++)
+    for (int j = j_min; j <= j_max; j++) {
+      // Inverse of the similarity
+      double du = j - A[2], dv = i - A[5];
+      double x = ( A[4] * du - A[1] * dv) / (s * s);
+      double y = (-A[3] * du + A[0] * dv) / (s * s);
+      if (x < -margin || y < -margin || x > code.getWidth() - 1 + margin || y > code.getHeight() - 1 + margin)
+        continue;
+      if (x < 0 || y < 0 || x >= code.getWidth() - 1 || y >= code.getHeight() - 1)
+        I[i][j] = 255;
+      else {
+        // Bilinear interpolation
+        int x0 = (int)x, y0 = (int)y;
+        double ax = x - x0, ay = y - y0;
+        double level = (1 - ay) * ((1 - ax) * code[y0][x0] + ax * code[y0][x0+1])
+            + ay * ((1 - ax) * code[y0+1][x0] + ax * code[y0+1][x0+1]);
+        I[i][j] = (unsigned char)(level + 0.5);
+      }
+    }
+  return A;
+}
+
+/*!
+  Corners of the qrcode in the code image, found by decoding the code drawn at a scale of 0.3.
+  \param code : Image of the code.
+  \param corners_code : Corners in the coordinates of \e code.
+  \return false if the code cannot be decoded.
+ */
+inline bool getCodeCorners(const vpImage<unsigned char> &code, std::vector<vpImagePoint> &corners_code)
+{
+  const double s = 0.3;
+  vpImage<unsigned char> I(480, 640, 100);
+  std::vector<double> A = drawCode(code, I, 320, 240, s);
+  vpDetectorQRCode detector;
+  if (! detector.detect(I) || detector.getNbObjects() != 1)
+    return false;
+
+  corners_code = detector.getPolygon(0);
+  for (size_t k=0; k < corners_code.size(); k++) {
+    double du = corners_code[k].get_u() - A[2], dv = corners_code[k].get_v() - A[5];
+    corners_code[k].set_uv((A[4] * du - A[1] * dv) / (s * s), (-A[3] * du + A[0] * dv) / (s * s));
+  }
+  return true;
+}
+
+/*!
+  Largest distance of the tracked corners to the nearest corner of the code drawn with drawCode().
+  \param A : Similarity returned by drawCode().
+  \param corners_code : Corners of the code given by getCodeCorners().
+  \param corners : Tracked corners.
+ */
+inline double getCornerError(const std::vector<double> &A, const std::vector<vpImagePoint> &corners_code,
+                             const std::vector<vpImagePoint> &corners)
+{
+  double error_max = 0;
+  for (size_t k=0; k < corners.size(); k++) {
+    double distance_min = 1e9;
+    for (size_t l=0; l < corners_code.size(); l++) {
+      vpImagePoint ip(A[3] * corners_code[l].get_u() + A[4] * corners_code[l].get_v() + A[5],
+                      A[0] * corners_code[l].get_u() + A[1] * corners_code[l].get_v() + A[2]);
+      distance_min = std::min(distance_min, vpImagePoint::distance(ip, corners[k]));
+    }
+    error_max = std::max(error_max, distance_min);
+  }
+  return error_max;
+}
+
+#endif
@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Decoding frequency and cost of vpQRCodeTracker.
+ *
+ *****************************************************************************/
+
+
+/*! \example qrcode_tracking.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Visp
+#include <visp/vpImageIo.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpQRCodeTracker.h>
+
+#include "qrcode_test_utils.h"
+
+/*!
+
+   Track a qrcode moving on synthetic frames with vpQRCodeTracker, decoding it on every frame,
+   only to detect it, and every 15 frames in a background thread. No robot is needed.
+
+   ./qrcode_tracking [--iter <n>] [--period <frames>]
+
+   The qrcode of the left arm of Romeo is drawn on a gray background with a translation, a
+   rotation and a scale that change at each frame. The tracker has to follow it on all the frames
+   in the three modes, with corners close to the drawn ones and a tracking quality that never
+   reports a loss, while decoding the qrcode only once when the verification is disabled, and
+   about once per period with it.
+ */
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 150;
+  unsigned int opt_period = 15;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--period")
+      opt_period = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>] [--period <frames>]" << std::endl;
+      return 0;
+    }
+  }
+
+  int status = 0;
+  try {
+    vpImage<unsigned char> code;
+    vpImageIo::read(code, std::string(ROMEOTK_DATA_FOLDER) + "/doc/QR-Code/qrcode_romeo_left_arm.png");
+
+    // Corners of the qrcode in the code image
+    std::vector<vpImagePoint> corners_code;
+    if (! getCodeCorners(code, corners_code)) {
+      std::cout << "Cannot decode the qrcode" << std::endl;
+      return 1;
+    }
+    vpImage<unsigned char> I(480, 640);
+
+    vpCameraParameters cam(600, 600, 320, 240);
+    const char *names[] = {"Decoded on every frame", "Decoded to detect", "Verified in background"};
+    double times[3];
+    for (unsigned int mode=0; mode < 3; mode++) {
+      vpQRCodeTracker tracker;
+      tracker.setCameraParameters(cam);
+      tracker.setQRCodeSize(0.045);
+      tracker.setMessage("romeo_left_arm");
+      tracker.setVerificationPeriod(mode == 0 ? 1 : (mode == 1 ? 0 : opt_period));
+      tracker.setAsyncVerification(mode == 2);
+
+      unsigned int nb_found = 0;
+      double error_max = 0, t_total = 0;
+      for (unsigned int n=0; n < opt_iter; n++) {
+        double s = 0.3 + 0.05 * sin(n / 20.);
+        I = 100;
+        std::vector<double> A = drawCode(code, I, 320 + 60 * sin(n / 25.), 240 + 40 * cos(n / 30.), s, 0.2 * sin(n / 40.));
+
+        double t = vpTime::measureTimeMs();
+        bool found = tracker.track(I);
+        t_total += vpTime::measureTimeMs() - t;
+        if (! found)
+          continue;
+        nb_found++;
+
+        // Distance of each tracked corner to the nearest drawn one
+        error_max = std::max(error_max, getCornerError(A, corners_code, tracker.getCorners()));
+      }
+
+      times[mode] = t_total / opt_iter;
+      std::cout << names[mode] << ": found on " << nb_found << "/" << opt_iter << " frames, "
+                << tracker.getNbDecodes() << " decodings, " << times[mode] << " ms per frame, largest corner error "
+                << error_max << " pixel" << std::endl;
+      tracker.getTrackingQuality().printHistogram(std::cout);
+      // Extra cost of the tracking quality, whose residual warps the template once more
+      std::cout << "Tracking quality: " << tracker.getTrackingQuality().getTime() / opt_iter << " ms per frame, "
+                << 100. * tracker.getTrackingQuality().getTime() / t_total << "% of the time per frame" << std::endl;
+      if (nb_found < opt_iter || error_max > 3. || tracker.getTrackingQuality().getNbLosses() > 0)
+        status = 1;
+      if ((mode == 1 && tracker.getNbDecodes() != 1)
+          || (mode == 2 && tracker.getNbDecodes() > 2 + opt_iter / std::max(opt_period, 1u)))
+        status = 1;
+    }
+    std::cout << "Speedup without decoding on every frame: " << times[0] / times[1]
+              << ", with a verification in background: " << times[0] / times[2] << std::endl;
+    if (times[2] > times[0])
+      status = 1;
+  }
+  catch(vpException &e) {
+    std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    status = 1;
+  }
+
+  return status;
+}
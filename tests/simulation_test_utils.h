@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Random values and pose errors shared by the simulation tests.
+ *
+ *****************************************************************************/
+
+#ifndef __simulation_test_utils_h__
+#define __simulation_test_utils_h__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+//Visp
+#include <visp/vpHomogeneousMatrix.h>
+#include <visp/vpMath.h>
+#include <visp/vpThetaUVector.h>
+
+/*!
+  Uniform random value in [\e min, \e max], drawn with rand().
+ */
+inline double randomValue(double min, double max)
+{
+  return min + (max - min) * rand() / (double)RAND_MAX;
+}
+
+/*!
+  Gaussian random value of zero mean and standard deviation \e sigma, drawn with rand().
+ */
+inline double randomGaussian(double sigma)
+{
+  // Box-Muller
+  double u1 = std::max(rand() / (double)RAND_MAX, 1e-12);
+  double u2 = rand() / (double)RAND_MAX;
+  return sigma * std::sqrt(-2 * std::log(u1)) * std::cos(2 * M_PI * u2);
+}
+
+/*!
+  Translation and rotation errors between two poses, in meter and degree.
+ */
+inline void poseError(const vpHomogeneousMatrix &cMo, const vpHomogeneousMatrix &cMo_true, double &t_error, double &r_error)
+{
+  vpHomogeneousMatrix cdMc = cMo_true * cMo.inverse();
+  t_error = (cMo.getTranslationVector() - cMo_true.getTranslationVector()).euclideanNorm();
+  vpThetaUVector tu(cdMc.getRotationMatrix());
+  r_error = vpMath::deg(std::sqrt(tu.sumSquare()));
+}
+
+#endif
@@ -0,0 +1,144 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Reuse of the templates of vpQRCodeTracker between its initializations.
+ *
+ *****************************************************************************/
+
+
+/*! \example template_cache.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Visp
+#include <visp/vpImageIo.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpQRCodeTracker.h>
+
+#include "qrcode_test_utils.h"
+
+/*!
+
+   Initialize vpQRCodeTracker at every frame on synthetic frames, with and without its template
+   cache. No robot is needed.
+
+   ./template_cache [--iter <n>]
+
+   The qrcode of the left arm of Romeo is drawn on a gray background with a translation, a
+   rotation and a scale that change at each frame, and the detection is forced so that the tracker
+   is initialized at every frame. With the cache, the template has to be built once and reused on
+   the other frames, with corners as close to the drawn ones as when it is built at every frame.
+ */
+
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 100;
+
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  int status = 0;
+  try {
+    vpImage<unsigned char> code;
+    vpImageIo::read(code, std::string(ROMEOTK_DATA_FOLDER) + "/doc/QR-Code/qrcode_romeo_left_arm.png");
+
+    // Corners of the qrcode in the code image
+    std::vector<vpImagePoint> corners_code;
+    if (! getCodeCorners(code, corners_code)) {
+      std::cout << "Cannot decode the qrcode" << std::endl;
+      return 1;
+    }
+    vpImage<unsigned char> I(480, 640);
+
+    vpCameraParameters cam(600, 600, 320, 240);
+    const char *names[] = {"Template built at each initialization", "Cached template"};
+    double times[2], errors[2];
+    for (unsigned int mode=0; mode < 2; mode++) {
+      vpQRCodeTracker tracker;
+      tracker.setCameraParameters(cam);
+      tracker.setQRCodeSize(0.045);
+      tracker.setMessage("romeo_left_arm");
+      tracker.setForceDetection(true);
+      tracker.getTemplateCache().setEnabled(mode == 1);
+
+      unsigned int nb_found = 0;
+      double error_max = 0, t_total = 0;
+      for (unsigned int n=0; n < opt_iter; n++) {
+        double s = 0.3 + 0.05 * sin(n / 20.);
+        I = 100;
+        std::vector<double> A = drawCode(code, I, 320 + 60 * sin(n / 25.), 240 + 40 * cos(n / 30.), s, 0.2 * sin(n / 40.));
+
+        double t = vpTime::measureTimeMs();
+        bool found = tracker.track(I);
+        t_total += vpTime::measureTimeMs() - t;
+        if (! found)
+          continue;
+        nb_found++;
+
+        // Distance of each tracked corner to the nearest drawn one
+        error_max = std::max(error_max, getCornerError(A, corners_code, tracker.getCorners()));
+      }
+
+      const vpTemplateCache &cache = tracker.getTemplateCache();
+      times[mode] = t_total / opt_iter;
+      errors[mode] = error_max;
+      std::cout << names[mode] << ": found on " << nb_found << "/" << opt_iter << " frames, "
+                << cache.getNbBuilds() << " templates built, " << cache.getNbReuses() << " reused, "
+                << times[mode] << " ms per frame, largest corner error " << error_max << " pixel" << std::endl;
+      if (nb_found < opt_iter || error_max > 3.)
+        status = 1;
+      if ((mode == 0 && cache.getNbBuilds() != opt_iter) || (mode == 1 && cache.getNbBuilds() + cache.getNbReuses() != opt_iter)
+          || (mode == 1 && cache.getNbReuses() < opt_iter / 2))
+        status = 1;
+    }
+    std::cout << "Speedup of the cache: " << times[0] / times[1] << std::endl;
+    if (times[1] > times[0] || errors[1] > errors[0] + 1.)
+      status = 1;
+  }
+  catch(vpException &e) {
+    std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    status = 1;
+  }
+
+  return status;
+}
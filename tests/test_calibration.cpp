@@ -215,7 +215,6 @@ int main(int argc, const char* argv[])
             firstTime[i] = true;
             objects[i].setPoints(points);
 
-            objects[i].setLeftHandTarget(!opt_rarm);
             // objects[i].setManualBlobInit(true);
 
             //      color_rects.at(i).id = vpColor::vpColorIdentifier( std::rand() % ( 18 + 1 ) );
@@ -0,0 +1,159 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2014 by INRIA. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact INRIA about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://team.inria.fr/lagadic/visp for more information.
+ *
+ * This software was developed at:
+ * INRIA Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ * http://team.inria.fr/lagadic
+ *
+ * If you have questions regarding the use of this file, please contact
+ * INRIA at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Conditioning of the warps and residual used by the tracking quality of the template trackers.
+ *
+ *****************************************************************************/
+
+
+/*! \example tracking_quality.cpp */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+//Visp
+#include <visp/vpMath.h>
+#include <visp/vpTemplateTrackerWarpHomography.h>
+#include <visp/vpTemplateTrackerZone.h>
+#include <visp/vpTime.h>
+
+//RomeoTk
+#include <vpTemplateTrackerResidual.h>
+#include <vpTrackingQuality.h>
+
+/*!
+
+   Check the conditioning computed by vpTrackingQuality on a square zone warped by homographies,
+   and the residual kept by vpTemplateTrackerResidual. No robot is needed.
+
+   ./tracking_quality [--iter <n>]
+
+   A rotation with a scale keeps a conditioning of 1, an anisotropic scale of 2 gives 2 and a warp
+   that flattens the zone on a line gives an infinite conditioning.
+
+   Then a textured template is tracked on frames shifted by a fraction of pixel. The residual of
+   the last iteration has to be close to the one that vpTemplateTrackerSSD::getSSD() computes
+   with the final parameters, and the time of getSSD(), that update() does not spend anymore, is
+   printed next to the time of the tracking.
+ */
+int main(int argc, const char* argv[])
+{
+  unsigned int opt_iter = 100;
+  for (int i=0; i<argc; i++) {
+    if (std::string(argv[i]) == "--iter")
+      opt_iter = atoi(argv[i+1]);
+    else if (std::string(argv[i]) == "--help") {
+      std::cout << "Usage: " << argv[0] << " [--iter <n>]" << std::endl;
+      return 0;
+    }
+  }
+
+  int status = 0;
+  try {
+    // Square zone of two triangles
+    vpImage<unsigned char> I(240, 320, 128);
+    std::vector<vpImagePoint> corners;
+    corners.push_back(vpImagePoint(100, 100));
+    corners.push_back(vpImagePoint(100, 150));
+    corners.push_back(vpImagePoint(150, 150));
+    corners.push_back(vpImagePoint(100, 100));
+    corners.push_back(vpImagePoint(150, 150));
+    corners.push_back(vpImagePoint(150, 100));
+    vpTemplateTrackerZone zone_ref;
+    zone_ref.initFromPoints(I, corners, false);
+
+    vpTemplateTrackerWarpHomography warp;
+    const double theta = 0.5, s = 1.2;
+    double params[3][8] = {
+      {s * cos(theta) - 1, s * sin(theta), 0, -s * sin(theta), s * cos(theta) - 1, 0, 10, -5}, // Similarity
+      {1, 0, 0, 0, 0, 0, 0, 0}, // Scale of 2 along one axis
+      {0, 0, 0, 0, -1, 0, 0, 0} // Zone flattened on a line
+    };
+    double expected[3] = {1., 2., std::numeric_limits<double>::infinity()};
+    for (unsigned int k = 0; k < 3; k++) {
+      vpColVector p(8);
+      for (unsigned int i = 0; i < 8; i++)
+        p[i] = params[k][i];
+      vpTemplateTrackerZone zone_cur;
+      warp.warpZone(zone_ref, p, zone_cur);
+      double conditioning = vpTrackingQuality::computeConditioning(zone_ref, zone_cur);
+      std::cout << "Warp " << k << ": conditioning " << conditioning << ", expected " << expected[k] << std::endl;
+      if (k == 2 ? conditioning < 1e6 : std::fabs(conditioning - expected[k]) > 1e-6)
+        status = 1;
+    }
+
+    // Smooth texture, shifted by a fraction of pixel at each frame
+    vpImage<unsigned char> J(240, 320);
+    std::vector<vpImagePoint> square(corners.begin(), corners.begin() + 3);
+    square.push_back(corners[5]);
+    vpTemplateTrackerResidual tracker(&warp);
+    tracker.setSampling(2,2);
+    tracker.setLambda(0.001);
+    tracker.setIterationMax(5);
+    tracker.setBlur(false);
+    double t_track = 0, t_ssd = 0, max_error = 0;
+    for (unsigned int n = 0; n <= opt_iter; n++) {
+      const double shift = 0.3 * sin(0.1 * n);
+      for (unsigned int i = 0; i < J.getHeight(); i++)
+        for (unsigned int j = 0; j < J.getWidth(); j++)
+          J[i][j] = (unsigned char)vpMath::round(128. + 60. * sin(0.15 * (j - shift)) * cos(0.11 * i) + 30. * sin(0.05 * (i + j)));
+      if (n == 0) {
+        tracker.initFromPoints(J, square, true);
+        continue;
+      }
+
+      double t = vpTime::measureTimeMs();
+      tracker.track(J);
+      t_track += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      const double residual = std::sqrt(tracker.getSSD(J, tracker.getp()));
+      t_ssd += vpTime::measureTimeMs() - t;
+      max_error = std::max(max_error, std::fabs(residual - tracker.getResidual()));
+      if (std::fabs(tracker.getValidRatio() - tracker.getRatioPixelIn()) > 1e-6)
+        status = 1;
+    }
+    std::cout << "Residual of the last iteration: largest difference with getSSD() " << max_error
+              << " gray level" << std::endl;
+    std::cout << "Tracking: " << t_track / opt_iter << " ms, getSSD(): " << t_ssd / opt_iter << " ms" << std::endl;
+    if (max_error > 1.)
+      status = 1;
+  }
+  catch(vpException &e) {
+    std::cout << "Exception: " << e.getStringMessage() << std::endl;
+    status = 1;
+  }
+  return status;
+}
@@ -163,7 +163,6 @@ int main(int argc, const char* argv[])
       objects[i].setCameraParameters(cam);
       firstTime[i] = true;
       objects[i].setPoints(points);
-      objects[i].setLeftHandTarget(true);
       // objects[i].setManualBlobInit(true);
 
       //      color_rects.at(i).id = vpColor::vpColorIdentifier( std::rand() % ( 18 + 1 ) );
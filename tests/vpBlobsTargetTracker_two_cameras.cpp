@@ -78,14 +78,17 @@ int main(int argc, const char* argv[])
 
 
     bool opt_learning = false;
+    bool opt_parallel = false;
 
     for (unsigned int i=0; i<argc; i++) {
         if (std::string(argv[i]) == "--ip")
             opt_ip = argv[i+1];
         else if (std::string(argv[i]) == "--learn-color")
             opt_learning = true;
+        else if (std::string(argv[i]) == "--parallel")
+            opt_parallel = true;
         else if (std::string(argv[i]) == "--help") {
-            std::cout << "Usage: " << argv[0] << "[--ip <robot address>] [--learn-color] [--object_name <numberObjects> <name1 name2 ...>]" << std::endl;
+            std::cout << "Usage: " << argv[0] << "[--ip <robot address>] [--learn-color] [--parallel] [--object_name <numberObjects> <name1 name2 ...>]" << std::endl;
             std::cout <<                         "[--file_name <path>]" << std::endl;
             return 0;
         }
@@ -201,7 +204,6 @@ int main(int argc, const char* argv[])
         hand_tracker_l.setName(chain_name[0]);
         hand_tracker_l.setCameraParameters(cam[0]);
         hand_tracker_l.setPoints(points);
-        hand_tracker_l.setLeftHandTarget(true);
 
         hand_tracker_l.setFullManual(true);
 
@@ -213,7 +215,6 @@ int main(int argc, const char* argv[])
         hand_tracker_r.setName(chain_name[1]);
         hand_tracker_r.setCameraParameters(cam[1]);
         hand_tracker_r.setPoints(points);
-        hand_tracker_r.setLeftHandTarget(false);
 
         hand_tracker_r.setFullManual(true);
 
@@ -349,6 +350,10 @@ int main(int argc, const char* argv[])
 
 
 
+            // The blobs of the two targets are tracked together
+            if (opt_parallel)
+                vpBlobsTargetTracker::trackTargets(hand_tracker, cvI, I, status_hand_tracker);
+
             for (unsigned int i = 0; i < num_objects ; i++)
             {
 
@@ -362,7 +367,8 @@ int main(int argc, const char* argv[])
                 }
 
 
-                status_hand_tracker[i] = hand_tracker[i]->track(cvI[i],I[i]);
+                if (!opt_parallel)
+                    status_hand_tracker[i] = hand_tracker[i]->track(cvI[i],I[i]);
 
 
 